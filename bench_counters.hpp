@@ -0,0 +1,295 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace detail {
+
+
+/* Hardware performance counters read around a benchmark loop, reported as
+   Google Benchmark user counters:
+
+     cycles/B       core cycles per byte processed
+     IPC            instructions per cycle
+     brmiss/KB      mispredicted branches per KiB processed
+     L1Dmiss/KB     L1 data cache read misses per KiB processed
+     uops/B         micro-ops issued per byte processed
+
+   The counters come from `perf_event_open`, counting user space only, so
+   they work with the default `perf_event_paranoid` of 2. Where they can't be
+   opened (not Linux, a container without access, a VM without a PMU) or a
+   particular event isn't supported, the affected counters are left out and
+   the benchmarks run as before. Setting `LFSR_BENCH_COUNTERS=0` in the
+   environment turns them off entirely. If no event opens, for whichever of
+   those reasons, a single warning saying why is printed.
+
+   Usage:
+
+     auto counters = detail::perf_counters{};
+     for (auto _ : state) { ... }
+     counters.report(state, bytes);
+*/
+class perf_counters
+{
+public:
+    enum event : std::size_t
+    {
+        cycles,
+        instructions,
+        branch_misses,
+        l1d_misses,
+        uops,
+        event_count,
+    };
+
+    perf_counters()
+    {
+#if defined(__linux__)
+        if (!enabled()) {
+            warn_unavailable("LFSR_BENCH_COUNTERS=0");
+            return;
+        }
+
+        for (auto ii = std::size_t{}; ii != event_count; ++ii) {
+            open(static_cast<event>(ii));
+        }
+        if (m_leader == -1) {
+            warn_unavailable(m_error == 0
+                    ? "no supported events" : std::strerror(m_error));
+            return;
+        }
+        ::ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        warn_unavailable("perf_event_open is Linux only");
+#endif
+    }
+
+    perf_counters(perf_counters const &) = delete;
+    auto operator=(perf_counters const &) -> perf_counters & = delete;
+
+    ~perf_counters()
+    {
+#if defined(__linux__)
+        for (auto fd : m_fds) {
+            if (fd != -1) {
+                ::close(fd);
+            }
+        }
+#endif
+    }
+
+    auto available() const noexcept -> bool
+    {
+        return m_leader != -1;
+    }
+
+    /* Stops counting and adds the per byte figures to `state`. The counts are
+       for every iteration, so `bytes` is the total processed across them. */
+    auto report(benchmark::State & state, std::uint64_t bytes) -> void
+    {
+        auto const counts = stop();
+        if (!counts || bytes == 0) {
+            return;
+        }
+
+        auto const & values = *counts;
+        auto const per_byte = [&](event e) {
+            return static_cast<double>(values[e]) / static_cast<double>(bytes);
+        };
+        auto const has = [&](event e) {
+            return m_fds[e] != -1;
+        };
+
+        if (has(cycles)) {
+            state.counters["cycles/B"] = per_byte(cycles);
+        }
+        if (has(cycles) && has(instructions) && values[cycles] != 0) {
+            state.counters["IPC"] = static_cast<double>(values[instructions])
+                    / static_cast<double>(values[cycles]);
+        }
+        if (has(branch_misses)) {
+            state.counters["brmiss/KB"] = per_byte(branch_misses) * 1024;
+        }
+        if (has(l1d_misses)) {
+            state.counters["L1Dmiss/KB"] = per_byte(l1d_misses) * 1024;
+        }
+        if (has(uops)) {
+            state.counters["uops/B"] = per_byte(uops);
+        }
+    }
+
+private:
+    using values_type = std::array<std::uint64_t, event_count>;
+
+#if defined(__linux__)
+    static auto enabled() -> bool
+    {
+        auto const * setting = std::getenv("LFSR_BENCH_COUNTERS");
+        return setting == nullptr || std::strcmp(setting, "0") != 0;
+    }
+
+    /* There is no generic event for micro-ops, so this uses the raw
+       UOPS_ISSUED.ANY encoding, which is only the same across Intel cores. */
+    static auto is_intel() -> bool
+    {
+        static auto const result = [] {
+            auto cpuinfo = std::ifstream{"/proc/cpuinfo"};
+            auto line = std::string{};
+            while (std::getline(cpuinfo, line)) {
+                if (line.starts_with("vendor_id")) {
+                    return line.find("GenuineIntel") != std::string::npos;
+                }
+            }
+            return false;
+        }();
+        return result;
+    }
+
+    static auto make_attributes(event e, perf_event_attr & attr) -> bool
+    {
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+                            | PERF_FORMAT_TOTAL_TIME_ENABLED
+                            | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        switch (e)
+        {
+        case cycles:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            return true;
+        case instructions:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            return true;
+        case branch_misses:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            return true;
+        case l1d_misses:
+            attr.type   = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            return true;
+        case uops:
+            attr.type   = PERF_TYPE_RAW;
+            attr.config = 0x010e;
+            return is_intel();
+        default:
+            return false;
+        }
+    }
+
+    auto open(event e) -> void
+    {
+        auto attr = perf_event_attr{};
+        if (!make_attributes(e, attr)) {
+            return;
+        }
+
+        /* The first event to open leads the group, so they're all scheduled
+           onto the PMU together and read in one go. */
+        auto const fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr,
+                0, -1, m_leader, 0));
+        if (fd == -1) {
+            if (m_error == 0) {
+                m_error = errno;
+            }
+            return;
+        }
+        if (m_leader == -1) {
+            m_leader = fd;
+        }
+        ::ioctl(fd, PERF_EVENT_IOC_ID, &m_ids[e]);
+        m_fds[e] = fd;
+    }
+
+#endif
+
+    /* Once per run, however many benchmarks find no counters */
+    static auto warn_unavailable(char const * reason) -> void
+    {
+        static auto const warned = [&] {
+            std::cerr << "no hardware counters (" << reason
+                      << "); running without them\n";
+            return true;
+        }();
+        (void)warned;
+    }
+
+    /* The counts, scaled up if the group was multiplexed with other users
+       of the PMU, or nothing if it never ran. */
+    auto stop() -> std::optional<values_type>
+    {
+#if defined(__linux__)
+        if (m_leader == -1) {
+            return std::nullopt;
+        }
+        ::ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        struct entry
+        {
+            std::uint64_t value;
+            std::uint64_t id;
+        };
+        struct
+        {
+            std::uint64_t nr;
+            std::uint64_t time_enabled;
+            std::uint64_t time_running;
+            entry         values[event_count];
+        } data{};
+
+        if (::read(m_leader, &data, sizeof(data)) <= 0 || data.time_running == 0) {
+            return std::nullopt;
+        }
+
+        auto const scale = static_cast<double>(data.time_enabled)
+                         / static_cast<double>(data.time_running);
+        auto result = values_type{};
+        for (auto ii = std::uint64_t{}; ii != data.nr && ii != event_count; ++ii) {
+            for (auto e = std::size_t{}; e != event_count; ++e) {
+                if (m_fds[e] != -1 && m_ids[e] == data.values[ii].id) {
+                    result[e] = static_cast<std::uint64_t>(
+                            static_cast<double>(data.values[ii].value) * scale);
+                }
+            }
+        }
+        return result;
+#else
+        return std::nullopt;
+#endif
+    }
+
+    std::array<int, event_count>           m_fds = {-1, -1, -1, -1, -1};
+    std::array<std::uint64_t, event_count> m_ids = {};
+    int                                    m_leader = -1;
+    int                                    m_error = 0;
+};
+
+
+}
@@ -2,6 +2,11 @@
 
 #include <lfsr.hpp>
 
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
 
 using Degree_5  = lfsr::tap_list<5, 4, 3, 2>;
 using Degree_6  = lfsr::tap_list<6, 5, 3, 2>;
@@ -62,3 +67,29 @@ using Degree_60 = lfsr::tap_list<60, 58, 56, 55>;
 using Degree_61 = lfsr::tap_list<61, 60, 59, 56>;
 using Degree_62 = lfsr::tap_list<62, 59, 57, 56>;
 using Degree_63 = lfsr::tap_list<63, 62, 59, 58>;
+
+/* Above a degree of 64 the register no longer fits in a single word. These
+   are primitive trinomials, so only have two taps. */
+using Degree_71   = lfsr::tap_list<71, 6>;
+using Degree_89   = lfsr::tap_list<89, 38>;
+using Degree_127  = lfsr::tap_list<127, 1>;
+using Degree_521  = lfsr::tap_list<521, 32>;
+using Degree_1279 = lfsr::tap_list<1279, 216>;
+
+
+/* `size` pseudo random bytes, the same every run */
+inline auto random_payload(std::size_t size, std::uint64_t seed = 0x5eed)
+    -> std::vector<std::uint8_t>
+{
+    auto engine = std::mt19937_64{seed};
+    auto result = std::vector<std::uint8_t>(size);
+    auto ii = std::size_t{};
+    for (; ii + 8 <= size; ii += 8) {
+        auto const value = engine();
+        std::memcpy(result.data() + ii, &value, 8);
+    }
+    for (auto value = engine(); ii != size; ++ii, value >>= 8) {
+        result[ii] = static_cast<std::uint8_t>(value);
+    }
+    return result;
+}
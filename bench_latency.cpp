@@ -0,0 +1,355 @@
+#include <lfsr.hpp>
+
+#include <test_detail.hpp>
+#include <bench_detail.hpp>
+#include <tool_detail.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define LFSR_HAVE_RDTSC 1
+#endif
+
+
+/* Latency of single calls, for real-time links where the tail matters more
+   than the mean that `bench_lfsr` reports.
+
+   Each case times individual `scramble_byte` calls, and whole frames of 64 to
+   1500 bytes, into a histogram, and reports percentiles up to the maximum.
+   Warm runs reuse one LFSR and keep everything in cache. Cold runs construct a
+   new LFSR for every sample and sweep a buffer larger than the last level
+   cache beforehand, so the sample pays for the first call after construction
+   and for fetching the code and data from memory. */
+
+namespace {
+
+constexpr auto usage =
+R"(usage: bench_latency [options]
+
+  --samples <n>       Samples per warm run (default 100000)
+  --cold-samples <n>  Samples per cold run (default 500)
+  --evict <size>      Buffer swept to evict the caches before each cold
+                      sample (default 256M)
+  --timer <timer>     rdtsc (default where available) or clock
+)";
+
+
+/* A histogram with buckets a fixed fraction wide, after HdrHistogram: values
+   below 2 * sub_buckets are counted exactly, and above that each power of two
+   is split into `sub_buckets` buckets, so every value is recorded to within
+   1 / sub_buckets (about 3%) whatever its magnitude. */
+class latency_histogram
+{
+public:
+    constexpr static auto sub_bucket_bits = 5;
+    constexpr static auto sub_buckets     = std::uint64_t{1} << sub_bucket_bits;
+
+    latency_histogram()
+        : m_counts(2 * sub_buckets + (64 - sub_bucket_bits) * sub_buckets)
+    {
+    }
+
+    auto record(std::uint64_t value) -> void
+    {
+        ++m_counts[index_of(value)];
+        ++m_total;
+        m_sum += value;
+        m_min  = std::min(m_min, value);
+        m_max  = std::max(m_max, value);
+    }
+
+    auto count() const -> std::uint64_t { return m_total; }
+    auto min()   const -> std::uint64_t { return m_total ? m_min : 0; }
+    auto max()   const -> std::uint64_t { return m_max; }
+
+    auto mean() const -> double
+    {
+        return m_total ? static_cast<double>(m_sum) / m_total : 0.0;
+    }
+
+    /* The value below which `percentile` percent of the samples fall, given
+       as the top of its bucket (but never above the maximum) */
+    auto percentile(double percentile) const -> std::uint64_t
+    {
+        auto const wanted = static_cast<std::uint64_t>(
+                percentile / 100.0 * static_cast<double>(m_total) + 0.5);
+        auto seen = std::uint64_t{};
+        for (auto ii = std::size_t{}; ii != m_counts.size(); ++ii) {
+            seen += m_counts[ii];
+            if (seen >= std::max<std::uint64_t>(wanted, 1)) {
+                return std::min(highest_in(ii), m_max);
+            }
+        }
+        return m_max;
+    }
+
+private:
+    static auto index_of(std::uint64_t value) -> std::size_t
+    {
+        if (value < 2 * sub_buckets) {
+            return static_cast<std::size_t>(value);
+        }
+        auto const shift = std::bit_width(value) - sub_bucket_bits - 1;
+        auto const sub   = (value >> shift) - sub_buckets;
+        return static_cast<std::size_t>(
+                sub_buckets + shift * sub_buckets + sub);
+    }
+
+    static auto highest_in(std::size_t index) -> std::uint64_t
+    {
+        if (index < 2 * sub_buckets) {
+            return index;
+        }
+        auto const shift = (index - sub_buckets) / sub_buckets;
+        auto const sub   = (index - sub_buckets) % sub_buckets + sub_buckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t              m_total = 0;
+    std::uint64_t              m_sum   = 0;
+    std::uint64_t              m_min   = ~std::uint64_t{};
+    std::uint64_t              m_max   = 0;
+};
+
+
+
+/* Reads a timestamp in ticks, and converts ticks to nanoseconds. With rdtsc
+   the reads are fenced so that the timed code can't be reordered around them;
+   the tick rate is measured against the steady clock at start up. */
+class timer
+{
+public:
+    explicit timer(bool use_rdtsc)
+        : m_rdtsc{use_rdtsc}
+    {
+#if defined(LFSR_HAVE_RDTSC)
+        if (m_rdtsc) {
+            using clock = std::chrono::steady_clock;
+            auto const start_time  = clock::now();
+            auto const start_ticks = now();
+            while (clock::now() - start_time < std::chrono::milliseconds{100}) {
+            }
+            auto const ticks = now() - start_ticks;
+            auto const ns = std::chrono::duration<double, std::nano>(
+                    clock::now() - start_time).count();
+            m_ns_per_tick = ns / static_cast<double>(ticks);
+        }
+#endif
+    }
+
+    auto now() const -> std::uint64_t
+    {
+#if defined(LFSR_HAVE_RDTSC)
+        if (m_rdtsc) {
+            _mm_lfence();
+            auto const result = __rdtsc();
+            _mm_lfence();
+            return result;
+        }
+#endif
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<
+                std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+                        .time_since_epoch()).count());
+    }
+
+    auto to_ns(std::uint64_t ticks) const -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(
+                static_cast<double>(ticks) * m_ns_per_tick + 0.5);
+    }
+
+    auto name() const -> std::string
+    {
+        return m_rdtsc
+                ? std::format("rdtsc, {:.3f} ns/tick", m_ns_per_tick)
+                : std::string{"steady_clock"};
+    }
+
+private:
+    bool   m_rdtsc;
+    double m_ns_per_tick = 1.0;
+};
+
+
+
+struct options
+{
+    std::size_t samples;
+    std::size_t cold_samples;
+    std::size_t evict;
+    bool        rdtsc;
+};
+
+
+class runner
+{
+public:
+    explicit runner(options const & opts)
+        : m_opts{opts}
+        , m_timer{opts.rdtsc}
+        , m_evict(opts.evict)
+        , m_input(random_payload(1500))
+        , m_output(1500)
+    {
+        std::cout << std::format("timer: {}\n\n{:<44} {:>5} {:>8} {:>7} {:>7} "
+                "{:>7} {:>7} {:>7} {:>8} {:>8}\n", m_timer.name(), "case",
+                "cache", "samples", "min", "mean", "p50", "p99", "p99.9",
+                "p99.99", "max");
+    }
+
+    /* `sample` is the code being timed. `setup` is run untimed, with whether
+       the run is cold, before the warm run and before every cold sample. */
+    auto run(std::string const & name,
+             std::function<void(bool)> const & setup,
+             std::function<void()> const & sample) -> void
+    {
+        for (auto cold : {false, true})
+        {
+            auto histogram = latency_histogram{};
+            auto const samples = cold ? m_opts.cold_samples : m_opts.samples;
+            setup(cold);
+            for (auto ii = std::size_t{}; ii != samples; ++ii)
+            {
+                if (cold) {
+                    evict();
+                    setup(cold);
+                }
+                auto const start = m_timer.now();
+                sample();
+                auto const stop  = m_timer.now();
+                histogram.record(m_timer.to_ns(stop - start));
+            }
+            report(name, cold, histogram);
+        }
+    }
+
+    template <typename LFSR>
+    auto run_engine(std::string const & name) -> void
+    {
+        auto lfsr = std::make_unique<LFSR>();
+        auto reset = [&](bool cold) {
+            if (cold) {
+                lfsr = std::make_unique<LFSR>();
+            }
+        };
+
+        auto index = std::size_t{};
+        run(name + " scramble_byte", reset, [&] {
+            m_output[0] = lfsr->scramble_byte(m_input[index++ % 1500]);
+        });
+
+        for (auto size : {64, 256, 576, 1500}) {
+            run(std::format("{} frame {}", name, size), reset, [&] {
+                lfsr->scramble_range(m_input.data(), m_input.data() + size,
+                        m_output.data());
+            });
+        }
+    }
+
+private:
+    /* Writing, rather than reading, so that the lines being evicted are
+       dirtied and the LFSR's data has to come back from memory */
+    auto evict() -> void
+    {
+        ++m_evict_value;
+        for (auto ii = std::size_t{}; ii < m_evict.size(); ii += 64) {
+            m_evict[ii] = m_evict_value;
+        }
+    }
+
+    auto report(std::string const & name, bool cold,
+                latency_histogram const & h) const -> void
+    {
+        std::cout << std::format("{:<44} {:>5} {:>8} {:>7} {:>7.0f} {:>7} "
+                "{:>7} {:>7} {:>8} {:>8}\n", name, cold ? "cold" : "warm",
+                h.count(), h.min(), h.mean(), h.percentile(50),
+                h.percentile(99), h.percentile(99.9), h.percentile(99.99),
+                h.max());
+    }
+
+    options                   m_opts;
+    timer                     m_timer;
+    std::vector<std::uint8_t> m_evict;
+    std::uint8_t              m_evict_value = 0;
+    std::vector<std::uint8_t> m_input;
+    std::vector<std::uint8_t> m_output;
+};
+
+
+template <typename TapList>
+auto run_all(runner & r, std::string const & degree) -> void
+{
+    r.run_engine<detail::feedthrough_galois_from_list_t<TapList>>(
+            "Galois<" + degree + ">");
+    r.run_engine<detail::feedthrough_fibonacci_from_list_t<TapList>>(
+            "Fibonacci<" + degree + ">");
+    r.run_engine<detail::feedthrough_fibonacci_bulk_from_list_t<TapList>>(
+            "FibonacciBulk<" + degree + ">");
+}
+
+
+auto parse_options(int argc, char const * const * argv) -> options
+{
+    auto args = detail::arguments{argc, argv, {"help"}};
+    if (args.flag("help") || args.positional_count() != 0) {
+        throw std::invalid_argument(usage);
+    }
+
+#if defined(LFSR_HAVE_RDTSC)
+    auto const default_timer = "rdtsc";
+#else
+    auto const default_timer = "clock";
+#endif
+    auto const timer_name = args.value("timer", default_timer);
+    if (timer_name != "rdtsc" && timer_name != "clock") {
+        throw std::invalid_argument(std::format(
+                "unknown timer '{}', expected rdtsc or clock", timer_name));
+    }
+#if !defined(LFSR_HAVE_RDTSC)
+    if (timer_name == "rdtsc") {
+        throw std::invalid_argument("rdtsc is not available on this target");
+    }
+#endif
+
+    return options{
+        .samples      = args.size("samples", 100'000),
+        .cold_samples = args.size("cold-samples", 500),
+        .evict        = args.size("evict", std::size_t{256} << 20),
+        .rdtsc        = timer_name == "rdtsc",
+    };
+}
+
+}
+
+
+
+auto main(int argc, char ** argv) -> int
+{
+    try
+    {
+        auto r = runner{parse_options(argc, argv)};
+
+        /* What the timer itself costs, to subtract by eye from the rest */
+        r.run("(empty)", [](bool) {}, [] {});
+
+        run_all<Degree_12>(r, "12");
+        run_all<Degree_31>(r, "31");
+        run_all<Degree_127>(r, "127");
+    }
+    catch (std::exception const & e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
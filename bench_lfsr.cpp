@@ -1,40 +1,31 @@
 #include <lfsr.hpp>
+#include <lfsr_64b66b.hpp>
+#include <lfsr_cascade.hpp>
+#include <lfsr_crc.hpp>
+#include <lfsr_gold.hpp>
+#include <lfsr_keystream.hpp>
+#include <lfsr_stream.hpp>
+#include <lfsr_views.hpp>
 
 #include <test_detail.hpp>
 #include <bench_detail.hpp>
+#include <bench_counters.hpp>
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ostream>
+#include <ranges>
+#include <string>
+#include <vector>
 
 
-template <typename T, std::size_t N>
-auto make_array(T const (&arr)[N]) -> std::array<T, N>
-{
-    auto result = std::array<T, N>{};
-    for (auto ii = 0ul; ii != N; ++ii) {
-        result[ii] = arr[ii];
-    }
-    return result;
-}
 
-const auto test_data = make_array<std::uint8_t>({
-    0,   1,   2,   3,   4,   5,   6,   7,
-    8,   9,   10,  11,  12,  13,  14,  15,
-    16,  17,  18,  19,  20,  21,  22,  23,
-    24,  25,  26,  27,  28,  29,  30,  31,
-    32,  33,  34,  35,  36,  37,  38,  39,
-    40,  41,  42,  43,  44,  45,  46,  47,
-    48,  49,  50,  51,  52,  53,  54,  55,
-    56,  57,  58,  59,  60,  61,  62,  63,
-    64,  65,  66,  67,  68,  69,  70,  71,
-    72,  73,  74,  75,  76,  77,  78,  79,
-    80,  81,  82,  83,  84,  85,  86,  87,
-    88,  89,  90,  91,  92,  93,  94,  95,
-    96,  97,  98,  99,  100, 101, 102, 103,
-    104, 105, 106, 107, 108, 109, 110, 111,
-    112, 113, 114, 115, 116, 117, 118, 119,
-    120, 121, 122, 123, 124, 125, 126, 127,
-});
+/* Random rather than ascending bytes, so that the input doesn't line up with
+   anything in the LFSR. The seed is fixed so that runs are comparable. */
+const auto test_data = random_payload(128);
 
 
 
@@ -62,12 +53,14 @@ auto LFSR_FeedthroughGalois(benchmark::State & state)
     auto result = std::vector<std::uint8_t>();
     result.resize(test_data.size());
     auto lfsr = lfsr_type{};
+    auto counters = detail::perf_counters{};
     for (auto _ : state) {
         lfsr.scramble_range(std::begin(test_data), 
                 std::end(test_data), 
                 std::begin(result));
         benchmark::DoNotOptimize(result);
     }
+    counters.report(state, test_data.size() * state.iterations());
     state.SetBytesProcessed(test_data.size() * state.iterations());
 
     if (result == all_zeroes()) {
@@ -84,12 +77,14 @@ auto LFSR_FeedthroughFibonacci(benchmark::State & state)
     auto result = std::vector<std::uint8_t>();
     result.resize(test_data.size());
     auto lfsr = lfsr_type{};
+    auto counters = detail::perf_counters{};
     for (auto _ : state) {
         lfsr.scramble_range(std::begin(test_data), 
                 std::end(test_data), 
                 std::begin(result));
         benchmark::DoNotOptimize(result);
     }
+    counters.report(state, test_data.size() * state.iterations());
     state.SetBytesProcessed(test_data.size() * state.iterations());
 
     if (result == all_zeroes()) {
@@ -106,12 +101,14 @@ auto LFSR_FeedthroughFibonacciBulk(benchmark::State & state)
     auto result = std::vector<std::uint8_t>();
     result.resize(test_data.size());
     auto lfsr = lfsr_type{};
+    auto counters = detail::perf_counters{};
     for (auto _ : state) {
         lfsr.scramble_range(std::begin(test_data), 
                 std::end(test_data), 
                 std::begin(result));
         benchmark::DoNotOptimize(result);
     }
+    counters.report(state, test_data.size() * state.iterations());
     state.SetBytesProcessed(test_data.size() * state.iterations());
     // state.
 
@@ -123,6 +120,408 @@ auto LFSR_FeedthroughFibonacciBulk(benchmark::State & state)
 
 
 
+/* The sweep below runs each engine over buffers from 64 B, which fits in L1, to
+   1 GiB, which is well out of any cache, so that the results can be read
+   against the packet and file sizes actually in use. The memcpy and memset
+   benchmarks over the same sizes give the memory bandwidth ceiling: an engine
+   that gets close to memcpy at a size is bound by memory there, not by the
+   LFSR. */
+
+enum class operation
+{
+    scramble,
+    descramble,
+    in_place,
+};
+
+
+template <typename LFSR, operation Op>
+auto LFSR_Range(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto input  = random_payload(size);
+    auto output = std::vector<std::uint8_t>(size);
+    auto lfsr   = LFSR{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        if constexpr (Op == operation::scramble) {
+            lfsr.scramble_range(input.begin(), input.end(), output.begin());
+        }
+        else if constexpr (Op == operation::descramble) {
+            lfsr.descramble_range(input.begin(), input.end(), output.begin());
+        }
+        else {
+            lfsr.scramble_range(input.begin(), input.end(), input.begin());
+        }
+        benchmark::DoNotOptimize(input.data());
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+
+/* Scrambling and a CRC32C of the plaintext, one after the other over the
+   whole buffer, or fused into one pass; beyond the caches, the first reads
+   the input from memory twice */
+template <typename LFSR, bool Fused>
+auto LFSR_ScrambleCrc(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto input  = random_payload(size);
+    auto output = std::vector<std::uint8_t>(size);
+    auto lfsr   = LFSR{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        auto crc = lfsr::crc32c{};
+        if constexpr (Fused) {
+            lfsr::scramble_with_crc(lfsr, input.data(),
+                    input.data() + size, output.data(), crc);
+        }
+        else {
+            crc.update(input.data(), input.data() + size);
+            lfsr.scramble_range(input.begin(), input.end(), output.begin());
+        }
+        benchmark::DoNotOptimize(crc.value());
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+
+/* x^58 + x^39 + 1 and then x^20 + x^17 + 1, with an engine per stage, one
+   pass after the other, or as a cascade in one */
+using Cascade_58_20 = lfsr::cascade<lfsr::tap_list<0, 39, 58>,
+                                    lfsr::tap_list<0, 17, 20>>;
+
+template <bool Fused>
+auto LFSR_Cascade(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto input  = random_payload(size);
+    auto output = std::vector<std::uint8_t>(size);
+    auto first  = lfsr::feedthrough_fibonacci_word<0, 39, 58>{};
+    auto second = lfsr::feedthrough_fibonacci_word<0, 17, 20>{};
+    auto cascade = Cascade_58_20{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        if constexpr (Fused) {
+            cascade.scramble_range(input.begin(), input.end(), output.begin());
+        }
+        else {
+            first.scramble_range(input.begin(), input.end(), output.begin());
+            second.scramble_range(output.begin(), output.end(), output.begin());
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+
+/* Discards what's written to it */
+class null_streambuf : public std::streambuf
+{
+protected:
+    auto overflow(int_type ch) -> int_type override
+    {
+        return traits_type::not_eof(ch);
+    }
+
+    auto xsputn(char const *, std::streamsize n) -> std::streamsize override
+    {
+        return n;
+    }
+};
+
+/* Scrambling through an `std::ostream`, in writes of range(1) bytes */
+auto LFSR_Streambuf(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto const write_size = static_cast<std::size_t>(state.range(1));
+    auto const input = random_payload(size);
+    auto sink = null_streambuf{};
+    auto buf = lfsr::scrambling_streambuf{sink,
+            lfsr::feedthrough_fibonacci_word<0, 39, 58>{}};
+    auto out = std::ostream{&buf};
+    auto const data = reinterpret_cast<char const *>(input.data());
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        for (auto position = std::size_t{}; position < size; position += write_size) {
+            out.write(data + position, static_cast<std::streamsize>(
+                    std::min(write_size, size - position)));
+        }
+        out.flush();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+/* Scrambling through `lfsr::views::scramble`, copied out element by element */
+auto LFSR_View(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto const input = random_payload(size);
+    auto output = std::vector<std::uint8_t>(size);
+    auto lfsr = lfsr::feedthrough_fibonacci_word<0, 39, 58>{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        std::ranges::copy(input | lfsr::views::scramble(std::ref(lfsr)),
+                output.begin());
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+/* Additive scrambling of 64 byte frames, each from its own seed, by clocking
+   a reseeded degree 7 register over zeroes for each, or from a table */
+template <bool Table>
+auto LFSR_Frame(benchmark::State & state)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_word<7, 4>;
+    constexpr auto frame = std::size_t{64};
+
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto input  = random_payload(size);
+    auto output = std::vector<std::uint8_t>(size);
+    auto const table = lfsr::keystream_table<lfsr_type, frame>{};
+    auto lfsr = lfsr_type{};
+    auto const zeroes = std::array<std::uint8_t, frame>{};
+    auto keystream = std::array<std::uint8_t, frame>{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        for (auto offset = std::size_t{}; offset + frame <= size; offset += frame)
+        {
+            auto const seed = (offset / frame) % 127 + 1;
+            auto const first = input.data() + offset;
+            if constexpr (Table) {
+                table.scramble(seed, first, first + frame, output.data() + offset);
+            }
+            else {
+                lfsr.reset(seed);
+                lfsr.scramble_range(zeroes.begin(), zeroes.end(), keystream.begin());
+                for (auto ii = std::size_t{}; ii != frame; ++ii) {
+                    output[offset + ii] = first[ii] ^ keystream[ii];
+                }
+            }
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+/* The cost of a single call, for code that scrambles as bytes or bits arrive
+   rather than a buffer at a time. */
+template <typename LFSR>
+auto LFSR_ScrambleByte(benchmark::State & state)
+{
+    auto const input = random_payload(4096);
+    auto lfsr = LFSR{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        for (auto value : input) {
+            benchmark::DoNotOptimize(lfsr.scramble_byte(value));
+        }
+    }
+    counters.report(state, input.size() * state.iterations());
+    state.SetItemsProcessed(static_cast<std::int64_t>(input.size())
+            * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(input.size())
+            * state.iterations());
+}
+
+
+template <typename LFSR>
+auto LFSR_ScrambleBit(benchmark::State & state)
+{
+    auto const input = random_payload(512);
+    auto lfsr = LFSR{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        for (auto value : input) {
+            for (auto bit = 0; bit != 8; ++bit) {
+                benchmark::DoNotOptimize(lfsr.scramble_bit((value >> bit) & 1));
+            }
+        }
+    }
+    counters.report(state, input.size() * state.iterations());
+    state.SetItemsProcessed(static_cast<std::int64_t>(input.size()) * 8
+            * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(input.size())
+            * state.iterations());
+}
+
+
+/* 64b/66b blocks, packed or not, by the block; bytes are payload bytes */
+template <bool Packed, operation Op>
+auto Codec_64b66b(benchmark::State & state)
+{
+    auto const blocks = static_cast<std::size_t>(state.range(0));
+    auto const payload = random_payload(blocks * 8);
+    auto input = std::vector<lfsr::block_66>(blocks);
+    for (auto ii = std::size_t{}; ii != blocks; ++ii) {
+        input[ii].header = lfsr::sync_data;
+        std::memcpy(&input[ii].payload, payload.data() + ii * 8, 8);
+    }
+    auto output = input;
+    auto packed = std::vector<std::uint8_t>(lfsr::packed_size_66(blocks));
+    auto packed_output = packed;
+    if constexpr (Packed) {
+        lfsr::codec_64b66b{}.scramble(input.begin(), input.end(), output.begin());
+        lfsr::detail::packed_writer_66 writer{packed.data()};
+        for (auto const & block : output) {
+            writer.write(block);
+        }
+        writer.flush();
+    }
+    auto codec = lfsr::codec_64b66b{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        if constexpr (Packed && Op == operation::scramble) {
+            codec.scramble_packed(packed.data(), blocks, packed_output.data());
+        }
+        else if constexpr (Packed) {
+            codec.descramble_packed(packed.data(), blocks, packed_output.data());
+        }
+        else if constexpr (Op == operation::scramble) {
+            codec.scramble(input.begin(), input.end(), output.begin());
+        }
+        else {
+            codec.descramble(input.begin(), input.end(), output.begin());
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::DoNotOptimize(packed_output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, blocks * 8 * state.iterations());
+    state.SetItemsProcessed(static_cast<std::int64_t>(blocks) * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(blocks) * 8
+            * state.iterations());
+}
+
+
+/* 3GPP downlink scrambling code chips, from one phase or from 16, a frame
+   apart; bytes are chip bytes */
+using Gold_18 = lfsr::gold_sequence<lfsr::tap_list<0, 11, 18>,
+                                    lfsr::tap_list<0, 8, 11, 13, 18>>;
+
+auto Gold_Generate(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto output = std::vector<std::uint64_t>(size / 8);
+    auto gold = Gold_18{};
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        gold.generate(std::span{output});
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+
+auto Gold_GeneratePhases(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto const phases = static_cast<std::size_t>(state.range(1));
+    auto output = std::vector<std::uint64_t>(size / 8);
+    auto generators = std::vector<Gold_18>{};
+    for (auto ii = std::size_t{}; ii != phases; ++ii) {
+        generators.push_back(Gold_18{}.phase(ii * 38400));
+    }
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        lfsr::generate_phases(std::span{generators}, std::span{output});
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+
+auto Memory_Memcpy(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto input  = random_payload(size);
+    auto output = std::vector<std::uint8_t>(size);
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        std::memcpy(output.data(), input.data(), size);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+
+auto Memory_Memset(benchmark::State & state)
+{
+    auto const size = static_cast<std::size_t>(state.range(0));
+    auto output = std::vector<std::uint8_t>(size);
+
+    auto counters = detail::perf_counters{};
+    for (auto _ : state)
+    {
+        std::memset(output.data(), static_cast<int>(state.iterations()), size);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(state, size * state.iterations());
+    state.SetBytesProcessed(static_cast<std::int64_t>(size) * state.iterations());
+}
+
+
+using Galois_12        = detail::feedthrough_galois_from_list_t<Degree_12>;
+using Fibonacci_12     = detail::feedthrough_fibonacci_from_list_t<Degree_12>;
+using FibonacciBulk_12 = detail::feedthrough_fibonacci_bulk_from_list_t<Degree_12>;
+using FibonacciWord_12 = detail::feedthrough_fibonacci_word_from_list_t<Degree_12>;
+
+using Galois_127        = detail::feedthrough_galois_from_list_t<Degree_127>;
+using Fibonacci_127     = detail::feedthrough_fibonacci_from_list_t<Degree_127>;
+using FibonacciBulk_127 = detail::feedthrough_fibonacci_bulk_from_list_t<Degree_127>;
+
+constexpr auto scramble   = operation::scramble;
+constexpr auto descramble = operation::descramble;
+constexpr auto in_place   = operation::in_place;
+
+
+
+
 // #define TEST_OPTS ->MinTime(0.1)
 // #define TEST_OPTS ->MinTime(2.0)
 
@@ -192,6 +591,11 @@ BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_60)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_61)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_62)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_63)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_71)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_89)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_127)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_521)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughGalois, Degree_1279)TEST_OPTS;
 
 
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_5)TEST_OPTS;;
@@ -253,6 +657,11 @@ BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_60)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_61)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_62)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_63)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_71)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_89)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_127)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_521)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacci, Degree_1279)TEST_OPTS;
 
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_5)TEST_OPTS;;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_6)TEST_OPTS;
@@ -313,6 +722,80 @@ BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_60)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_61)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_62)TEST_OPTS;
 BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_63)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_71)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_89)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_127)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_521)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_1279)TEST_OPTS;
+
+
+/* 64 B to 1 GiB, by a factor of 8. The 1 GiB runs of the bit at a time engines
+   take a while; use --benchmark_filter to leave them out. */
+#define SWEEP_OPTS ->RangeMultiplier(8)->Range(64, 1 << 30)TEST_OPTS
+
+BENCHMARK(Memory_Memcpy)SWEEP_OPTS;
+BENCHMARK(Memory_Memset)SWEEP_OPTS;
+
+BENCHMARK_TEMPLATE(LFSR_Range, Galois_12, scramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Galois_12, descramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Galois_12, in_place)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Fibonacci_12, scramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Fibonacci_12, descramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Fibonacci_12, in_place)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciBulk_12, scramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciBulk_12, descramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciBulk_12, in_place)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciWord_12, scramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciWord_12, descramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciWord_12, in_place)SWEEP_OPTS;
+
+BENCHMARK_TEMPLATE(LFSR_ScrambleCrc, FibonacciBulk_12, false)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleCrc, FibonacciBulk_12, true)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleCrc, FibonacciWord_12, false)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleCrc, FibonacciWord_12, true)SWEEP_OPTS;
+
+BENCHMARK_TEMPLATE(LFSR_Cascade, false)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Cascade, true)SWEEP_OPTS;
+
+BENCHMARK(LFSR_Streambuf)->Args({1 << 24, 64})->Args({1 << 24, 1 << 20})TEST_OPTS;
+BENCHMARK(LFSR_View)->Arg(1 << 24)TEST_OPTS;
+
+BENCHMARK_TEMPLATE(LFSR_Frame, false)->Arg(1 << 16)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Frame, true)->Arg(1 << 16)TEST_OPTS;
+
+BENCHMARK_TEMPLATE(LFSR_Range, Galois_127, scramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Galois_127, descramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Galois_127, in_place)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Fibonacci_127, scramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Fibonacci_127, descramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, Fibonacci_127, in_place)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciBulk_127, scramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciBulk_127, descramble)SWEEP_OPTS;
+BENCHMARK_TEMPLATE(LFSR_Range, FibonacciBulk_127, in_place)SWEEP_OPTS;
+
+BENCHMARK_TEMPLATE(LFSR_ScrambleByte, Galois_12)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleByte, Fibonacci_12)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleByte, FibonacciBulk_12)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleByte, FibonacciWord_12)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleByte, Galois_127)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleByte, Fibonacci_127)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleByte, FibonacciBulk_127)TEST_OPTS;
+
+BENCHMARK_TEMPLATE(Codec_64b66b, false, scramble)->Arg(1 << 16)TEST_OPTS;
+BENCHMARK_TEMPLATE(Codec_64b66b, false, descramble)->Arg(1 << 16)TEST_OPTS;
+BENCHMARK_TEMPLATE(Codec_64b66b, true, scramble)->Arg(1 << 16)TEST_OPTS;
+BENCHMARK_TEMPLATE(Codec_64b66b, true, descramble)->Arg(1 << 16)TEST_OPTS;
+
+BENCHMARK(Gold_Generate)->Arg(1 << 16)->Arg(1 << 26)TEST_OPTS;
+BENCHMARK(Gold_GeneratePhases)->Args({1 << 16, 16})->Args({1 << 26, 16})TEST_OPTS;
+
+BENCHMARK_TEMPLATE(LFSR_ScrambleBit, Galois_12)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleBit, Fibonacci_12)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleBit, FibonacciBulk_12)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleBit, Galois_127)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleBit, Fibonacci_127)TEST_OPTS;
+BENCHMARK_TEMPLATE(LFSR_ScrambleBit, FibonacciBulk_127)TEST_OPTS;
+
 
 
 // BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulkSHL, Degree_5)TEST_OPTS;;
@@ -375,4 +858,29 @@ BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulk, Degree_63)TEST_OPTS;
 // BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulkSHL, Degree_62)TEST_OPTS;
 // BENCHMARK_TEMPLATE(LFSR_FeedthroughFibonacciBulkSHL, Degree_63)TEST_OPTS;
 
-BENCHMARK_MAIN();
\ No newline at end of file
+/* The compiler is recorded in the JSON output so that `bench_report.py` only
+   compares like with like. */
+auto compiler_name() -> std::string
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+
+auto main(int argc, char ** argv) -> int
+{
+    benchmark::AddCustomContext("compiler", compiler_name());
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
@@ -0,0 +1,228 @@
+#include <lfsr.hpp>
+#include <lfsr_pipeline.hpp>
+
+#include <test_detail.hpp>
+#include <bench_detail.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+
+/* Compares scrambling a stream with a single thread, where reading, scrambling
+   and writing happen one after the other, against `lfsr::pipeline`, where they
+   overlap.
+
+   The source and sink are simulated devices that sleep for as long as the
+   transfer would take at the given rate (the benchmark argument, in MiB/s), so
+   like real I/O they cost wall time but no CPU. With a source and sink rate of
+   R and a scrambling rate of K, the serial version should manage about
+   1 / (2/R + 1/K), and the pipeline about min(R, K). `Pipeline_KernelOnly`
+   gives K for reference. */
+
+using lfsr_type = detail::feedthrough_fibonacci_bulk_from_list_t<Degree_31>;
+
+constexpr auto stream_size = std::size_t{32} << 20;
+constexpr auto block_size  = std::size_t{1} << 20;
+
+
+class simulated_device
+{
+public:
+    explicit simulated_device(std::int64_t mib_per_second)
+        : m_bytes_per_second{static_cast<double>(mib_per_second) * 1024 * 1024}
+    {
+    }
+
+    auto transfer(std::size_t bytes) const -> void
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(
+                static_cast<double>(bytes) / m_bytes_per_second));
+    }
+
+private:
+    double m_bytes_per_second;
+};
+
+
+/* Hands out `stream_size` bytes of the same block at the device's rate */
+class simulated_source
+{
+public:
+    simulated_source(simulated_device device, std::vector<std::uint8_t> const & data)
+        : m_device{device}
+        , m_data{data}
+    {
+    }
+
+    auto operator()(std::uint8_t * out, std::size_t capacity) -> std::size_t
+    {
+        auto const count = std::min({capacity, m_remaining, m_data.size()});
+        m_device.transfer(count);
+        std::memcpy(out, m_data.data(), count);
+        m_remaining -= count;
+        return count;
+    }
+
+private:
+    simulated_device                  m_device;
+    std::vector<std::uint8_t> const & m_data;
+    std::size_t                       m_remaining = stream_size;
+};
+
+
+auto make_block() -> std::vector<std::uint8_t>
+{
+    auto result = std::vector<std::uint8_t>(block_size);
+    for (auto ii = 0ull; ii != result.size(); ++ii) {
+        result[ii] = static_cast<std::uint8_t>(ii * 2654435761u >> 13);
+    }
+    return result;
+}
+
+
+
+auto Pipeline_Serial(benchmark::State & state)
+{
+    auto const data   = make_block();
+    auto const device = simulated_device{state.range(0)};
+    auto buffer = std::vector<std::uint8_t>(block_size);
+    auto lfsr   = lfsr_type{};
+
+    for (auto _ : state)
+    {
+        auto source = simulated_source{device, data};
+        while (auto count = source(buffer.data(), buffer.size())) {
+            lfsr.scramble_range(buffer.data(), buffer.data() + count,
+                    buffer.data());
+            device.transfer(count);
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetBytesProcessed(stream_size * state.iterations());
+}
+
+
+auto Pipeline_Overlapped(benchmark::State & state)
+{
+    auto const data   = make_block();
+    auto const device = simulated_device{state.range(0)};
+    auto pipeline = lfsr::pipeline<lfsr_type>{lfsr_type{}, {
+            .block_size  = block_size,
+            .queue_depth = 8,
+        }};
+
+    for (auto _ : state)
+    {
+        auto source = simulated_source{device, data};
+        pipeline.scramble(source, [&](std::uint8_t const * in, std::size_t size) {
+            benchmark::DoNotOptimize(in);
+            device.transfer(size);
+        });
+    }
+    state.SetBytesProcessed(stream_size * state.iterations());
+}
+
+
+auto Pipeline_KernelOnly(benchmark::State & state)
+{
+    auto buffer = make_block();
+    auto lfsr   = lfsr_type{};
+
+    for (auto _ : state)
+    {
+        for (auto done = 0ull; done != stream_size; done += buffer.size()) {
+            lfsr.scramble_range(buffer.data(), buffer.data() + buffer.size(),
+                    buffer.data());
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetBytesProcessed(stream_size * state.iterations());
+}
+
+
+/* Frames built by range(0) threads, each taking every n-th, onto one stream
+   in order: with a mutex and a condition variable, where each thread waits
+   for its turn to scramble its own frame, against `lfsr::sequencer`, where
+   whoever has the next frame scrambles everything that's ready */
+constexpr auto frame_size  = std::size_t{1500};
+constexpr auto frame_count = std::size_t{1} << 14;
+
+template <typename Submit>
+auto submit_frames(std::size_t threads, std::vector<std::uint8_t> & frames,
+                   Submit && submit) -> void
+{
+    auto workers = std::vector<std::jthread>{};
+    for (auto tt = std::size_t{}; tt != threads; ++tt) {
+        workers.emplace_back([&, tt] {
+            for (auto ii = tt; ii < frame_count; ii += threads) {
+                submit(ii, std::span{frames}.subspan(ii * frame_size, frame_size));
+            }
+        });
+    }
+}
+
+
+auto Sequencer_Mutex(benchmark::State & state)
+{
+    auto const threads = static_cast<std::size_t>(state.range(0));
+    auto frames = std::vector<std::uint8_t>(frame_size * frame_count);
+    auto lfsr   = lfsr_type{};
+
+    for (auto _ : state)
+    {
+        auto mutex = std::mutex{};
+        auto turn  = std::condition_variable{};
+        auto next  = std::uint64_t{};
+        submit_frames(threads, frames, [&](std::uint64_t sequence,
+                std::span<std::uint8_t> frame) {
+            auto lock = std::unique_lock{mutex};
+            turn.wait(lock, [&] { return next == sequence; });
+            lfsr.scramble_range(frame.data(), frame.data() + frame.size(),
+                    frame.data());
+            ++next;
+            turn.notify_all();
+        });
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(frames.size())
+            * state.iterations());
+}
+
+
+auto Sequencer_LockFree(benchmark::State & state)
+{
+    auto const threads = static_cast<std::size_t>(state.range(0));
+    auto frames = std::vector<std::uint8_t>(frame_size * frame_count);
+
+    for (auto _ : state)
+    {
+        auto sequencer = lfsr::sequencer{64, [](std::uint64_t,
+                std::span<std::uint8_t> frame) {
+            benchmark::DoNotOptimize(frame.data());
+        }, lfsr_type{}};
+        submit_frames(threads, frames, [&](std::uint64_t sequence,
+                std::span<std::uint8_t> frame) {
+            sequencer.submit(sequence, frame);
+        });
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(frames.size())
+            * state.iterations());
+}
+
+
+#define PIPELINE_OPTS ->UseRealTime()->Unit(benchmark::kMillisecond)
+
+BENCHMARK(Pipeline_KernelOnly)PIPELINE_OPTS;
+BENCHMARK(Pipeline_Serial)->Arg(50)->Arg(200)->Arg(800)PIPELINE_OPTS;
+BENCHMARK(Pipeline_Overlapped)->Arg(50)->Arg(200)->Arg(800)PIPELINE_OPTS;
+
+BENCHMARK(Sequencer_Mutex)->Arg(1)->Arg(4)PIPELINE_OPTS;
+BENCHMARK(Sequencer_LockFree)->Arg(1)->Arg(4)PIPELINE_OPTS;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,533 @@
+#!/usr/bin/env python3
+"""Keeps a history of bench_lfsr results, gates on regressions and plots them.
+
+Uses nothing beyond the Python standard library, so runs anywhere bench_lfsr
+does.
+
+    # Run the benchmarks with repetitions, so there's a spread to test against
+    bench_lfsr --benchmark_repetitions=5 --benchmark_out=run.json \\
+               --benchmark_out_format=json
+
+    # File it under the current commit, compiler and CPU
+    bench_report.py record run.json
+
+    # Compare against an earlier commit on the same compiler and CPU, exiting
+    # with 1 if anything got significantly slower by more than 5%
+    bench_report.py compare main run.json --threshold 0.05
+
+    # SVG charts for every engine, plus an HTML page of them all
+    bench_report.py plot run.json --output report
+
+Records are stored as one JSON file each under `bench_history/` (or
+`--history`), named for the commit, compiler and CPU they were taken on. Either
+side of `compare`, and any input to `plot`, may be a raw Google Benchmark JSON
+file, a record, or a commit (anything `git rev-parse` understands), which picks
+the newest record for that commit.
+"""
+
+import argparse
+import datetime
+import html
+import json
+import math
+import os
+import platform
+import re
+import subprocess
+import sys
+
+from collections import defaultdict
+
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+default_history = os.path.join(script_dir, 'bench_history')
+
+
+
+# --- Collecting --------------------------------------------------------------
+
+def git(*args):
+    try:
+        return subprocess.run(['git', '-C', script_dir, *args],
+                              capture_output=True, text=True,
+                              check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def cpu_model():
+    try:
+        with open('/proc/cpuinfo') as fd:
+            for line in fd:
+                if line.startswith('model name'):
+                    return line.split(':', 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or platform.machine()
+
+
+def slug(text):
+    return re.sub(r'[^A-Za-z0-9.]+', '-', text).strip('-').lower()
+
+
+def load_benchmark_json(path):
+    """Groups a Google Benchmark JSON file's runs by benchmark, keeping every
+    repetition, so the spread is available for comparison."""
+    with open(path) as fd:
+        data = json.load(fd)
+
+    results = defaultdict(lambda: {'bytes_per_second': [], 'real_time': []})
+    for run in data.get('benchmarks', []):
+        if run.get('run_type', 'iteration') != 'iteration':
+            continue
+        if 'bytes_per_second' not in run:
+            continue
+        name = run.get('run_name', run['name'])
+        results[name]['bytes_per_second'].append(run['bytes_per_second'])
+        results[name]['real_time'].append(run['real_time'])
+        results[name]['time_unit'] = run.get('time_unit', 'ns')
+    return data.get('context', {}), dict(results)
+
+
+def make_record(path, commit=None, compiler=None, cpu=None):
+    context, results = load_benchmark_json(path)
+    commit = commit or git('rev-parse', 'HEAD') or 'unknown'
+    return {
+        'commit':   commit,
+        'subject':  git('log', '-1', '--format=%s', commit) or '',
+        'date':     context.get('date')
+                    or datetime.datetime.now().isoformat(timespec='seconds'),
+        'compiler': compiler or context.get('compiler', 'unknown'),
+        'cpu':      cpu or cpu_model(),
+        'host':     context.get('host_name', platform.node()),
+        'build':    context.get('library_build_type', ''),
+        'results':  results,
+    }
+
+
+def record_path(history, record):
+    name = '{}-{}-{}-{}.json'.format(
+        record['commit'][:12],
+        slug(record['compiler']),
+        slug(record['cpu']),
+        slug(record['date']))
+    return os.path.join(history, name)
+
+
+def load_records(history):
+    if not os.path.isdir(history):
+        return []
+    records = []
+    for name in sorted(os.listdir(history)):
+        if name.endswith('.json'):
+            with open(os.path.join(history, name)) as fd:
+                records.append(json.load(fd))
+    return records
+
+
+def resolve(spec, history, like=None):
+    """A record from a file (raw or recorded) or a commit in the history. When
+    `like` is given, only records from the same compiler and CPU count."""
+    if os.path.isfile(spec):
+        with open(spec) as fd:
+            data = json.load(fd)
+        return data if 'results' in data else make_record(spec)
+
+    commit = git('rev-parse', spec) or spec
+    candidates = [
+        r for r in load_records(history)
+        if r['commit'].startswith(commit) or commit.startswith(r['commit'])
+    ]
+    if like is not None:
+        candidates = [
+            r for r in candidates
+            if r['compiler'] == like['compiler'] and r['cpu'] == like['cpu']
+        ]
+    if not candidates:
+        raise SystemExit(f'no results for {spec!r} in {history}'
+                         + (f' from {like["compiler"]} on {like["cpu"]}'
+                            if like else ''))
+    return max(candidates, key=lambda r: r['date'])
+
+
+
+# --- Statistics --------------------------------------------------------------
+
+def mean(values):
+    return sum(values) / len(values)
+
+
+def variance(values):
+    if len(values) < 2:
+        return 0.0
+    m = mean(values)
+    return sum((v - m) ** 2 for v in values) / (len(values) - 1)
+
+
+def incomplete_beta(a, b, x):
+    """The regularised incomplete beta function I_x(a, b), by Lentz's continued
+    fraction."""
+    if x <= 0:
+        return 0.0
+    if x >= 1:
+        return 1.0
+    if x > (a + 1) / (a + b + 2):
+        return 1.0 - incomplete_beta(b, a, 1 - x)
+
+    front = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b)
+                     + a * math.log(x) + b * math.log(1 - x)) / a
+    tiny = 1e-300
+    f, c, d = 1.0, 1.0, 0.0
+    for i in range(200):
+        m = i // 2
+        if i == 0:
+            numerator = 1.0
+        elif i % 2 == 0:
+            numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m))
+        else:
+            numerator = -((a + m) * (a + b + m) * x
+                          / ((a + 2 * m) * (a + 2 * m + 1)))
+        d = 1.0 + numerator * d
+        d = 1.0 / (d if abs(d) > tiny else tiny)
+        c = 1.0 + numerator / c
+        c = c if abs(c) > tiny else tiny
+        f *= c * d
+        if abs(1.0 - c * d) < 1e-12:
+            break
+    return front * (f - 1.0)
+
+
+def welch_p_value(lhs, rhs):
+    """Two sided p-value of Welch's t-test that the two samples share a mean,
+    or None if there aren't enough samples to tell."""
+    if len(lhs) < 2 or len(rhs) < 2:
+        return None
+    var_l = variance(lhs) / len(lhs)
+    var_r = variance(rhs) / len(rhs)
+    if var_l + var_r == 0:
+        return 0.0 if mean(lhs) != mean(rhs) else 1.0
+    t = (mean(lhs) - mean(rhs)) / math.sqrt(var_l + var_r)
+    dof = (var_l + var_r) ** 2 / (var_l ** 2 / (len(lhs) - 1)
+                                  + var_r ** 2 / (len(rhs) - 1))
+    return incomplete_beta(dof / 2, 0.5, dof / (dof + t * t))
+
+
+
+# --- Comparing ---------------------------------------------------------------
+
+def compare(base, current, threshold, alpha, filter_regex):
+    """Prints the change in throughput of every benchmark in both, returning
+    the names of those that regressed."""
+    pattern = re.compile(filter_regex) if filter_regex else None
+    names = sorted(set(base['results']) & set(current['results']))
+    if pattern:
+        names = [n for n in names if pattern.search(n)]
+
+    print(f'base:    {base["commit"][:12]} {base.get("subject", "")}')
+    print(f'current: {current["commit"][:12]} {current.get("subject", "")}')
+    if (base['compiler'], base['cpu']) != (current['compiler'], current['cpu']):
+        print('warning: comparing across compilers or CPUs: '
+              f'{base["compiler"]} on {base["cpu"]} vs '
+              f'{current["compiler"]} on {current["cpu"]}')
+    print()
+
+    width = max([len(n) for n in names] + [9])
+    print(f'{"benchmark":<{width}}  {"base MB/s":>10}  {"now MB/s":>10}  '
+          f'{"change":>8}  {"p":>6}')
+
+    regressions = []
+    unrepeated = False
+    for name in names:
+        before = base['results'][name]['bytes_per_second']
+        after = current['results'][name]['bytes_per_second']
+        change = mean(after) / mean(before) - 1.0
+        p = welch_p_value(before, after)
+        unrepeated |= p is None
+
+        significant = p is None or p < alpha
+        regressed = change < -threshold and significant
+        if regressed:
+            regressions.append(name)
+
+        print(f'{name:<{width}}  {mean(before) / 1e6:>10.1f}  '
+              f'{mean(after) / 1e6:>10.1f}  {change:>+8.1%}  '
+              f'{"-" if p is None else f"{p:.3f}":>6}'
+              f'{"  REGRESSED" if regressed else ""}')
+
+    if unrepeated:
+        print('\nnote: some benchmarks have a single run, so only the threshold '
+              'applies to them; use --benchmark_repetitions')
+    return regressions
+
+
+
+# --- Plotting ----------------------------------------------------------------
+
+palette = ['#559CFF', '#f147ab', '#B511F2', '#2ecc71', '#f39c12', '#e74c3c',
+           '#1abc9c', '#9b59b6', '#95a5a6', '#d35400']
+
+name_regex = re.compile(r'^(?P<func>[A-Za-z0-9_]+)(?:<(?P<args>[^>]*)>)?'
+                        r'(?P<params>(?:/\d+)*)')
+
+
+def parse_name(name):
+    """Splits e.g. `LFSR_Range<Galois_12, scramble>/4096/real_time` into the
+    function, its template arguments and its numeric parameters."""
+    match = name_regex.match(name)
+    if not match:
+        return name, [], []
+    args = [a.strip() for a in (match.group('args') or '').split(',') if a]
+    params = [int(p) for p in match.group('params').split('/') if p]
+    return match.group('func'), args, params
+
+
+def charts_for(results):
+    """Groups the benchmarks into charts of series.
+
+    * Benchmarks with a size parameter are plotted against it, one chart per
+      function and remaining arguments, one series per first argument (the
+      engine); memcpy and memset are drawn on each as the roofline.
+    * Those templated on a `Degree_N` are plotted against the degree, one
+      series per function (engine).
+    * Anything else is a bar per benchmark.
+    """
+    charts = defaultdict(lambda: {'series': defaultdict(list), 'kind': None})
+    rooflines = defaultdict(list)
+
+    for name, values in results.items():
+        func, args, params = parse_name(name)
+        bps = mean(values['bytes_per_second'])
+        degrees = [int(m.group(1)) for a in args
+                   for m in [re.match(r'Degree_(\d+)$', a)] if m]
+
+        if params and not args:
+            rooflines[func].append((params[0], bps))
+        elif params:
+            title = ' '.join([func] + args[1:]) + ' by size'
+            charts[title]['kind'] = 'size'
+            charts[title]['series'][args[0]].append((params[0], bps))
+        elif degrees:
+            charts['Throughput by degree']['kind'] = 'degree'
+            charts['Throughput by degree']['series'][func].append(
+                (degrees[0], bps))
+        else:
+            charts[func]['kind'] = 'bar'
+            charts[func]['series'][', '.join(args) or func].append((0, bps))
+
+    for chart in charts.values():
+        if chart['kind'] == 'size':
+            for func, points in rooflines.items():
+                chart['series'][func + ' (roofline)'] = points
+        for points in chart['series'].values():
+            points.sort()
+    return charts
+
+
+def format_size(value):
+    for unit in ['B', 'KiB', 'MiB', 'GiB']:
+        if value < 1024:
+            return f'{value:g} {unit}'
+        value /= 1024
+    return f'{value:g} TiB'
+
+
+def format_rate(value):
+    for unit in ['B/s', 'KB/s', 'MB/s', 'GB/s']:
+        if value < 1000:
+            return f'{value:.3g} {unit}'
+        value /= 1000
+    return f'{value:.3g} TB/s'
+
+
+def svg_chart(title, subtitle, kind, series, width=800, height=500):
+    left, right, top, bottom = 80, 220, 60, 50
+    plot_w = width - left - right
+    plot_h = height - top - bottom
+
+    max_y = max((y for pts in series.values() for _, y in pts), default=1) * 1.05
+    xs = sorted({x for pts in series.values() for x, _ in pts})
+    log_x = kind == 'size'
+
+    if kind == 'bar':
+        labels = list(series)
+
+        def x_of(i):
+            return left + (i + 0.5) * plot_w / max(len(labels), 1)
+    else:
+        lo, hi = (min(xs), max(xs)) if xs else (0, 1)
+        if log_x:
+            lo, hi = math.log2(lo), math.log2(hi)
+        hi = hi if hi != lo else lo + 1
+
+        def x_of(x):
+            v = math.log2(x) if log_x else x
+            return left + (v - lo) / (hi - lo) * plot_w
+
+    def y_of(y):
+        return top + plot_h - y / max_y * plot_h
+
+    out = [
+        f'<svg xmlns="http://www.w3.org/2000/svg" width="{width}" '
+        f'height="{height}" font-family="sans-serif" font-size="12">',
+        f'<rect width="{width}" height="{height}" fill="#151515"/>',
+        f'<text x="{left}" y="24" fill="#eee" font-size="16">'
+        f'{html.escape(title)}</text>',
+        f'<text x="{left}" y="42" fill="#999">{html.escape(subtitle)}</text>',
+    ]
+
+    for i in range(6):
+        y = max_y * i / 5
+        out.append(f'<line x1="{left}" x2="{left + plot_w}" y1="{y_of(y):.1f}" '
+                   f'y2="{y_of(y):.1f}" stroke="#2a2a2a"/>')
+        out.append(f'<text x="{left - 6}" y="{y_of(y) + 4:.1f}" fill="#999" '
+                   f'text-anchor="end">{format_rate(y)}</text>')
+
+    if kind != 'bar':
+        for x in xs:
+            label = format_size(x) if log_x else str(x)
+            out.append(f'<text x="{x_of(x):.1f}" y="{top + plot_h + 16}" '
+                       f'fill="#999" text-anchor="middle">{label}</text>')
+        axis = {'size': 'Buffer size', 'degree': 'Degree', 'history': 'Run'}
+        out.append(f'<text x="{left + plot_w / 2}" y="{height - 10}" '
+                   f'fill="#999" text-anchor="middle">{axis[kind]}</text>')
+
+    for index, (name, points) in enumerate(series.items()):
+        colour = palette[index % len(palette)]
+        dashed = ' stroke-dasharray="4 3"' if 'roofline' in name else ''
+        if kind == 'bar':
+            bar_w = plot_w / max(len(labels), 1) * 0.6
+            y = points[0][1]
+            out.append(f'<rect x="{x_of(index) - bar_w / 2:.1f}" '
+                       f'y="{y_of(y):.1f}" width="{bar_w:.1f}" '
+                       f'height="{top + plot_h - y_of(y):.1f}" fill="{colour}"/>')
+        else:
+            path = ' '.join(f'{x_of(x):.1f},{y_of(y):.1f}' for x, y in points)
+            out.append(f'<polyline points="{path}" fill="none" '
+                       f'stroke="{colour}" stroke-width="2"{dashed}/>')
+            for x, y in points:
+                out.append(f'<circle cx="{x_of(x):.1f}" cy="{y_of(y):.1f}" '
+                           f'r="2.5" fill="{colour}"/>')
+
+        ly = top + 14 * index
+        out.append(f'<rect x="{left + plot_w + 16}" y="{ly}" width="10" '
+                   f'height="10" fill="{colour}"/>')
+        out.append(f'<text x="{left + plot_w + 32}" y="{ly + 9}" fill="#ddd">'
+                   f'{html.escape(name)}</text>')
+
+    out.append(f'<rect x="{left}" y="{top}" width="{plot_w}" height="{plot_h}" '
+               f'fill="none" stroke="#444"/>')
+    out.append('</svg>')
+    return '\n'.join(out)
+
+
+def history_charts(records):
+    """For each chart, the geometric mean throughput of each series per
+    record, in the order given."""
+    charts = defaultdict(lambda: defaultdict(list))
+    for index, record in enumerate(records):
+        for title, chart in charts_for(record['results']).items():
+            for name, points in chart['series'].items():
+                values = [y for _, y in points if y > 0]
+                if values:
+                    gmean = math.exp(mean([math.log(v) for v in values]))
+                    charts[title][name].append((index, gmean))
+    return charts
+
+
+def plot(records, output):
+    os.makedirs(output, exist_ok=True)
+    latest = records[-1]
+    subtitle = f'{latest["commit"][:12]}, {latest["compiler"]}, {latest["cpu"]}'
+
+    files = []
+    for title, chart in sorted(charts_for(latest['results']).items()):
+        name = slug(title) + '.svg'
+        with open(os.path.join(output, name), 'w') as fd:
+            fd.write(svg_chart(title, subtitle, chart['kind'], chart['series']))
+        files.append((title, name))
+
+    if len(records) > 1:
+        commits = ', '.join(r['commit'][:7] for r in records)
+        for title, series in sorted(history_charts(records).items()):
+            name = 'history-' + slug(title) + '.svg'
+            with open(os.path.join(output, name), 'w') as fd:
+                fd.write(svg_chart(f'{title} (history)', commits, 'history',
+                                   series))
+            files.append((f'{title} (history)', name))
+
+    with open(os.path.join(output, 'index.html'), 'w') as fd:
+        fd.write('<!DOCTYPE html>\n<html><head><meta charset="utf-8">'
+                 '<title>bench_lfsr</title></head>\n'
+                 '<body style="background:#111;color:#eee;font-family:sans-serif">\n'
+                 f'<h1>bench_lfsr</h1><p>{html.escape(subtitle)}</p>\n')
+        for title, name in files:
+            fd.write(f'<h2>{html.escape(title)}</h2><img src="{name}">\n')
+        fd.write('</body></html>\n')
+    print(f'wrote {len(files)} charts to {output}/index.html')
+
+
+
+# --- Command line ------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Record, compare and plot bench_lfsr results',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog=__doc__)
+    parser.add_argument('--history', default=default_history,
+                        help='Directory of recorded results')
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    record = commands.add_parser('record', help='Add a run to the history')
+    record.add_argument('input', help='Google Benchmark JSON output')
+    record.add_argument('--commit', help='Defaults to HEAD')
+    record.add_argument('--compiler',
+                        help='Defaults to what bench_lfsr reports')
+    record.add_argument('--cpu', help='Defaults to the model in /proc/cpuinfo')
+
+    comp = commands.add_parser('compare', help='Compare two runs, exiting '
+                               'with 1 if anything regressed')
+    comp.add_argument('base', help='File or commit')
+    comp.add_argument('current', help='File or commit')
+    comp.add_argument('--threshold', type=float, default=0.05,
+                      help='Fractional slow down that counts as a regression '
+                           '(default 0.05)')
+    comp.add_argument('--alpha', type=float, default=0.05,
+                      help='Significance level (default 0.05)')
+    comp.add_argument('--filter', help='Only compare benchmarks matching this '
+                      'regular expression')
+
+    plt = commands.add_parser('plot', help='Write SVG charts and an HTML page')
+    plt.add_argument('inputs', nargs='+', help='Files or commits, oldest first; '
+                     'the last is charted in full, and all of them over time')
+    plt.add_argument('--output', default='bench_report',
+                     help='Output directory (default bench_report)')
+
+    args = parser.parse_args()
+
+    if args.command == 'record':
+        result = make_record(args.input, args.commit, args.compiler, args.cpu)
+        os.makedirs(args.history, exist_ok=True)
+        path = record_path(args.history, result)
+        with open(path, 'w') as fd:
+            json.dump(result, fd, indent=1, sort_keys=True)
+        print(f'recorded {len(result["results"])} benchmarks to {path}')
+
+    elif args.command == 'compare':
+        current = resolve(args.current, args.history)
+        base = resolve(args.base, args.history, like=current)
+        regressions = compare(base, current, args.threshold, args.alpha,
+                              args.filter)
+        if regressions:
+            print(f'\n{len(regressions)} benchmark(s) regressed by more than '
+                  f'{args.threshold:.0%}')
+            return 1
+
+    elif args.command == 'plot':
+        plot([resolve(spec, args.history) for spec in args.inputs], args.output)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -6,14 +6,19 @@
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include <format>   // DEBUG
 #include <iostream> // DEBUG
 
 #include <lfsr_detail.hpp>
+#include <lfsr_stats.hpp>
+#include <lfsr_word_array.hpp>
 
 namespace lfsr {
 
@@ -29,11 +34,17 @@ struct lfsr_traits
     constexpr static auto buffer_size = degree;
     constexpr static auto tap_indices = tap_list::to_indices::values;
     constexpr static auto lowest_tap  = tap_list::lowest();
+    constexpr static auto period      = detail::max_period<degree>();
 
-    using buffer_type = std::bitset<buffer_size>;
+    using buffer_type = word_array<buffer_size>;
+    using state_type  = std::bitset<degree>;
+
+    /* Tap positions in the register, for the Galois implementation */
+    constexpr static auto tap_mask = 
+            detail::make_mask<buffer_size>(tap_indices);
 
     /* For intialising buffer state to 0 */
-    static auto all_ones() -> buffer_type
+    constexpr static auto all_ones() -> buffer_type
     {
         return buffer_type{}.set();
     }
@@ -47,28 +58,41 @@ struct lfsr_bulk_traits
     constexpr static auto degree = std::max({Taps...});
     constexpr static auto char_bits = sizeof(char) * 8;
     constexpr static auto buffer_size = degree + char_bits;
+    constexpr static auto period = detail::max_period<degree>();
 
     using tap_list        = detail::make_tap_list_t<Taps...>;
-    using buffer_type     = std::bitset<buffer_size>;
+    using buffer_type     = word_array<buffer_size>;
+    using register_type   = word_array<degree>;
     using state_type      = std::bitset<degree>;
     using dependency_list = std::array<buffer_type, char_bits>;
     
     /* For intialising buffer state to 0 */
-    static auto all_ones() -> buffer_type
+    constexpr static auto all_ones() -> register_type
     {
-        return buffer_type{}.set();
+        return register_type{}.set();
+    }
+
+    /* The part of a dependency mask that applies to the register state */
+    constexpr static auto state_part(buffer_type const & mask) -> register_type
+    {
+        auto result = register_type{};
+        for (auto ii = 0ull; ii != degree; ++ii) {
+            result.set(ii, mask.test(ii));
+        }
+        return result;
     }
 
-    static auto state_mask() -> buffer_type
+    /* The part of a dependency mask that applies to the input byte */
+    constexpr static auto input_part(buffer_type const & mask) -> std::uint8_t
     {
-        auto result = buffer_type{};
-        for (auto ii = 0; ii != degree; ++ii) {
-            result.set(ii);
+        auto result = std::uint8_t{};
+        for (auto ii = 0ull; ii != char_bits; ++ii) {
+            result |= mask.test(degree + ii) << ii;
         }
         return result;
     }
 
-    static auto scramble_dependencies() -> dependency_list
+    constexpr static auto scramble_dependencies() -> dependency_list
     {
         auto result = dependency_list{};
 
@@ -121,7 +145,7 @@ struct lfsr_bulk_traits
     }
 
 
-    static auto descramble_dependencies() -> dependency_list
+    constexpr static auto descramble_dependencies() -> dependency_list
     {
         auto result = dependency_list{};
 
@@ -129,8 +153,13 @@ struct lfsr_bulk_traits
         {
             auto tap_mask  = buffer_type{};
             for (auto tap : {Taps...}) {
-                tap_mask.flip(degree - tap + b);
+                /* The input bit is added below, so that it's present whether
+                   or not the tap list names the zero tap. */
+                if (tap != 0) {
+                    tap_mask.flip(degree - tap + b);
+                }
             }
+            tap_mask.set(degree + b);
 
             result[b] = tap_mask;
         }
@@ -143,27 +172,110 @@ struct lfsr_bulk_traits
 
 
 
-template <std::size_t ... Taps>
-class feedthrough_fibonacci 
+/* Every engine takes a statistics policy, `Stats`, which is told about each
+   call made to it (see lfsr_stats.hpp). `feedthrough_fibonacci` etc. are the
+   engines with the default `no_stats`, which compiles to nothing. */
+template <typename Stats, std::size_t ... Taps>
+class basic_feedthrough_fibonacci 
 {
 public:
     using traits      = lfsr_traits<Taps...>;
     using buffer_type = typename traits::buffer_type;
+    using stats_type  = Stats;
 
     constexpr static auto degree = traits::degree;
-    constexpr static auto period = (1ull << degree) - 1;
+    constexpr static auto period = traits::period;
 
-    feedthrough_fibonacci()
+    constexpr basic_feedthrough_fibonacci() noexcept
         : m_buffer{traits::all_ones()}
     {
     }
 
-    auto state() -> std::bitset<degree>
+    auto state() const -> std::bitset<degree>
+    {
+        return m_buffer.to_bitset();
+    }
+
+    /* The state is the last `degree` scrambled bits, as from `state()` */
+    auto set_state(std::bitset<degree> const & state) -> void
+    {
+        m_buffer = buffer_type::from_bitset(state);
+    }
+
+    /* Back to all ones, as constructed */
+    auto reset() noexcept -> void
+    {
+        m_buffer = traits::all_ones();
+    }
+
+    /* Reseeds, e.g. at the start of a frame, with `seed` as the last bits
+       scrambled: bit i of it is bit i of `state()`. Bits of the seed from the
+       degree up are ignored, and above a degree of 64 the older bits are
+       zero. */
+    auto reset(std::uint64_t seed) noexcept -> void
     {
-        return m_buffer;
+        set_state(std::bitset<degree>{seed});
     }
 
     auto scramble_bit(bool input) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::bit, 1);
+        return scramble_step(input);
+    }
+
+    auto descramble_bit(bool input) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::bit, 1);
+        return descramble_step(input);
+    }
+
+    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::byte, 8);
+        return scramble_byte_step(value);
+    }
+
+    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::byte, 8);
+        return descramble_byte_step(value);
+    }
+
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto scramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
+    {
+        auto stats = track(stats_direction::scramble, stats_call::range);
+        for (; first != last; ++first, ++d_first) {
+            *d_first = scramble_byte_step(*first);
+            stats.add_bits(8);
+        }
+    }
+
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto descramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
+    {
+        auto stats = track(stats_direction::descramble, stats_call::range);
+        for (; first != last; ++first, ++d_first) {
+            *d_first = descramble_byte_step(*first);
+            stats.add_bits(8);
+        }
+    }
+
+    buffer_type m_buffer;
+
+private:
+    static auto track(stats_direction dir, stats_call call,
+                      std::uint64_t bits = 0) noexcept
+        -> detail::stats_scope<Stats>
+    {
+        return {dir, call, stats_kernel::fibonacci, bits};
+    }
+
+    auto scramble_step(bool input) noexcept -> bool
     {
         /* Fibonacci implementation 
            This is the most straightforward way to implement an LFSR. The taps
@@ -182,7 +294,7 @@ public:
         return input;
     }
 
-    auto descramble_bit(bool input) noexcept -> bool
+    auto descramble_step(bool input) noexcept -> bool
     {
         auto result = input;
         for (auto t : traits::tap_indices) {
@@ -194,33 +306,110 @@ public:
         return result;
     };
 
-    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    auto scramble_byte_step(std::uint8_t value) noexcept -> std::uint8_t
     {
         auto result = std::uint8_t{};
         for (auto ii = 0ull; ii != 8; ++ii) {
-            result |= scramble_bit(value & 1) << ii;
+            result |= scramble_step(value & 1) << ii;
             value >>= 1;
         }
         return result;
     }
 
-    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    auto descramble_byte_step(std::uint8_t value) noexcept -> std::uint8_t
     {
         auto result = std::uint8_t{};
         for (auto ii = 0ull; ii != 8; ++ii) {
-            result |= descramble_bit(value & 1) << ii;
+            result |= descramble_step(value & 1) << ii;
             value >>= 1;
         }
         return result;
     }
+};
+
+
+
+
+
+template <typename Stats, std::size_t ... Taps>
+class basic_feedthrough_galois 
+{
+public:
+    using traits      = lfsr_traits<Taps...>;
+    using buffer_type = typename traits::buffer_type;
+    using stats_type  = Stats;
+
+    constexpr static auto degree = traits::degree;
+    constexpr static auto period = traits::period;
+
+    constexpr basic_feedthrough_galois() noexcept
+        : m_buffer{traits::all_ones()}
+    {
+    }
+
+    auto state() const -> std::bitset<degree>
+    {
+        return m_buffer.to_bitset();
+    }
+
+    /* Takes a state as returned by `state()`. Unlike the Fibonacci engines
+       this isn't the last `degree` scrambled bits, but the register that
+       they produce. */
+    auto set_state(std::bitset<degree> const & state) -> void
+    {
+        m_buffer = buffer_type::from_bitset(state);
+    }
+
+    /* Back to all ones, as constructed */
+    auto reset() noexcept -> void
+    {
+        m_buffer = traits::all_ones();
+    }
+
+    /* Reseeds, e.g. at the start of a frame, with `seed` loaded into the
+       register, bit i of it being bit i of `state()`. Unlike the Fibonacci
+       engines, that's the register itself and not the last bits scrambled,
+       so a seed needn't give the keystream it does there. Bits of the seed
+       from the degree up are ignored, and above a degree of 64 the rest of
+       the register is zero. */
+    auto reset(std::uint64_t seed) noexcept -> void
+    {
+        set_state(std::bitset<degree>{seed});
+    }
+
+    auto scramble_bit(bool input) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::bit, 1);
+        return scramble_step(input);
+    }
+
+    auto descramble_bit(bool input) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::bit, 1);
+        return descramble_step(input);
+    }
+
+    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::byte, 8);
+        return scramble_byte_step(value);
+    }
+
+    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::byte, 8);
+        return descramble_byte_step(value);
+    }
 
 
     template <typename Iter1, typename Iter2>
         requires detail::iter_is_byte<Iter1>
     auto scramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
     {
+        auto stats = track(stats_direction::scramble, stats_call::range);
         for (; first != last; ++first, ++d_first) {
-            *d_first = scramble_byte(*first);
+            *d_first = scramble_byte_step(*first);
+            stats.add_bits(8);
         }
     }
 
@@ -229,43 +418,24 @@ public:
         requires detail::iter_is_byte<Iter1>
     auto descramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
     {
+        auto stats = track(stats_direction::descramble, stats_call::range);
         for (; first != last; ++first, ++d_first) {
-            *d_first = descramble_byte(*first);
+            *d_first = descramble_byte_step(*first);
+            stats.add_bits(8);
         }
     }
 
     buffer_type m_buffer;
-};
-
-
-
-
 
-template <std::size_t ... Taps>
-class feedthrough_galois 
-{
-public:
-    using traits      = lfsr_traits<Taps...>;
-    using buffer_type = typename traits::buffer_type;
-
-    constexpr static auto degree = traits::degree;
-    constexpr static auto period = (1ull << degree) - 1;
-
-    feedthrough_galois()
-        : m_buffer{traits::all_ones()}
-        , m_taps{}
-    {
-        for (auto t : traits::tap_indices) {
-            this->m_taps.set(t);
-        }
-    }
-
-    auto state() -> std::bitset<degree>
+private:
+    static auto track(stats_direction dir, stats_call call,
+                      std::uint64_t bits = 0) noexcept
+        -> detail::stats_scope<Stats>
     {
-        return m_buffer;
+        return {dir, call, stats_kernel::galois, bits};
     }
 
-    auto scramble_bit(bool input) noexcept -> bool
+    auto scramble_step(bool input) noexcept -> bool
     {
         /* Galois implementation
            In order to get the same sequence as the Fibanacci implementation, we
@@ -278,51 +448,146 @@ public:
         auto out = this->m_buffer.test(0) ^ input;
         this->m_buffer >>= 1;
         if (out) {
-            this->m_buffer ^= this->m_taps;
+            detail::masked_xor<traits::tap_mask>(this->m_buffer);
         }
         this->m_buffer.set(traits::degree - 1, out);
         return out;
     }
 
-    auto descramble_bit(bool input) noexcept -> bool
+    auto descramble_step(bool input) noexcept -> bool
     {
         /* Galois implementation */
         auto out = this->m_buffer.test(0) ^ input;
         this->m_buffer >>= 1;
         if (input) {
-            this->m_buffer ^= this->m_taps;
+            detail::masked_xor<traits::tap_mask>(this->m_buffer);
         }
         this->m_buffer.set(traits::degree - 1, input);
         return out;
     };
 
-    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    auto scramble_byte_step(std::uint8_t value) noexcept -> std::uint8_t
     {
         auto result = std::uint8_t{};
         for (auto ii = 0ull; ii != 8; ++ii) {
-            result |= scramble_bit(value & 1) << ii;
+            result |= scramble_step(value & 1) << ii;
             value >>= 1;
         }
         return result;
     }
 
-    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    auto descramble_byte_step(std::uint8_t value) noexcept -> std::uint8_t
     {
         auto result = std::uint8_t{};
         for (auto ii = 0ull; ii != 8; ++ii) {
-            result |= descramble_bit(value & 1) << ii;
+            result |= descramble_step(value & 1) << ii;
             value >>= 1;
         }
         return result;
     }
+};
+
+
+
+
+
+
+
+
+
+
+
+
+template <typename Stats, std::size_t ... Taps>
+class basic_feedthrough_fibonacci_bulk
+{
+public:
+    using traits          = lfsr_bulk_traits<Taps...>;
+    using buffer_type     = typename traits::buffer_type;
+    using register_type   = typename traits::register_type;
+    using dependency_list = typename traits::dependency_list;
+    using stats_type      = Stats;
+
+    constexpr static auto degree = traits::degree;
+    constexpr static auto period = traits::period;
+
+    /* The dependency masks are worked out at compile time and shared by every
+       instance, so constructing one only has to set the register. */
+    constexpr static auto deps_scramble   = traits::scramble_dependencies();
+    constexpr static auto deps_descramble = traits::descramble_dependencies();
+
+    constexpr basic_feedthrough_fibonacci_bulk() noexcept
+        : m_buffer{traits::all_ones()}
+    {
+    }
+
+    auto state() const -> std::bitset<degree>
+    {
+        /* The register holds the oldest bit at index 0. It is reversed so that
+           the state reads the same as the other implementations, where bit 0
+           is the most recent bit. */
+        auto result = std::bitset<degree>{};
+        for (auto ii = 0ull; ii != degree; ++ii) {
+            result.set(ii, m_buffer.test(degree - 1 - ii));
+        }
+        return result;
+    }
+
+    /* The state is the last `degree` scrambled bits, as from `state()` */
+    auto set_state(std::bitset<degree> const & state) noexcept -> void
+    {
+        for (auto ii = 0ull; ii != degree; ++ii) {
+            m_buffer.set(degree - 1 - ii, state.test(ii));
+        }
+    }
+
+    /* Back to all ones, as constructed */
+    auto reset() noexcept -> void
+    {
+        m_buffer = traits::all_ones();
+    }
+
+    /* As the bit at a time engine's: `seed` becomes the last bits scrambled,
+       bit i of it being bit i of `state()`, with any from the degree up
+       ignored and any above 64 zero */
+    auto reset(std::uint64_t seed) noexcept -> void
+    {
+        set_state(std::bitset<degree>{seed});
+    }
+
+    auto scramble_bit(bool value) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::bit, 1);
+        return scramble_step(value);
+    }
+
+    auto descramble_bit(bool value) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::bit, 1);
+        return descramble_step(value);
+    }
+
+    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::byte, 8);
+        return scramble_byte_step(value);
+    }
+
+    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::byte, 8);
+        return descramble_byte_step(value);
+    }
 
 
     template <typename Iter1, typename Iter2>
         requires detail::iter_is_byte<Iter1>
     auto scramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
     {
+        auto stats = track(stats_direction::scramble, stats_call::range);
         for (; first != last; ++first, ++d_first) {
-            *d_first = scramble_byte(*first);
+            *d_first = scramble_byte_step(*first);
+            stats.add_bits(8);
         }
     }
 
@@ -331,107 +596,194 @@ public:
         requires detail::iter_is_byte<Iter1>
     auto descramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
     {
+        auto stats = track(stats_direction::descramble, stats_call::range);
         for (; first != last; ++first, ++d_first) {
-            *d_first = descramble_byte(*first);
+            *d_first = descramble_byte_step(*first);
+            stats.add_bits(8);
         }
     }
 
-    buffer_type m_buffer;
-    buffer_type m_taps;
-};
+private:
+    static auto track(stats_direction dir, stats_call call,
+                      std::uint64_t bits = 0) noexcept
+        -> detail::stats_scope<Stats>
+    {
+        return {dir, call, stats_kernel::fibonacci_bulk, bits};
+    }
 
+    auto scramble_step(bool value) noexcept -> bool
+    {
+        bool result = output_bit<deps_scramble, 0>(value);
+        m_buffer >>= 1;
+        m_buffer.set(degree - 1, result);
+        return result;
+    } 
 
+    auto descramble_step(bool value) noexcept -> bool
+    {
+        bool result = output_bit<deps_descramble, 0>(value);
+        m_buffer >>= 1;
+        m_buffer.set(degree - 1, value);
+        return result;
+    }
 
+    auto scramble_byte_step(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        auto result = std::uint8_t{};
+        result |= output_bit<deps_scramble, 0>(value);
+        result |= output_bit<deps_scramble, 1>(value);
+        result |= output_bit<deps_scramble, 2>(value);
+        result |= output_bit<deps_scramble, 3>(value);
+        result |= output_bit<deps_scramble, 4>(value);
+        result |= output_bit<deps_scramble, 5>(value);
+        result |= output_bit<deps_scramble, 6>(value);
+        result |= output_bit<deps_scramble, 7>(value);
+
+        /* The output is what later bits depend upon */
+        shift_in(result);
+        return result;
+    }
 
+    auto descramble_byte_step(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        auto result = std::uint8_t{};
+        result |= output_bit<deps_descramble, 0>(value);
+        result |= output_bit<deps_descramble, 1>(value);
+        result |= output_bit<deps_descramble, 2>(value);
+        result |= output_bit<deps_descramble, 3>(value);
+        result |= output_bit<deps_descramble, 4>(value);
+        result |= output_bit<deps_descramble, 5>(value);
+        result |= output_bit<deps_descramble, 6>(value);
+        result |= output_bit<deps_descramble, 7>(value);
+
+        shift_in(value);
+        return result;
+    }
 
+    /* Only the state is stored, rather than the state and the input byte
+       together. Each dependency mask is split into the part that covers the
+       state, and the part that covers the input byte, and the parities of the
+       two are combined. */
+    template <dependency_list const & Deps, std::size_t Bit>
+    auto output_bit(std::uint8_t value) const noexcept -> std::uint8_t
+    {
+        constexpr auto state_mask = traits::state_part(Deps[Bit]);
+        constexpr auto input_mask = traits::input_part(Deps[Bit]);
 
+        auto const input_bits = static_cast<std::uint8_t>(value & input_mask);
+        auto const parity = detail::masked_parity<state_mask>(m_buffer)
+                          ^ (std::popcount(input_bits) & 1);
+        return static_cast<std::uint8_t>(parity << Bit);
+    }
 
+    /* Shifts a byte in at the top of the register, oldest bit first */
+    auto shift_in(std::uint8_t value) noexcept -> void
+    {
+        if constexpr (degree >= traits::char_bits) {
+            m_buffer >>= traits::char_bits;
+            m_buffer.deposit(degree - traits::char_bits, value);
+        } else {
+            m_buffer.words[0] = value >> (traits::char_bits - degree);
+        }
+    }
 
+    register_type m_buffer;
+};
 
 
 
+/* A Fibonacci LFSR that works out 64 bits at a time, for registers of up to
+   64 bits, such as 64b/66b's x^58 + x^39 + 1.
 
-template <std::size_t ... Taps>
-class feedthrough_fibonacci_bulk
+   The register is the last 64 scrambled bits, the most recent in bit 63.
+   Bit i of a word depends on the bit t before it, for each tap t: in the
+   register for i < t, and in the word itself otherwise. Descrambling only
+   depends on scrambled bits, which are all known, so it is a couple of
+   shifts per tap. Scrambling depends on its own output, which takes a few
+   more (see `scramble_step`). */
+template <typename Stats, std::size_t ... Taps>
+class basic_feedthrough_fibonacci_word
 {
 public:
-    using traits          = lfsr_bulk_traits<Taps...>;
-    using buffer_type     = typename traits::buffer_type;
-    using dependency_list = typename traits::dependency_list;
+    using traits     = lfsr_traits<Taps...>;
+    using stats_type = Stats;
 
     constexpr static auto degree = traits::degree;
-    constexpr static auto period = (1ull << degree) - 1;
+    constexpr static auto period = traits::period;
 
-    feedthrough_fibonacci_bulk()
-        : m_buffer{traits::all_ones()}
-        , m_deps_scramble{traits::scramble_dependencies()}
-        , m_deps_descramble{traits::descramble_dependencies()}
+    static_assert(degree <= 64, "the word engine needs a degree of at most 64");
+
+    constexpr basic_feedthrough_fibonacci_word() noexcept
+        : m_register{~std::uint64_t{}}
     {
     }
 
-    auto state() -> std::bitset<degree>
+    auto state() const -> std::bitset<degree>
     {
-        static_assert(degree <= 64, "Cant use state() with degree > 64, "
-                                    "state would overflow communicating type");
-        return (m_buffer & traits::state_mask()).to_ullong();
+        auto result = std::bitset<degree>{};
+        for (auto ii = 0ull; ii != degree; ++ii) {
+            result.set(ii, (m_register >> (63 - ii)) & 1);
+        }
+        return result;
     }
 
-    auto scramble_bit(bool value) -> bool
+    /* The state is the last `degree` scrambled bits, as from `state()` */
+    auto set_state(std::bitset<degree> const & state) noexcept -> void
     {
-        m_buffer.set(degree, value);
-        bool result = (m_buffer & m_deps_scramble[0]).count() & 1;
-        m_buffer.set(degree, result);
-        m_buffer >>= 1;
-        return result;
-    } 
+        for (auto ii = 0ull; ii != degree; ++ii) {
+            auto const bit = std::uint64_t{1} << (63 - ii);
+            m_register = state.test(ii) ? m_register | bit : m_register & ~bit;
+        }
+    }
 
-    auto scramble_byte(std::uint8_t value) -> std::uint8_t
+    /* Back to all ones, as constructed */
+    auto reset() noexcept -> void
     {
-        const static auto setmask = traits::state_mask();
-        m_buffer >>= 8;
-        m_buffer |= (buffer_type{value} << degree);
+        m_register = ~std::uint64_t{};
+    }
 
-        auto result = std::uint8_t{};
-        result |= ((m_buffer & m_deps_scramble[0]).count() & 1) << 0;
-        result |= ((m_buffer & m_deps_scramble[1]).count() & 1) << 1;
-        result |= ((m_buffer & m_deps_scramble[2]).count() & 1) << 2;
-        result |= ((m_buffer & m_deps_scramble[3]).count() & 1) << 3;
-        result |= ((m_buffer & m_deps_scramble[4]).count() & 1) << 4;
-        result |= ((m_buffer & m_deps_scramble[5]).count() & 1) << 5;
-        result |= ((m_buffer & m_deps_scramble[6]).count() & 1) << 6;
-        result |= ((m_buffer & m_deps_scramble[7]).count() & 1) << 7;
-
-        m_buffer = (m_buffer & setmask) | (buffer_type{result} << degree);
-        return result;
+    /* Reseeds with `seed` as the register, the last bits scrambled, bit i of
+       it being bit i of `state()`. Bits from the degree up are ignored. */
+    auto reset(std::uint64_t seed) noexcept -> void
+    {
+        set_state(std::bitset<degree>{seed});
     }
 
+    auto scramble_bit(bool value) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::bit, 1);
+        return scramble_step<1>(value) & 1;
+    }
 
+    auto descramble_bit(bool value) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::bit, 1);
+        return descramble_step<1>(value) & 1;
+    }
 
-    auto descramble_byte(std::uint8_t value) -> std::uint8_t
+    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
     {
-        m_buffer >>= 8;
-        m_buffer |= (buffer_type{value} << degree);
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::byte, 8);
+        return static_cast<std::uint8_t>(scramble_step<8>(value));
+    }
 
-        auto result = std::uint8_t{};
-        result |= ((m_buffer & m_deps_descramble[0]).count() & 1) << 0;
-        result |= ((m_buffer & m_deps_descramble[1]).count() & 1) << 1;
-        result |= ((m_buffer & m_deps_descramble[2]).count() & 1) << 2;
-        result |= ((m_buffer & m_deps_descramble[3]).count() & 1) << 3;
-        result |= ((m_buffer & m_deps_descramble[4]).count() & 1) << 4;
-        result |= ((m_buffer & m_deps_descramble[5]).count() & 1) << 5;
-        result |= ((m_buffer & m_deps_descramble[6]).count() & 1) << 6;
-        result |= ((m_buffer & m_deps_descramble[7]).count() & 1) << 7;
+    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::byte, 8);
+        return static_cast<std::uint8_t>(descramble_step<8>(value));
+    }
 
-        return result;
+    /* 64 bits, bit 0 first */
+    auto scramble_word(std::uint64_t value) noexcept -> std::uint64_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::word, 64);
+        return scramble_step<64>(value);
     }
 
-    auto descramble_bit(bool value) -> bool
+    auto descramble_word(std::uint64_t value) noexcept -> std::uint64_t
     {
-        m_buffer.set(degree, value);
-        bool result = (m_buffer & m_deps_descramble[0]).count() & 1;
-        m_buffer.set(degree, result);
-        m_buffer >>= 1;
-        return result;
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::word, 64);
+        return descramble_step<64>(value);
     }
 
 
@@ -439,9 +791,12 @@ public:
         requires detail::iter_is_byte<Iter1>
     auto scramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
     {
-        for (; first != last; ++first, ++d_first) {
-            *d_first = scramble_byte(*first);
-        }
+        auto stats = track(stats_direction::scramble, stats_call::range);
+        transform_range(first, last, d_first, stats, [this](auto v) {
+            return scramble_step<64>(v);
+        }, [this](auto v) {
+            return scramble_step<8>(v);
+        });
     }
 
 
@@ -449,18 +804,175 @@ public:
         requires detail::iter_is_byte<Iter1>
     auto descramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
     {
+        auto stats = track(stats_direction::descramble, stats_call::range);
+        transform_range(first, last, d_first, stats, [this](auto v) {
+            return descramble_step<64>(v);
+        }, [this](auto v) {
+            return descramble_step<8>(v);
+        });
+    }
+
+private:
+    static auto track(stats_direction dir, stats_call call,
+                      std::uint64_t bits = 0) noexcept
+        -> detail::stats_scope<Stats>
+    {
+        return {dir, call, stats_kernel::fibonacci_word, bits};
+    }
+
+    constexpr static auto mask(std::size_t bits) noexcept -> std::uint64_t
+    {
+        return bits == 64 ? ~std::uint64_t{} : (std::uint64_t{1} << bits) - 1;
+    }
+
+    /* Each bit of a word is XORed with the bit `t` before it, for each tap
+       t. These are the parts of that from the register, for bits i < t, and
+       from the word itself, which is `value` shifted up by each tap (times
+       `Scale`, for `scramble_step`). The taps are unrolled at compile time,
+       so that every shift is by a constant. */
+    static auto from_register(std::uint64_t reg) noexcept -> std::uint64_t
+    {
+        return [reg]<std::size_t ... Indices>(std::index_sequence<Indices...>) {
+            return (std::uint64_t{} ^ ... ^ (reg >> (64 - tap_at<Indices>)));
+        }(std::make_index_sequence<traits::tap_list::values.size()>{});
+    }
+
+    template <std::size_t Scale = 1>
+    static auto from_word(std::uint64_t value) noexcept -> std::uint64_t
+    {
+        return [value]<std::size_t ... Indices>(std::index_sequence<Indices...>) {
+            return (std::uint64_t{} ^ ... ^ shift_up<tap_at<Indices> * Scale>(value));
+        }(std::make_index_sequence<traits::tap_list::values.size()>{});
+    }
+
+    template <std::size_t Index>
+    constexpr static auto tap_at = traits::tap_list::values[Index];
+
+    template <std::size_t Shift>
+    static auto shift_up(std::uint64_t value) noexcept -> std::uint64_t
+    {
+        if constexpr (Shift < 64) {
+            return value << Shift;
+        } else {
+            return 0;
+        }
+    }
+
+    /* (1 + F)^-1, one pass per `Scale`; see `scramble_step` */
+    template <std::size_t Bits, std::size_t Scale = 1>
+    static auto unwind(std::uint64_t value) noexcept -> std::uint64_t
+    {
+        if constexpr (Scale * traits::lowest_tap < Bits) {
+            return unwind<Bits, Scale * 2>(value ^ from_word<Scale>(value));
+        } else {
+            return value;
+        }
+    }
+
+    /* Moves the first `Bits` of `value` into the register */
+    template <std::size_t Bits>
+    auto shift_in(std::uint64_t value) noexcept -> void
+    {
+        if constexpr (Bits == 64) {
+            m_register = value;
+        } else {
+            m_register = (m_register >> Bits) | (value << (64 - Bits));
+        }
+    }
+
+    template <std::size_t Bits>
+    auto scramble_step(std::uint64_t value) noexcept -> std::uint64_t
+    {
+        /* The word's own bits aren't known yet, so to start with only the
+           register's part of the feedback is: p = v ^ R. The word w then has
+           to satisfy w = p ^ F(w), where F XORs together w shifted up by each
+           tap, so w = (1 + F)^-1 p. F shifts up by at least the lowest tap,
+           so F^2^k is 0 once 2^k * lowest_tap >= Bits, and
+
+             (1 + F)^-1 = (1 + F)(1 + F^2)(1 + F^4)...
+
+           and, as everything is mod 2, F^2^k just shifts by each tap times
+           2^k. That's one pass for x^58 + x^39 + 1, and log2(64 / lowest)
+           passes in general. */
+        auto result = unwind<Bits>(value ^ from_register(m_register));
+        result &= mask(Bits);
+        shift_in<Bits>(result);
+        return result;
+    }
+
+    template <std::size_t Bits>
+    auto descramble_step(std::uint64_t value) noexcept -> std::uint64_t
+    {
+        value &= mask(Bits);
+        auto const result = (value ^ from_register(m_register)
+                ^ from_word(value)) & mask(Bits);
+        shift_in<Bits>(value);
+        return result;
+    }
+
+    /* A word at a time, loaded and stored little endian so that bit 0 of
+       the first byte is bit 0 of the word, and then a byte at a time. The
+       words are loaded and stored directly only where both sides are
+       contiguous bytes; otherwise they're put together a byte at a time. */
+    template <typename Iter1, typename Iter2, typename Word, typename Byte>
+    static auto transform_range(Iter1 & first, Iter1 last, Iter2 & d_first,
+                                detail::stats_scope<Stats> & stats,
+                                Word && word, Byte && byte) noexcept -> void
+    {
+        if constexpr (std::contiguous_iterator<Iter1>
+                && std::contiguous_iterator<Iter2>
+                && detail::iter_is_byte<Iter1> && detail::iter_is_byte<Iter2>)
+        {
+            for (; last - first >= 8; first += 8, d_first += 8) {
+                detail::store_le64(std::to_address(d_first),
+                        word(detail::load_le64(std::to_address(first))));
+                stats.add_bits(64);
+            }
+        }
+        else if constexpr (std::random_access_iterator<Iter1>)
+        {
+            for (; last - first >= 8; first += 8)
+            {
+                auto value = std::uint64_t{};
+                for (auto ii = 0u; ii != 8; ++ii) {
+                    value |= std::uint64_t{static_cast<std::uint8_t>(
+                            first[ii])} << (8 * ii);
+                }
+                auto const result = word(value);
+                for (auto ii = 0u; ii != 8; ++ii, ++d_first) {
+                    *d_first = static_cast<std::uint8_t>(result >> (8 * ii));
+                }
+                stats.add_bits(64);
+            }
+        }
         for (; first != last; ++first, ++d_first) {
-            *d_first = descramble_byte(*first);
+            *d_first = static_cast<std::uint8_t>(byte(
+                    static_cast<std::uint8_t>(*first)));
+            stats.add_bits(8);
         }
     }
 
-private:
-    buffer_type     m_buffer;
-    dependency_list m_deps_descramble;
-    dependency_list m_deps_scramble;
+    std::uint64_t m_register;
 };
 
 
 
+template <std::size_t ... Taps>
+using feedthrough_fibonacci = basic_feedthrough_fibonacci<no_stats, Taps...>;
+
+template <std::size_t ... Taps>
+using feedthrough_galois = basic_feedthrough_galois<no_stats, Taps...>;
+
+template <std::size_t ... Taps>
+using feedthrough_fibonacci_bulk
+        = basic_feedthrough_fibonacci_bulk<no_stats, Taps...>;
+
+template <std::size_t ... Taps>
+using feedthrough_fibonacci_word
+        = basic_feedthrough_fibonacci_word<no_stats, Taps...>;
+
+
+
+
 
 } // namespace lfsr
\ No newline at end of file
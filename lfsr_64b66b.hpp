@@ -0,0 +1,324 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <lfsr.hpp>
+
+namespace lfsr {
+
+
+/* 64b/66b line coding, as in IEEE 802.3 clause 49.
+
+   Each 66 bit block is a 2 bit sync header, which is never scrambled,
+   followed by a 64 bit payload scrambled by the self-synchronising
+   x^58 + x^39 + 1, continuously from one block's payload to the next. The
+   payloads go through `feedthrough_fibonacci_word`, a word per block.
+
+   Bits are sent bit 0 first throughout, so the data header, written "01" in
+   the standard (a 0 and then a 1), is 0b10 here. */
+
+struct block_66
+{
+    std::uint8_t  header;
+    std::uint64_t payload;
+
+    friend auto operator==(block_66 const &, block_66 const &) -> bool = default;
+};
+
+constexpr auto sync_data    = std::uint8_t{0b10};
+constexpr auto sync_control = std::uint8_t{0b01};
+
+constexpr auto is_valid_sync(std::uint8_t header) noexcept -> bool
+{
+    return header == sync_data || header == sync_control;
+}
+
+
+/* Bytes taken by `blocks` packed blocks. Packed, the blocks follow one
+   another with no gaps, bit 0 of the first in bit 0 of the first byte, and
+   the last byte is padded with zeroes. Four blocks take exactly 33 bytes. */
+constexpr auto packed_size_66(std::size_t blocks) noexcept -> std::size_t
+{
+    return (blocks * 66 + 7) / 8;
+}
+
+
+
+/* The receiver's block lock state machine (figure 49-14). Lock is gained
+   after 64 valid sync headers in a row, and lost once 16 of any 64 are
+   invalid. Until then, each invalid header asks for a slip: for the
+   receiver to try the next bit as the start of a block. */
+class block_lock
+{
+public:
+    /* Takes the next sync header, returning whether to slip */
+    constexpr auto observe(std::uint8_t header) noexcept -> bool
+    {
+        if (is_valid_sync(header)) [[likely]]
+        {
+            if (++m_count == 64) {
+                m_locked = m_locked || m_invalid == 0;
+                restart();
+            }
+            return false;
+        }
+
+        ++m_invalid;
+        ++m_invalid_total;
+        if (m_invalid == 16 || !m_locked) {
+            m_locked = false;
+            ++m_slips;
+            restart();
+            return true;
+        }
+        if (++m_count == 64) {
+            restart();
+        }
+        return false;
+    }
+
+    constexpr auto locked() const noexcept -> bool
+    {
+        return m_locked;
+    }
+
+    /* Slips asked for, and invalid headers seen, since construction */
+    constexpr auto slips() const noexcept -> std::uint64_t
+    {
+        return m_slips;
+    }
+
+    constexpr auto invalid_headers() const noexcept -> std::uint64_t
+    {
+        return m_invalid_total;
+    }
+
+private:
+    constexpr auto restart() noexcept -> void
+    {
+        m_count = 0;
+        m_invalid = 0;
+    }
+
+    bool          m_locked = false;
+    std::uint32_t m_count = 0;
+    std::uint32_t m_invalid = 0;
+    std::uint64_t m_slips = 0;
+    std::uint64_t m_invalid_total = 0;
+};
+
+
+
+namespace detail {
+
+/* Block `index` of a packed buffer. Blocks start on an even bit, so the
+   header never crosses a byte. */
+inline auto read_block_66(std::uint8_t const * packed, std::size_t index)
+    noexcept -> block_66
+{
+    auto const bit = index * 66;
+    auto const header = (packed[bit / 8] >> (bit % 8)) & 3;
+
+    auto const first = (bit + 2) / 8;
+    auto const shift = (bit + 2) % 8;
+    auto payload = load_le64(packed + first) >> shift;
+    if (shift != 0) {
+        payload |= std::uint64_t{packed[first + 8]} << (64 - shift);
+    }
+    return {static_cast<std::uint8_t>(header), payload};
+}
+
+
+/* Writes packed blocks in order, a word at a time */
+class packed_writer_66
+{
+public:
+    explicit packed_writer_66(std::uint8_t * out) noexcept
+        : m_out{out}
+    {
+    }
+
+    auto write(block_66 const & block) noexcept -> void
+    {
+        put(block.header & 3u, 2);
+        put(block.payload, 64);
+    }
+
+    /* Writes out what's left, padded to a byte */
+    auto flush() noexcept -> void
+    {
+        for (auto ii = 0u; ii < m_fill; ii += 8) {
+            *m_out++ = static_cast<std::uint8_t>(m_pending >> ii);
+        }
+        m_pending = 0;
+        m_fill = 0;
+    }
+
+private:
+    auto put(std::uint64_t value, unsigned bits) noexcept -> void
+    {
+        m_pending |= value << m_fill;
+        if (m_fill + bits < 64) {
+            m_fill += bits;
+            return;
+        }
+        store_le64(m_out, m_pending);
+        m_out += 8;
+        m_pending = m_fill == 0 ? 0 : value >> (64 - m_fill);
+        m_fill = m_fill + bits - 64;
+    }
+
+    std::uint8_t * m_out;
+    std::uint64_t  m_pending = 0;
+    unsigned       m_fill = 0;
+};
+
+
+/* Passes each packed block through `func`, into `out`, which may be `in`.
+   Four blocks at a time are exactly 33 bytes, four words and a byte, in
+   which every field is at a fixed shift; any left over go through
+   `read_block_66` and `packed_writer_66`. */
+template <typename Func>
+auto transform_packed_66(std::uint8_t const * in, std::size_t blocks,
+                         std::uint8_t * out, Func && func) noexcept -> void
+{
+    for (; blocks >= 4; blocks -= 4, in += 33, out += 33)
+    {
+        auto const w0 = load_le64(in);
+        auto const w1 = load_le64(in + 8);
+        auto const w2 = load_le64(in + 16);
+        auto const w3 = load_le64(in + 24);
+        auto const w4 = std::uint64_t{in[32]};
+
+        auto const b0 = func(block_66{static_cast<std::uint8_t>(w0 & 3),
+                (w0 >> 2) | (w1 << 62)});
+        auto const b1 = func(block_66{static_cast<std::uint8_t>((w1 >> 2) & 3),
+                (w1 >> 4) | (w2 << 60)});
+        auto const b2 = func(block_66{static_cast<std::uint8_t>((w2 >> 4) & 3),
+                (w2 >> 6) | (w3 << 58)});
+        auto const b3 = func(block_66{static_cast<std::uint8_t>((w3 >> 6) & 3),
+                (w3 >> 8) | (w4 << 56)});
+
+        store_le64(out, (b0.header & 3u) | (b0.payload << 2));
+        store_le64(out + 8, (b0.payload >> 62) | std::uint64_t{b1.header & 3u} << 2
+                | (b1.payload << 4));
+        store_le64(out + 16, (b1.payload >> 60) | std::uint64_t{b2.header & 3u} << 4
+                | (b2.payload << 6));
+        store_le64(out + 24, (b2.payload >> 58) | std::uint64_t{b3.header & 3u} << 6
+                | (b3.payload << 8));
+        out[32] = static_cast<std::uint8_t>(b3.payload >> 56);
+    }
+
+    auto writer = packed_writer_66{out};
+    for (auto ii = std::size_t{}; ii != blocks; ++ii) {
+        writer.write(func(read_block_66(in, ii)));
+    }
+    writer.flush();
+}
+
+}
+
+
+
+/* Scrambles blocks to send and descrambles those received, each direction
+   with its own scrambler, and keeps track of block lock on the way in.
+
+   Blocks are either `block_66`s, or packed into bytes (see
+   `packed_size_66`). A stream of `block_66`s can be split across calls at
+   any block; a packed one only where a block starts on a byte, every fourth
+   block. */
+template <typename Stats = no_stats>
+class basic_codec_64b66b
+{
+public:
+    using scrambler_type = basic_feedthrough_fibonacci_word<Stats, 0, 39, 58>;
+
+    /* Each works on local copies of the scrambler and lock, which would
+       otherwise have to be reloaded after every store through a byte
+       pointer, as it might have changed them */
+
+    template <typename Iter1, typename Iter2>
+    auto scramble(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
+    {
+        auto scrambler = m_scrambler;
+        for (; first != last; ++first, ++d_first) {
+            block_66 const block = *first;
+            *d_first = block_66{block.header,
+                    scrambler.scramble_word(block.payload)};
+        }
+        m_scrambler = scrambler;
+    }
+
+    template <typename Iter1, typename Iter2>
+    auto descramble(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
+    {
+        auto descrambler = m_descrambler;
+        auto lock = m_lock;
+        for (; first != last; ++first, ++d_first) {
+            block_66 const block = *first;
+            lock.observe(block.header);
+            *d_first = block_66{block.header,
+                    descrambler.descramble_word(block.payload)};
+        }
+        m_descrambler = descrambler;
+        m_lock = lock;
+    }
+
+    /* `blocks` blocks from `in` into `out`, both `packed_size_66(blocks)`
+       bytes, which may be the same buffer */
+    auto scramble_packed(std::uint8_t const * in, std::size_t blocks,
+                         std::uint8_t * out) noexcept -> void
+    {
+        auto scrambler = m_scrambler;
+        detail::transform_packed_66(in, blocks, out, [&](block_66 block) {
+            return block_66{block.header,
+                    scrambler.scramble_word(block.payload)};
+        });
+        m_scrambler = scrambler;
+    }
+
+    auto descramble_packed(std::uint8_t const * in, std::size_t blocks,
+                           std::uint8_t * out) noexcept -> void
+    {
+        auto descrambler = m_descrambler;
+        auto lock = m_lock;
+        detail::transform_packed_66(in, blocks, out, [&](block_66 block) {
+            lock.observe(block.header);
+            return block_66{block.header,
+                    descrambler.descramble_word(block.payload)};
+        });
+        m_descrambler = descrambler;
+        m_lock = lock;
+    }
+
+    auto lock() const noexcept -> block_lock const &
+    {
+        return m_lock;
+    }
+
+    auto locked() const noexcept -> bool
+    {
+        return m_lock.locked();
+    }
+
+    auto scrambler() noexcept -> scrambler_type &
+    {
+        return m_scrambler;
+    }
+
+    auto descrambler() noexcept -> scrambler_type &
+    {
+        return m_descrambler;
+    }
+
+private:
+    scrambler_type m_scrambler;
+    scrambler_type m_descrambler;
+    block_lock     m_lock;
+};
+
+using codec_64b66b = basic_codec_64b66b<>;
+
+
+}
@@ -0,0 +1,866 @@
+#include <lfsr_c.h>
+
+#include <lfsr.hpp>
+#include <lfsr_dispatch.hpp>
+#include <lfsr_gold.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/* The handle is the base of a class per engine type, all of which are
+   compiled in here, once, for the prebuilt tap lists, and of one each for
+   Fibonacci and Galois engines with taps given at runtime */
+struct lfsr_handle
+{
+    virtual ~lfsr_handle() = default;
+
+    virtual auto clone() const -> std::unique_ptr<lfsr_handle> = 0;
+    virtual auto scramble(std::uint8_t const * in, std::uint8_t * out,
+                          std::size_t len) noexcept -> void = 0;
+    virtual auto descramble(std::uint8_t const * in, std::uint8_t * out,
+                            std::size_t len) noexcept -> void = 0;
+    virtual auto advance(std::uint64_t bits) -> void = 0;
+    virtual auto degree() const noexcept -> std::size_t = 0;
+    virtual auto get_state(std::uint8_t * state) const -> void = 0;
+    virtual auto set_state(std::uint8_t const * state) -> void = 0;
+};
+
+
+namespace {
+
+thread_local auto last_error = std::string{};
+
+
+template <typename LFSR>
+struct is_galois : std::false_type {};
+
+template <typename Stats, std::size_t ... Taps>
+struct is_galois<lfsr::basic_feedthrough_galois<Stats, Taps...>>
+    : std::true_type {};
+
+
+/* Bits in as many words as they take, bit i in bit i % 64 of word i / 64 */
+using bit_words = std::vector<std::uint64_t>;
+
+auto test_bit(bit_words const & words, std::size_t ii) noexcept -> bool
+{
+    return (words[ii / 64] >> (ii % 64)) & 1;
+}
+
+auto set_bit(bit_words & words, std::size_t ii, bool value) noexcept -> void
+{
+    auto const bit = std::uint64_t{1} << (ii % 64);
+    words[ii / 64] = value ? words[ii / 64] | bit : words[ii / 64] & ~bit;
+}
+
+
+/* Arithmetic modulo the characteristic polynomial of a free running
+   register, x^degree = the sum of x^(degree - t) for each tap t, as in
+   `lfsr::detail::jump`, but of any degree. It's a bit at a time, so a
+   multiplication is degree^2 / 64 word operations, and a jump of up to 2^64
+   bits is 128 of them. */
+class characteristic_modulus
+{
+public:
+    characteristic_modulus(std::span<std::size_t const> taps,
+                           std::size_t degree)
+        : m_degree{degree}
+        , m_low((degree + 63) / 64)
+    {
+        for (auto tap : taps) {
+            set_bit(m_low, degree - tap, true);
+        }
+    }
+
+    auto degree() const noexcept -> std::size_t
+    {
+        return m_degree;
+    }
+
+    auto words() const noexcept -> std::size_t
+    {
+        return m_low.size();
+    }
+
+    auto times_x(bit_words & a) const noexcept -> void
+    {
+        auto carry = std::uint64_t{};
+        for (auto & word : a) {
+            auto const next = word >> 63;
+            word = (word << 1) | carry;
+            carry = next;
+        }
+
+        /* x^degree, if there is one now, is the sum of the lower terms */
+        auto top = carry;
+        if (m_degree % 64 != 0)
+        {
+            auto & word = a[m_degree / 64];
+            top = (word >> (m_degree % 64)) & 1;
+            word &= ~(std::uint64_t{1} << (m_degree % 64));
+        }
+        if (top != 0) {
+            for (auto ii = std::size_t{}; ii != a.size(); ++ii) {
+                a[ii] ^= m_low[ii];
+            }
+        }
+    }
+
+    auto multiply(bit_words const & a, bit_words const & b) const -> bit_words
+    {
+        auto result = bit_words(words());
+        for (auto ii = m_degree; ii-- != 0;)
+        {
+            times_x(result);
+            if (test_bit(b, ii)) {
+                for (auto jj = std::size_t{}; jj != result.size(); ++jj) {
+                    result[jj] ^= a[jj];
+                }
+            }
+        }
+        return result;
+    }
+
+    /* x^exponent */
+    auto pow_x(std::uint64_t exponent) const -> bit_words
+    {
+        auto result = bit_words(words());
+        set_bit(result, 0, true);
+        auto base = result;
+        times_x(base);
+        for (; exponent != 0; exponent >>= 1) {
+            if (exponent & 1) {
+                result = multiply(result, base);
+            }
+            base = multiply(base, base);
+        }
+        return result;
+    }
+
+private:
+    std::size_t m_degree;
+    bit_words   m_low;
+};
+
+
+/* Moves a history, the last `degree` bits out with bit 0 the most recent, on
+   as if `steps` zero bits had been scrambled, as `lfsr::detail::jump` does:
+   the bit `steps + m` on from the oldest is the sum of the bits of the
+   history that x^(steps + m) has terms for */
+auto jump(bit_words & history, characteristic_modulus const & modulus,
+          std::uint64_t steps) -> void
+{
+    auto const degree = modulus.degree();
+    auto window = bit_words(modulus.words());
+    for (auto ii = std::size_t{}; ii != degree; ++ii) {
+        set_bit(window, ii, test_bit(history, degree - 1 - ii));
+    }
+
+    auto power = modulus.pow_x(steps);
+    auto result = bit_words(modulus.words());
+    for (auto m = std::size_t{}; m != degree; ++m)
+    {
+        auto parity = 0;
+        for (auto ii = std::size_t{}; ii != power.size(); ++ii) {
+            parity ^= std::popcount(power[ii] & window[ii]) & 1;
+        }
+        set_bit(result, degree - 1 - m, parity != 0);
+        modulus.times_x(power);
+    }
+    history = std::move(result);
+}
+
+
+/* The Galois register isn't the history, but the history decides it, as it
+   does for every engine here. So the history `degree` bits on is what a copy
+   scrambles from zeroes; that's jumped the rest of the way, and descrambled,
+   oldest bit first, to put the register where it would be after it. */
+template <typename LFSR>
+auto advance_galois(LFSR & lfsr, characteristic_modulus const & modulus,
+                    std::uint64_t bits) -> void
+{
+    auto const degree = modulus.degree();
+    if (bits < degree)
+    {
+        for (; bits != 0; --bits) {
+            lfsr.scramble_bit(false);
+        }
+        return;
+    }
+
+    auto ahead = lfsr;
+    auto history = bit_words(modulus.words());
+    for (auto ii = degree; ii-- != 0;) {
+        set_bit(history, ii, ahead.scramble_bit(false));
+    }
+    jump(history, modulus, bits - degree);
+    for (auto ii = degree; ii-- != 0;) {
+        lfsr.descramble_bit(test_bit(history, ii));
+    }
+}
+
+
+template <typename LFSR>
+class engine_handle final : public lfsr_handle
+{
+public:
+    explicit engine_handle(LFSR const & engine)
+        : m_engine{engine}
+        , m_modulus{LFSR::traits::tap_list::values, LFSR::degree}
+    {
+    }
+
+    auto clone() const -> std::unique_ptr<lfsr_handle> override
+    {
+        return std::make_unique<engine_handle>(m_engine);
+    }
+
+    auto scramble(std::uint8_t const * in, std::uint8_t * out,
+                  std::size_t len) noexcept -> void override
+    {
+        m_engine.scramble_range(in, in + len, out);
+    }
+
+    auto descramble(std::uint8_t const * in, std::uint8_t * out,
+                    std::size_t len) noexcept -> void override
+    {
+        m_engine.descramble_range(in, in + len, out);
+    }
+
+    /* Jumps, with the word arithmetic where the state is the history and
+       fits it, and otherwise with the arithmetic in as many words as the
+       degree takes */
+    auto advance(std::uint64_t bits) -> void override
+    {
+        if constexpr (is_galois<LFSR>::value) {
+            advance_galois(m_engine, m_modulus, bits);
+        }
+        else if constexpr (LFSR::degree <= 64) {
+            lfsr::detail::jump(m_engine, bits);
+        }
+        else
+        {
+            auto const state = m_engine.state();
+            auto history = bit_words(m_modulus.words());
+            for (auto ii = std::size_t{}; ii != LFSR::degree; ++ii) {
+                set_bit(history, ii, state.test(ii));
+            }
+            jump(history, m_modulus, bits);
+            auto result = std::bitset<LFSR::degree>{};
+            for (auto ii = std::size_t{}; ii != LFSR::degree; ++ii) {
+                result.set(ii, test_bit(history, ii));
+            }
+            m_engine.set_state(result);
+        }
+    }
+
+    auto degree() const noexcept -> std::size_t override
+    {
+        return LFSR::degree;
+    }
+
+    auto get_state(std::uint8_t * state) const -> void override
+    {
+        auto const bits = m_engine.state();
+        for (auto ii = std::size_t{}; ii != LFSR::degree; ++ii) {
+            if (ii % 8 == 0) {
+                state[ii / 8] = 0;
+            }
+            state[ii / 8] |= static_cast<std::uint8_t>(bits.test(ii) << (ii % 8));
+        }
+    }
+
+    auto set_state(std::uint8_t const * state) -> void override
+    {
+        auto bits = std::bitset<LFSR::degree>{};
+        for (auto ii = std::size_t{}; ii != LFSR::degree; ++ii) {
+            bits.set(ii, (state[ii / 8] >> (ii % 8)) & 1);
+        }
+        m_engine.set_state(bits);
+    }
+
+private:
+    LFSR                   m_engine;
+    characteristic_modulus m_modulus;
+};
+
+
+
+/* The largest degree taken for taps with no prebuilt kernel, which bounds
+   the register and the cost of a jump */
+constexpr auto max_runtime_degree = std::size_t{4096};
+
+
+/* The Fibonacci engines for taps with no prebuilt kernel, given at runtime.
+   It's the word engine's algorithm (see `basic_feedthrough_fibonacci_word`),
+   64 bits a step whatever the degree, with the taps in a loop rather than
+   unrolled, and a register of as many words as the degree takes. The state
+   is the last `degree` scrambled bits, as for the other Fibonacci engines. */
+class runtime_fibonacci
+{
+public:
+    constexpr static bool is_galois = false;
+
+    /* `taps` normalised, and not empty */
+    explicit runtime_fibonacci(std::vector<std::size_t> taps)
+        : m_taps{std::move(taps)}
+        , m_register((m_taps.back() + 63) / 64 + 1, ~std::uint64_t{})
+    {
+        m_register.back() = 0;
+    }
+
+    auto degree() const noexcept -> std::size_t
+    {
+        return m_taps.back();
+    }
+
+    auto taps() const noexcept -> std::span<std::size_t const>
+    {
+        return m_taps;
+    }
+
+    auto state_bit(std::size_t ii) const noexcept -> bool
+    {
+        return test_bit(m_register, top() - 1 - ii);
+    }
+
+    auto set_state_bit(std::size_t ii, bool value) noexcept -> void
+    {
+        set_bit(m_register, top() - 1 - ii, value);
+    }
+
+    auto scramble_range(std::uint8_t const * first, std::uint8_t const * last,
+                        std::uint8_t * d_first) noexcept -> void
+    {
+        transform_range(first, last, d_first, [this](auto v, auto bits) {
+            return scramble_step(v, bits);
+        });
+    }
+
+    auto descramble_range(std::uint8_t const * first, std::uint8_t const * last,
+                          std::uint8_t * d_first) noexcept -> void
+    {
+        transform_range(first, last, d_first, [this](auto v, auto bits) {
+            return descramble_step(v, bits);
+        });
+    }
+
+private:
+    constexpr static auto mask(std::size_t bits) noexcept -> std::uint64_t
+    {
+        return bits == 64 ? ~std::uint64_t{} : (std::uint64_t{1} << bits) - 1;
+    }
+
+    /* The register is the history with the most recent bit at the top of
+       the last word but one; the last word is zero, so that the bits t back
+       can be read as one word for every tap t */
+    auto top() const noexcept -> std::size_t
+    {
+        return 64 * (m_register.size() - 1);
+    }
+
+    auto from_register() const noexcept -> std::uint64_t
+    {
+        auto result = std::uint64_t{};
+        for (auto tap : m_taps)
+        {
+            auto const first = top() - tap;
+            auto const word = first / 64;
+            auto const shift = first % 64;
+            result ^= shift == 0 ? m_register[word]
+                    : (m_register[word] >> shift)
+                            | (m_register[word + 1] << (64 - shift));
+        }
+        return result;
+    }
+
+    auto from_word(std::uint64_t value, std::size_t scale = 1) const noexcept
+        -> std::uint64_t
+    {
+        auto result = std::uint64_t{};
+        for (auto tap : m_taps) {
+            if (tap * scale < 64) {
+                result ^= value << (tap * scale);
+            }
+        }
+        return result;
+    }
+
+    auto unwind(std::uint64_t value, std::size_t bits) const noexcept
+        -> std::uint64_t
+    {
+        for (auto scale = std::size_t{1}; m_taps.front() * scale < bits;
+                scale *= 2) {
+            value ^= from_word(value, scale);
+        }
+        return value;
+    }
+
+    auto shift_in(std::uint64_t value, std::size_t bits) noexcept -> void
+    {
+        auto const last = m_register.size() - 1;
+        if (bits == 64)
+        {
+            std::copy(m_register.begin() + 1, m_register.begin() + last,
+                    m_register.begin());
+            m_register[last - 1] = value;
+            return;
+        }
+        for (auto ii = std::size_t{}; ii != last; ++ii) {
+            auto const next = ii + 1 == last ? value : m_register[ii + 1];
+            m_register[ii] = (m_register[ii] >> bits) | (next << (64 - bits));
+        }
+    }
+
+    auto scramble_step(std::uint64_t value, std::size_t bits) noexcept
+        -> std::uint64_t
+    {
+        auto const result = unwind(value ^ from_register(), bits) & mask(bits);
+        shift_in(result, bits);
+        return result;
+    }
+
+    auto descramble_step(std::uint64_t value, std::size_t bits) noexcept
+        -> std::uint64_t
+    {
+        value &= mask(bits);
+        auto const result = (value ^ from_register() ^ from_word(value))
+                & mask(bits);
+        shift_in(value, bits);
+        return result;
+    }
+
+    template <typename Step>
+    static auto transform_range(std::uint8_t const * first,
+                                std::uint8_t const * last,
+                                std::uint8_t * d_first, Step && step) noexcept
+        -> void
+    {
+        for (; last - first >= 8; first += 8, d_first += 8) {
+            lfsr::detail::store_le64(d_first,
+                    step(lfsr::detail::load_le64(first), 64));
+        }
+        for (; first != last; ++first, ++d_first) {
+            *d_first = static_cast<std::uint8_t>(step(*first, 8));
+        }
+    }
+
+    std::vector<std::size_t> m_taps;
+    bit_words                m_register;
+};
+
+
+/* The Galois engine for taps with no prebuilt kernel: that of
+   `basic_feedthrough_galois`, a bit at a time, with the tap mask built when
+   it's created */
+class runtime_galois
+{
+public:
+    constexpr static bool is_galois = true;
+
+    /* `taps` normalised, and not empty */
+    explicit runtime_galois(std::vector<std::size_t> taps)
+        : m_taps{std::move(taps)}
+        , m_register((degree() + 63) / 64)
+        , m_mask(m_register.size())
+    {
+        for (auto ii = std::size_t{}; ii != degree(); ++ii) {
+            set_bit(m_register, ii, true);
+        }
+        for (auto tap : m_taps) {
+            set_bit(m_mask, tap - 1, true);
+        }
+    }
+
+    auto degree() const noexcept -> std::size_t
+    {
+        return m_taps.back();
+    }
+
+    auto taps() const noexcept -> std::span<std::size_t const>
+    {
+        return m_taps;
+    }
+
+    auto state_bit(std::size_t ii) const noexcept -> bool
+    {
+        return test_bit(m_register, ii);
+    }
+
+    auto set_state_bit(std::size_t ii, bool value) noexcept -> void
+    {
+        set_bit(m_register, ii, value);
+    }
+
+    auto scramble_bit(bool input) noexcept -> bool
+    {
+        return step(input, true);
+    }
+
+    auto descramble_bit(bool input) noexcept -> bool
+    {
+        return step(input, false);
+    }
+
+    auto scramble_range(std::uint8_t const * first, std::uint8_t const * last,
+                        std::uint8_t * d_first) noexcept -> void
+    {
+        transform_range(first, last, d_first, true);
+    }
+
+    auto descramble_range(std::uint8_t const * first, std::uint8_t const * last,
+                          std::uint8_t * d_first) noexcept -> void
+    {
+        transform_range(first, last, d_first, false);
+    }
+
+private:
+    /* The feedback is the output when scrambling, and the input when
+       descrambling */
+    auto step(bool input, bool scramble) noexcept -> bool
+    {
+        auto const out = static_cast<bool>(m_register[0] & 1) != input;
+        auto const feedback = scramble ? out : input;
+        for (auto ii = std::size_t{}; ii != m_register.size(); ++ii) {
+            auto const next = ii + 1 == m_register.size()
+                    ? std::uint64_t{} : m_register[ii + 1];
+            m_register[ii] = (m_register[ii] >> 1) | (next << 63);
+        }
+        if (feedback) {
+            for (auto ii = std::size_t{}; ii != m_register.size(); ++ii) {
+                m_register[ii] ^= m_mask[ii];
+            }
+        }
+        set_bit(m_register, degree() - 1, feedback);
+        return out;
+    }
+
+    auto transform_range(std::uint8_t const * first, std::uint8_t const * last,
+                         std::uint8_t * d_first, bool scramble) noexcept -> void
+    {
+        for (; first != last; ++first, ++d_first)
+        {
+            auto value = *first;
+            auto result = std::uint8_t{};
+            for (auto ii = 0u; ii != 8; ++ii, value >>= 1) {
+                result |= static_cast<std::uint8_t>(
+                        step(value & 1, scramble) << ii);
+            }
+            *d_first = result;
+        }
+    }
+
+    std::vector<std::size_t> m_taps;
+    bit_words                m_register;
+    bit_words                m_mask;
+};
+
+
+template <typename Engine>
+class runtime_handle final : public lfsr_handle
+{
+public:
+    explicit runtime_handle(Engine engine)
+        : m_engine{std::move(engine)}
+        , m_modulus{m_engine.taps(), m_engine.degree()}
+    {
+    }
+
+    auto clone() const -> std::unique_ptr<lfsr_handle> override
+    {
+        return std::make_unique<runtime_handle>(*this);
+    }
+
+    auto scramble(std::uint8_t const * in, std::uint8_t * out,
+                  std::size_t len) noexcept -> void override
+    {
+        m_engine.scramble_range(in, in + len, out);
+    }
+
+    auto descramble(std::uint8_t const * in, std::uint8_t * out,
+                    std::size_t len) noexcept -> void override
+    {
+        m_engine.descramble_range(in, in + len, out);
+    }
+
+    auto advance(std::uint64_t bits) -> void override
+    {
+        if constexpr (Engine::is_galois) {
+            advance_galois(m_engine, m_modulus, bits);
+        }
+        else
+        {
+            auto history = bit_words(m_modulus.words());
+            for (auto ii = std::size_t{}; ii != degree(); ++ii) {
+                set_bit(history, ii, m_engine.state_bit(ii));
+            }
+            jump(history, m_modulus, bits);
+            for (auto ii = std::size_t{}; ii != degree(); ++ii) {
+                m_engine.set_state_bit(ii, test_bit(history, ii));
+            }
+        }
+    }
+
+    auto degree() const noexcept -> std::size_t override
+    {
+        return m_engine.degree();
+    }
+
+    auto get_state(std::uint8_t * state) const -> void override
+    {
+        for (auto ii = std::size_t{}; ii != degree(); ++ii) {
+            if (ii % 8 == 0) {
+                state[ii / 8] = 0;
+            }
+            state[ii / 8] |= static_cast<std::uint8_t>(
+                    m_engine.state_bit(ii) << (ii % 8));
+        }
+    }
+
+    auto set_state(std::uint8_t const * state) -> void override
+    {
+        for (auto ii = std::size_t{}; ii != degree(); ++ii) {
+            m_engine.set_state_bit(ii, (state[ii / 8] >> (ii % 8)) & 1);
+        }
+    }
+
+private:
+    Engine                 m_engine;
+    characteristic_modulus m_modulus;
+};
+
+
+/* A handle for taps with no prebuilt kernel. Every Fibonacci kind gives the
+   same output, so they share an engine. */
+auto make_runtime_handle(std::span<std::size_t const> taps,
+                         lfsr::engine_kind kind)
+    -> std::unique_ptr<lfsr_handle>
+{
+    auto list = lfsr::detail::normalise_taps(taps);
+    if (list.empty()) {
+        throw std::invalid_argument("no taps other than 0");
+    }
+    if (list.back() > max_runtime_degree) {
+        throw std::invalid_argument(std::format("taps with no prebuilt kernel "
+                "need a degree of at most {}", max_runtime_degree));
+    }
+    if (list.back() > lfsr::max_degree(kind)) {
+        throw std::invalid_argument(std::format("the {} engine needs a degree "
+                "of at most {}", lfsr::to_string(kind), lfsr::max_degree(kind)));
+    }
+
+    if (kind == lfsr::engine_kind::galois) {
+        return std::make_unique<runtime_handle<runtime_galois>>(
+                runtime_galois{std::move(list)});
+    }
+    return std::make_unique<runtime_handle<runtime_fibonacci>>(
+            runtime_fibonacci{std::move(list)});
+}
+
+
+auto to_engine_kind(lfsr_kind kind, std::span<std::size_t const> taps)
+    -> lfsr::engine_kind
+{
+    switch (kind)
+    {
+        case LFSR_KIND_AUTO: {
+            auto highest = std::size_t{};
+            for (auto tap : taps) {
+                highest = tap > highest ? tap : highest;
+            }
+            return highest <= lfsr::max_degree(lfsr::engine_kind::fibonacci_word)
+                    ? lfsr::engine_kind::fibonacci_word
+                    : lfsr::engine_kind::fibonacci_bulk;
+        }
+        case LFSR_KIND_FIBONACCI:      return lfsr::engine_kind::fibonacci;
+        case LFSR_KIND_GALOIS:         return lfsr::engine_kind::galois;
+        case LFSR_KIND_FIBONACCI_BULK: return lfsr::engine_kind::fibonacci_bulk;
+        case LFSR_KIND_FIBONACCI_WORD: return lfsr::engine_kind::fibonacci_word;
+    }
+    throw std::invalid_argument(std::format(
+            "unknown engine kind {}", static_cast<int>(kind)));
+}
+
+
+auto state_size(lfsr_handle const & handle) noexcept -> std::size_t
+{
+    return (handle.degree() + 7) / 8;
+}
+
+
+/* Runs `func`, turning exceptions into a status and a message */
+template <typename Func>
+auto guard(Func && func) noexcept -> lfsr_status
+{
+    try
+    {
+        last_error.clear();
+        func();
+        return LFSR_OK;
+    }
+    catch (std::bad_alloc const &)
+    {
+        last_error = "out of memory";
+        return LFSR_OUT_OF_MEMORY;
+    }
+    catch (std::invalid_argument const & e)
+    {
+        last_error = e.what();
+        return LFSR_INVALID_ARGUMENT;
+    }
+    catch (std::exception const & e)
+    {
+        last_error = e.what();
+        return LFSR_INTERNAL_ERROR;
+    }
+    catch (...)
+    {
+        last_error = "unknown error";
+        return LFSR_INTERNAL_ERROR;
+    }
+}
+
+
+auto require(bool condition, char const * message) -> void
+{
+    if (!condition) {
+        throw std::invalid_argument(message);
+    }
+}
+
+}
+
+
+
+extern "C" {
+
+uint32_t lfsr_abi_version(void)
+{
+    return LFSR_C_ABI_VERSION;
+}
+
+
+char const * lfsr_last_error(void)
+{
+    return last_error.c_str();
+}
+
+
+lfsr_handle * lfsr_create(size_t const * taps, size_t ntaps, lfsr_kind kind)
+{
+    auto result = std::unique_ptr<lfsr_handle>{};
+    guard([&] {
+        require(taps != nullptr || ntaps == 0, "taps is null");
+        auto const list = std::span<std::size_t const>{taps, ntaps};
+        auto const engine_kind = to_engine_kind(kind, list);
+        if (!lfsr::is_prebuilt(list)) {
+            result = make_runtime_handle(list, engine_kind);
+            return;
+        }
+        lfsr::visit_engine(list, engine_kind, [&](auto & engine) {
+            using engine_type = std::remove_cvref_t<decltype(engine)>;
+            result = std::make_unique<engine_handle<engine_type>>(engine);
+        });
+    });
+    return result.release();
+}
+
+
+lfsr_handle * lfsr_clone(lfsr_handle const * handle)
+{
+    auto result = std::unique_ptr<lfsr_handle>{};
+    guard([&] {
+        require(handle != nullptr, "handle is null");
+        result = handle->clone();
+    });
+    return result.release();
+}
+
+
+void lfsr_destroy(lfsr_handle * handle)
+{
+    delete handle;
+}
+
+
+lfsr_status lfsr_scramble(lfsr_handle * handle, uint8_t const * in,
+                          uint8_t * out, size_t len)
+{
+    return guard([&] {
+        require(handle != nullptr, "handle is null");
+        require((in != nullptr && out != nullptr) || len == 0, "buffer is null");
+        handle->scramble(in, out, len);
+    });
+}
+
+
+lfsr_status lfsr_descramble(lfsr_handle * handle, uint8_t const * in,
+                            uint8_t * out, size_t len)
+{
+    return guard([&] {
+        require(handle != nullptr, "handle is null");
+        require((in != nullptr && out != nullptr) || len == 0, "buffer is null");
+        handle->descramble(in, out, len);
+    });
+}
+
+
+lfsr_status lfsr_advance(lfsr_handle * handle, uint64_t bits)
+{
+    return guard([&] {
+        require(handle != nullptr, "handle is null");
+        handle->advance(bits);
+    });
+}
+
+
+size_t lfsr_degree(lfsr_handle const * handle)
+{
+    return handle == nullptr ? 0 : handle->degree();
+}
+
+
+size_t lfsr_state_size(lfsr_handle const * handle)
+{
+    return handle == nullptr ? 0 : state_size(*handle);
+}
+
+
+lfsr_status lfsr_get_state(lfsr_handle const * handle, uint8_t * state,
+                           size_t len)
+{
+    return guard([&] {
+        require(handle != nullptr, "handle is null");
+        require(state != nullptr, "state is null");
+        require(len >= state_size(*handle), "state buffer is too small");
+        handle->get_state(state);
+    });
+}
+
+
+lfsr_status lfsr_set_state(lfsr_handle * handle, uint8_t const * state,
+                           size_t len)
+{
+    return guard([&] {
+        require(handle != nullptr, "handle is null");
+        require(state != nullptr, "state is null");
+        require(len >= state_size(*handle), "state buffer is too small");
+        handle->set_state(state);
+    });
+}
+
+}
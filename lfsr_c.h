@@ -0,0 +1,120 @@
+#ifndef LFSR_C_H
+#define LFSR_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A C interface to the scramblers, for C and anything with a C FFI, built as
+   liblfsr (the `lfsr_c` and `lfsr_c_static` targets).
+
+   A scrambler is an opaque handle, created for a set of taps and an engine
+   kind (order and tap 0 don't matter, so {0, 39, 58} is {58, 39}). The
+   prebuilt tap lists in lfsr_dispatch.hpp run their compiled kernels; any
+   other taps, up to a degree of 4096, run a kernel that loops over them,
+   the word engine's for every Fibonacci kind, which is slower but gives the
+   same output. Everything past creation works on whole buffers, so that
+   crossing the FFI costs once per buffer rather than once per byte.
+
+   Functions returning `lfsr_status` return LFSR_OK, or a code and set a
+   message for `lfsr_last_error()`. A handle may be used from one thread at
+   a time; different handles are independent.
+
+   The ABI only grows: functions and enumerators are added, never changed,
+   and `lfsr_abi_version()` goes up when they are. */
+
+#if defined(_WIN32)
+#  if defined(LFSR_C_BUILD)
+#    define LFSR_C_API __declspec(dllexport)
+#  elif defined(LFSR_C_SHARED)
+#    define LFSR_C_API __declspec(dllimport)
+#  else
+#    define LFSR_C_API
+#  endif
+#else
+#  define LFSR_C_API __attribute__((visibility("default")))
+#endif
+
+#define LFSR_C_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct lfsr_handle lfsr_handle;
+
+typedef enum lfsr_kind
+{
+    LFSR_KIND_AUTO           = 0,   /* word up to degree 64, otherwise bulk */
+    LFSR_KIND_FIBONACCI      = 1,
+    LFSR_KIND_GALOIS         = 2,
+    LFSR_KIND_FIBONACCI_BULK = 3,
+    LFSR_KIND_FIBONACCI_WORD = 4
+} lfsr_kind;
+
+typedef enum lfsr_status
+{
+    LFSR_OK               = 0,
+    LFSR_INVALID_ARGUMENT = 1,  /* including no taps, or too high a degree */
+    LFSR_OUT_OF_MEMORY    = 2,
+    LFSR_INTERNAL_ERROR   = 3
+} lfsr_status;
+
+
+/* LFSR_C_ABI_VERSION of the library, rather than of the header */
+LFSR_C_API uint32_t lfsr_abi_version(void);
+
+/* The message for the last error on this thread, or "" if there was none.
+   It stays valid until the next call on this thread. */
+LFSR_C_API char const * lfsr_last_error(void);
+
+
+/* A scrambler for `taps`, with its register all ones, or NULL on error */
+LFSR_C_API lfsr_handle * lfsr_create(size_t const * taps, size_t ntaps,
+                                     lfsr_kind kind);
+
+/* A copy of `handle`, register and all, or NULL on error */
+LFSR_C_API lfsr_handle * lfsr_clone(lfsr_handle const * handle);
+
+/* Does nothing given NULL */
+LFSR_C_API void lfsr_destroy(lfsr_handle * handle);
+
+
+/* `len` bytes from `in` to `out`, bit 0 of each byte first; `out` may be
+   `in`, but they may not otherwise overlap */
+LFSR_C_API lfsr_status lfsr_scramble(lfsr_handle * handle, uint8_t const * in,
+                                     uint8_t * out, size_t len);
+
+LFSR_C_API lfsr_status lfsr_descramble(lfsr_handle * handle,
+                                       uint8_t const * in, uint8_t * out,
+                                       size_t len);
+
+/* Moves the register on as if `bits` zero bits had been scrambled. This
+   jumps, for every engine, in time logarithmic in `bits` and about square
+   in the degree: microseconds up to a degree of 64, and about a millisecond
+   at the largest prebuilt degree, 521. */
+LFSR_C_API lfsr_status lfsr_advance(lfsr_handle * handle, uint64_t bits);
+
+
+/* The degree of the polynomial, which is the size of the register in bits */
+LFSR_C_API size_t lfsr_degree(lfsr_handle const * handle);
+
+/* Bytes taken by the state: the degree, rounded up to whole bytes */
+LFSR_C_API size_t lfsr_state_size(lfsr_handle const * handle);
+
+/* The register, bit i of the engine's `state()` in bit i % 8 of byte i / 8,
+   unused bits zero; `len` must be at least `lfsr_state_size()`. For every
+   engine but Galois, bit 0 is the most recent scrambled bit. */
+LFSR_C_API lfsr_status lfsr_get_state(lfsr_handle const * handle,
+                                      uint8_t * state, size_t len);
+
+/* The inverse of `lfsr_get_state()`; unused bits are ignored */
+LFSR_C_API lfsr_status lfsr_set_state(lfsr_handle * handle,
+                                      uint8_t const * state, size_t len);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <lfsr.hpp>
+
+namespace lfsr {
+
+
+/* Two scramblers in series as one.
+
+   A feedthrough scrambler divides the data by its connection polynomial,
+   1 + the sum of x^t for each tap t, and the descrambler multiplies by it
+   again. Dividing by a and then by b is dividing by a * b, so a cascade of
+   two is one scrambler whose taps are the terms of the product, of degree
+   the sum of the two; the descrambler likewise undoes both stages at once.
+
+   Its state is the last `degree` bits out of the second stage. That holds
+   the states of both stages: the second's is the most recent bits of it,
+   and the first's, the bits between the stages, are those bits times b. */
+
+
+namespace detail {
+
+/* The taps of the product of the connection polynomials of `TapsA` and
+   `TapsB`, as a `tap_list` with the input's 0 */
+template <typename TapsA, typename TapsB>
+struct cascade_taps
+{
+    constexpr static auto degree = TapsA::highest() + TapsB::highest();
+
+    constexpr static auto coefficients = [] {
+        auto a = std::array<bool, degree + 1>{};
+        auto b = std::array<bool, degree + 1>{};
+        a[0] = true;
+        b[0] = true;
+        for (auto t : TapsA::values) {
+            a[t] = true;
+        }
+        for (auto t : TapsB::values) {
+            b[t] = true;
+        }
+
+        auto result = std::array<bool, degree + 1>{};
+        for (auto ii = std::size_t{}; ii <= degree; ++ii) {
+            for (auto jj = std::size_t{}; ii + jj <= degree; ++jj) {
+                result[ii + jj] = result[ii + jj] != (a[ii] && b[jj]);
+            }
+        }
+        return result;
+    }();
+
+    constexpr static auto count = [] {
+        auto result = std::size_t{};
+        for (auto ii = std::size_t{1}; ii <= degree; ++ii) {
+            result += coefficients[ii];
+        }
+        return result;
+    }();
+
+    constexpr static auto taps = [] {
+        auto result = std::array<std::size_t, count>{};
+        auto next = std::size_t{};
+        for (auto ii = std::size_t{1}; ii <= degree; ++ii) {
+            if (coefficients[ii]) {
+                result[next++] = ii;
+            }
+        }
+        return result;
+    }();
+
+    template <std::size_t ... Indices>
+    static auto make(std::index_sequence<Indices...>)
+        -> tap_list<0, taps[Indices]...>;
+
+    using type = decltype(make(std::make_index_sequence<count>{}));
+};
+
+
+/* The last bits out of a cascade's second stage, from the stages' states,
+   and back. Bits between the stages are the second stage's output with its
+   taps added back in; so, going the other way, each older bit out of the
+   second stage is the one between the stages `second_degree` bits later,
+   less the rest of the second stage's taps. */
+template <typename TapsA, typename TapsB>
+struct cascade_states
+{
+    constexpr static auto first_degree  = TapsA::highest();
+    constexpr static auto second_degree = TapsB::highest();
+    constexpr static auto degree        = first_degree + second_degree;
+
+    static auto combine(std::bitset<first_degree> const & first,
+                        std::bitset<second_degree> const & second)
+        -> std::bitset<degree>
+    {
+        auto out = std::bitset<degree>{};
+        for (auto ii = std::size_t{}; ii != second_degree; ++ii) {
+            out.set(ii, second.test(ii));
+        }
+        for (auto ii = std::size_t{}; ii != first_degree; ++ii)
+        {
+            auto bit = first.test(ii) != out.test(ii);
+            for (auto t : TapsB::values) {
+                if (t != 0 && t != second_degree) {
+                    bit = bit != out.test(ii + t);
+                }
+            }
+            out.set(ii + second_degree, bit);
+        }
+        return out;
+    }
+
+    static auto first(std::bitset<degree> const & out)
+        -> std::bitset<first_degree>
+    {
+        auto result = std::bitset<first_degree>{};
+        for (auto ii = std::size_t{}; ii != first_degree; ++ii)
+        {
+            auto bit = out.test(ii);
+            for (auto t : TapsB::values) {
+                if (t != 0) {
+                    bit = bit != out.test(ii + t);
+                }
+            }
+            result.set(ii, bit);
+        }
+        return result;
+    }
+
+    static auto second(std::bitset<degree> const & out)
+        -> std::bitset<second_degree>
+    {
+        auto result = std::bitset<second_degree>{};
+        for (auto ii = std::size_t{}; ii != second_degree; ++ii) {
+            result.set(ii, out.test(ii));
+        }
+        return result;
+    }
+};
+
+
+template <typename TapList>
+struct bulk_engine;
+
+template <std::size_t ... Taps>
+struct bulk_engine<tap_list<Taps...>>
+{
+    using type = feedthrough_fibonacci_bulk<Taps...>;
+};
+
+template <typename TapList>
+struct word_engine_with;
+
+template <std::size_t ... Taps>
+struct word_engine_with<tap_list<Taps...>>
+{
+    using type = feedthrough_fibonacci_word<Taps...>;
+};
+
+
+/* The kernels' engines don't keep stats, as the cascade records each call
+   to it once, whichever kernel it has and however many calls that makes to
+   the engines. Their ranges return the number of bytes, for the stats. */
+
+/* One engine over the product, with the combined state. Its range is a byte
+   at a time, so this is too, counting them. */
+template <typename TapsA, typename TapsB>
+class product_kernel
+{
+public:
+    using states = cascade_states<TapsA, TapsB>;
+    using engine_type = typename bulk_engine<
+            typename cascade_taps<TapsA, TapsB>::type>::type;
+
+    constexpr static auto stats_kernel = lfsr::stats_kernel::fibonacci_bulk;
+
+    auto scramble_bit(bool value) noexcept -> bool
+    {
+        return m_engine.scramble_bit(value);
+    }
+
+    auto descramble_bit(bool value) noexcept -> bool
+    {
+        return m_engine.descramble_bit(value);
+    }
+
+    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        return m_engine.scramble_byte(value);
+    }
+
+    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        return m_engine.descramble_byte(value);
+    }
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto scramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept
+        -> std::uint64_t
+    {
+        auto bytes = std::uint64_t{};
+        for (; first != last; ++first, ++d_first, ++bytes) {
+            *d_first = m_engine.scramble_byte(*first);
+        }
+        return bytes;
+    }
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto descramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept
+        -> std::uint64_t
+    {
+        auto bytes = std::uint64_t{};
+        for (; first != last; ++first, ++d_first, ++bytes) {
+            *d_first = m_engine.descramble_byte(*first);
+        }
+        return bytes;
+    }
+
+    auto state() const -> std::bitset<states::degree>
+    {
+        return m_engine.state();
+    }
+
+    auto set_state(std::bitset<states::degree> const & state) noexcept -> void
+    {
+        m_engine.set_state(state);
+    }
+
+private:
+    engine_type m_engine;
+};
+
+
+/* Both stages' word engines, one after the other on each word while it's in
+   a register. The product has up to (n + 1)(m + 1) - 1 taps, against n + m
+   for the stages, and its lowest tap is no higher than theirs, so where
+   both fit in a word this is fewer shifts than one over the product. */
+template <typename TapsA, typename TapsB>
+class staged_kernel
+{
+public:
+    using states = cascade_states<TapsA, TapsB>;
+    using first_type  = typename word_engine_with<TapsA>::type;
+    using second_type = typename word_engine_with<TapsB>::type;
+
+    constexpr static auto stats_kernel = lfsr::stats_kernel::fibonacci_word;
+
+    auto scramble_bit(bool value) noexcept -> bool
+    {
+        return m_second.scramble_bit(m_first.scramble_bit(value));
+    }
+
+    auto descramble_bit(bool value) noexcept -> bool
+    {
+        return m_first.descramble_bit(m_second.descramble_bit(value));
+    }
+
+    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        return m_second.scramble_byte(m_first.scramble_byte(value));
+    }
+
+    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        return m_first.descramble_byte(m_second.descramble_byte(value));
+    }
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto scramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept
+        -> std::uint64_t
+    {
+        return transform_range(first, last, d_first,
+                [](auto & a, auto & b, auto v) {
+            return b.scramble_word(a.scramble_word(v));
+        }, [](auto & a, auto & b, auto v) {
+            return b.scramble_byte(a.scramble_byte(v));
+        });
+    }
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto descramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept
+        -> std::uint64_t
+    {
+        return transform_range(first, last, d_first,
+                [](auto & a, auto & b, auto v) {
+            return a.descramble_word(b.descramble_word(v));
+        }, [](auto & a, auto & b, auto v) {
+            return a.descramble_byte(b.descramble_byte(v));
+        });
+    }
+
+    auto state() const -> std::bitset<states::degree>
+    {
+        return states::combine(m_first.state(), m_second.state());
+    }
+
+    auto set_state(std::bitset<states::degree> const & state) noexcept -> void
+    {
+        m_first.set_state(states::first(state));
+        m_second.set_state(states::second(state));
+    }
+
+private:
+    /* Words where both sides are contiguous bytes, on local copies of the
+       stages so that the stores can't alias them, and then bytes */
+    template <typename Iter1, typename Iter2, typename Word, typename Byte>
+    auto transform_range(Iter1 first, Iter1 last, Iter2 d_first, Word && word,
+                         Byte && byte) noexcept -> std::uint64_t
+    {
+        auto a = m_first;
+        auto b = m_second;
+        auto bytes = std::uint64_t{};
+        if constexpr (std::contiguous_iterator<Iter1>
+                && std::contiguous_iterator<Iter2>
+                && iter_is_byte<Iter1> && iter_is_byte<Iter2>)
+        {
+            for (; last - first >= 8; first += 8, d_first += 8, bytes += 8) {
+                store_le64(std::to_address(d_first),
+                        word(a, b, load_le64(std::to_address(first))));
+            }
+        }
+        for (; first != last; ++first, ++d_first, ++bytes) {
+            *d_first = byte(a, b, static_cast<std::uint8_t>(*first));
+        }
+        m_first = a;
+        m_second = b;
+        return bytes;
+    }
+
+    first_type  m_first;
+    second_type m_second;
+};
+
+
+template <typename TapsA, typename TapsB>
+using cascade_kernel = std::conditional_t<
+        (TapsA::highest() <= 64 && TapsB::highest() <= 64),
+        staged_kernel<TapsA, TapsB>,
+        product_kernel<TapsA, TapsB>>;
+
+}
+
+
+
+/* `TapsA` and then `TapsB`, each a `tap_list`, scrambled in one pass over
+   the data, where a separate engine for each would take two.
+
+   Where both stages fit in a 64 bit word, each word goes through both
+   stages' word engines in turn; otherwise it goes through a bulk engine
+   over the product, `tap_list`, in one. Either way, `state()` is the
+   product's register, the last `degree` bits out of the second stage, and
+   `first_state()`, `second_state()` and `set_states()` give the states of
+   the stages, as from their own `state()`, for handing over to or from
+   separate engines. It starts as two stages that both start as all ones
+   would. */
+template <typename Stats, typename TapsA, typename TapsB>
+class basic_cascade
+{
+public:
+    using tap_list    = typename detail::cascade_taps<TapsA, TapsB>::type;
+    using kernel_type = detail::cascade_kernel<TapsA, TapsB>;
+    using stats_type  = Stats;
+
+    constexpr static auto first_degree  = TapsA::highest();
+    constexpr static auto second_degree = TapsB::highest();
+    constexpr static auto degree        = first_degree + second_degree;
+
+    basic_cascade()
+    {
+        set_states(std::bitset<first_degree>{}.set(),
+                std::bitset<second_degree>{}.set());
+    }
+
+    auto scramble_bit(bool value) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::bit, 1);
+        return m_kernel.scramble_bit(value);
+    }
+
+    auto descramble_bit(bool value) noexcept -> bool
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::bit, 1);
+        return m_kernel.descramble_bit(value);
+    }
+
+    auto scramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::scramble, stats_call::byte, 8);
+        return m_kernel.scramble_byte(value);
+    }
+
+    auto descramble_byte(std::uint8_t value) noexcept -> std::uint8_t
+    {
+        [[maybe_unused]] auto stats = track(stats_direction::descramble, stats_call::byte, 8);
+        return m_kernel.descramble_byte(value);
+    }
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto scramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
+    {
+        auto stats = track(stats_direction::scramble, stats_call::range);
+        stats.add_bits(8 * m_kernel.scramble_range(first, last, d_first));
+    }
+
+    template <typename Iter1, typename Iter2>
+        requires detail::iter_is_byte<Iter1>
+    auto descramble_range(Iter1 first, Iter1 last, Iter2 d_first) noexcept -> void
+    {
+        auto stats = track(stats_direction::descramble, stats_call::range);
+        stats.add_bits(8 * m_kernel.descramble_range(first, last, d_first));
+    }
+
+    auto state() const -> std::bitset<degree>
+    {
+        return m_kernel.state();
+    }
+
+    auto set_state(std::bitset<degree> const & state) noexcept -> void
+    {
+        m_kernel.set_state(state);
+    }
+
+    /* Back to both stages all ones, as constructed */
+    auto reset() noexcept -> void
+    {
+        set_states(std::bitset<first_degree>{}.set(),
+                std::bitset<second_degree>{}.set());
+    }
+
+    /* Loads `seed` as the product's state, as the engines' `reset(seed)` */
+    auto reset(std::uint64_t seed) noexcept -> void
+    {
+        set_state(std::bitset<degree>{seed});
+    }
+
+    /* The last bits between the stages */
+    auto first_state() const -> std::bitset<first_degree>
+    {
+        return states::first(state());
+    }
+
+    /* The last bits out of the second stage */
+    auto second_state() const -> std::bitset<second_degree>
+    {
+        return states::second(state());
+    }
+
+    auto set_states(std::bitset<first_degree> const & first,
+                    std::bitset<second_degree> const & second) noexcept -> void
+    {
+        set_state(states::combine(first, second));
+    }
+
+private:
+    using states = detail::cascade_states<TapsA, TapsB>;
+
+    static auto track(stats_direction dir, stats_call call,
+                      std::uint64_t bits = 0) noexcept
+        -> detail::stats_scope<Stats>
+    {
+        return {dir, call, kernel_type::stats_kernel, bits};
+    }
+
+    kernel_type m_kernel;
+};
+
+
+template <typename TapsA, typename TapsB>
+using cascade = basic_cascade<no_stats, TapsA, TapsB>;
+
+
+}
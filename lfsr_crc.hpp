@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <lfsr_detail.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define LFSR_CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define LFSR_CRC32C_ARM 1
+#endif
+
+namespace lfsr {
+
+
+/* CRC32C (Castagnoli), as used by iSCSI, SCTP and ext4, and scrambling or
+   descrambling fused with it.
+
+   The CRC uses the processor's CRC32 instruction where there is one: on
+   x86-64 that's SSE 4.2, which is checked for at run time unless the
+   compiler has been told it's there; on ARM, it has to be enabled at
+   compile time. Otherwise it falls back to slicing by 8 with tables. */
+
+
+namespace detail {
+
+constexpr auto crc32c_polynomial = std::uint32_t{0x82f63b78};
+
+/* tables[k][b] is the CRC of byte b followed by k zero bytes */
+constexpr auto make_crc32c_tables()
+{
+    auto tables = std::array<std::array<std::uint32_t, 256>, 8>{};
+    for (auto b = std::uint32_t{}; b != 256; ++b)
+    {
+        auto crc = b;
+        for (auto ii = 0; ii != 8; ++ii) {
+            crc = (crc >> 1) ^ (crc & 1 ? crc32c_polynomial : 0);
+        }
+        tables[0][b] = crc;
+    }
+    for (auto k = 1u; k != 8; ++k) {
+        for (auto b = 0u; b != 256; ++b) {
+            auto const previous = tables[k - 1][b];
+            tables[k][b] = (previous >> 8) ^ tables[0][previous & 0xff];
+        }
+    }
+    return tables;
+}
+
+inline constexpr auto crc32c_tables = make_crc32c_tables();
+
+
+inline auto crc32c_software(std::uint32_t crc, std::uint8_t const * data,
+                            std::size_t size) noexcept -> std::uint32_t
+{
+    auto const & t = crc32c_tables;
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        auto const v = load_le64(data) ^ crc;
+        crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff]
+            ^ t[5][(v >> 16) & 0xff] ^ t[4][(v >> 24) & 0xff]
+            ^ t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff]
+            ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+    }
+    for (; size != 0; --size, ++data) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xff];
+    }
+    return crc;
+}
+
+
+#if defined(LFSR_CRC32C_X86)
+
+__attribute__((target("sse4.2")))
+inline auto crc32c_hardware(std::uint32_t crc, std::uint8_t const * data,
+                            std::size_t size) noexcept -> std::uint32_t
+{
+    auto wide = std::uint64_t{crc};
+    for (; size >= 8; size -= 8, data += 8) {
+        wide = _mm_crc32_u64(wide, load_le64(data));
+    }
+    crc = static_cast<std::uint32_t>(wide);
+    for (; size != 0; --size, ++data) {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+
+inline auto has_crc32c_instruction() noexcept -> bool
+{
+#if defined(__SSE4_2__)
+    return true;
+#else
+    static auto const result = __builtin_cpu_supports("sse4.2") != 0;
+    return result;
+#endif
+}
+
+#elif defined(LFSR_CRC32C_ARM)
+
+inline auto crc32c_hardware(std::uint32_t crc, std::uint8_t const * data,
+                            std::size_t size) noexcept -> std::uint32_t
+{
+    for (; size >= 8; size -= 8, data += 8) {
+        crc = __crc32cd(crc, load_le64(data));
+    }
+    for (; size != 0; --size, ++data) {
+        crc = __crc32cb(crc, *data);
+    }
+    return crc;
+}
+
+constexpr auto has_crc32c_instruction() noexcept -> bool
+{
+    return true;
+}
+
+#else
+
+inline auto crc32c_hardware(std::uint32_t crc, std::uint8_t const * data,
+                            std::size_t size) noexcept -> std::uint32_t
+{
+    return crc32c_software(crc, data, size);
+}
+
+constexpr auto has_crc32c_instruction() noexcept -> bool
+{
+    return false;
+}
+
+#endif
+
+}
+
+
+/* Whether `crc32c` uses the processor's CRC32 instruction */
+inline auto crc32c_uses_hardware() noexcept -> bool
+{
+    return detail::has_crc32c_instruction();
+}
+
+
+/* A running CRC32C: initialised to all ones, and inverted at the end */
+class crc32c
+{
+public:
+    auto update(std::uint8_t const * first, std::uint8_t const * last) noexcept
+        -> void
+    {
+        auto const size = static_cast<std::size_t>(last - first);
+        m_crc = detail::has_crc32c_instruction()
+                ? detail::crc32c_hardware(m_crc, first, size)
+                : detail::crc32c_software(m_crc, first, size);
+    }
+
+    auto value() const noexcept -> std::uint32_t
+    {
+        return ~m_crc;
+    }
+
+private:
+    std::uint32_t m_crc = ~std::uint32_t{};
+};
+
+
+/* Which side of the scrambler the CRC is over */
+enum class crc_of
+{
+    plaintext,
+    scrambled,
+};
+
+
+
+namespace detail {
+
+/* Bytes scrambled and then CRC'd at a time, so that the second pass over
+   them finds them in the L1 cache: input and output take 8K between them */
+constexpr auto fused_chunk = std::size_t{4096};
+
+/* Transforms [first, last) into d_first a chunk at a time, CRCing either
+   the input before it's transformed (it may be overwritten, in place) or
+   the output after */
+template <typename Transform>
+auto transform_with_crc(std::uint8_t const * first, std::uint8_t const * last,
+                        std::uint8_t * d_first, crc32c & crc, bool crc_input,
+                        Transform && transform) noexcept -> void
+{
+    while (first != last)
+    {
+        auto const size = std::min(fused_chunk,
+                static_cast<std::size_t>(last - first));
+        if (crc_input) {
+            crc.update(first, first + size);
+            transform(first, first + size, d_first);
+        } else {
+            transform(first, first + size, d_first);
+            crc.update(d_first, d_first + size);
+        }
+        first += size;
+        d_first += size;
+    }
+}
+
+}
+
+
+/* Scrambles [first, last) into d_first, which may be first, with any
+   engine, and adds the plaintext or the scrambled bytes to `crc`, in one
+   pass over memory */
+template <typename LFSR>
+auto scramble_with_crc(LFSR & lfsr, std::uint8_t const * first,
+                       std::uint8_t const * last, std::uint8_t * d_first,
+                       crc32c & crc, crc_of over = crc_of::plaintext) noexcept
+    -> void
+{
+    detail::transform_with_crc(first, last, d_first, crc,
+            over == crc_of::plaintext, [&](auto f, auto l, auto d) {
+        lfsr.scramble_range(f, l, d);
+    });
+}
+
+/* As above, descrambling */
+template <typename LFSR>
+auto descramble_with_crc(LFSR & lfsr, std::uint8_t const * first,
+                         std::uint8_t const * last, std::uint8_t * d_first,
+                         crc32c & crc, crc_of over = crc_of::plaintext) noexcept
+    -> void
+{
+    detail::transform_with_crc(first, last, d_first, crc,
+            over == crc_of::scrambled, [&](auto f, auto l, auto d) {
+        lfsr.descramble_range(f, l, d);
+    });
+}
+
+/* Descrambles a payload and checks it against the CRC that came with it */
+template <typename LFSR>
+auto descramble_and_check(LFSR & lfsr, std::uint8_t const * first,
+                          std::uint8_t const * last, std::uint8_t * d_first,
+                          std::uint32_t expected,
+                          crc_of over = crc_of::plaintext) noexcept -> bool
+{
+    auto crc = crc32c{};
+    descramble_with_crc(lfsr, first, last, d_first, crc, over);
+    return crc.value() == expected;
+}
+
+
+}
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <map>
 #include <set>
 #include <vector>
 
 #include <lfsr_tap_list.hpp>
+#include <lfsr_word_array.hpp>
 
 namespace lfsr::detail {
 
@@ -23,6 +27,35 @@ constexpr static auto iter_is_bool = std::is_same_v<iter_value_t<Iter>, bool>;
 
 
 
+/* Eight bytes as a word, the first in the lowest bits, whatever the
+   platform's byte order */
+inline auto load_le64(std::uint8_t const * bytes) noexcept -> std::uint64_t
+{
+    auto result = std::uint64_t{};
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&result, bytes, 8);
+    } else {
+        for (auto ii = 0u; ii != 8; ++ii) {
+            result |= std::uint64_t{bytes[ii]} << (8 * ii);
+        }
+    }
+    return result;
+}
+
+inline auto store_le64(std::uint8_t * bytes, std::uint64_t value) noexcept
+    -> void
+{
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(bytes, &value, 8);
+    } else {
+        for (auto ii = 0u; ii != 8; ++ii) {
+            bytes[ii] = static_cast<std::uint8_t>(value >> (8 * ii));
+        }
+    }
+}
+
+
+
 /* We want to ignore any tap that is zero valued -- this just represents the
    input bit and does not need to be iterated over in the stored bufffer of
    bits. The idea is that `TapList` holds a type that is some variant of
@@ -62,5 +95,36 @@ using make_tap_list_t = typename remove_tap<tap_list<>, 0, Taps...>::value_type;
 template <std::size_t ... Taps>
 using make_index_list_t = typename make_tap_list_t<Taps...>::to_indices;
 
+
+
+/* Mask with the bit at each of `indices` set */
+template <std::size_t Bits, std::size_t N>
+constexpr auto make_mask(std::array<std::size_t, N> const & indices)
+    -> word_array<Bits>
+{
+    auto result = word_array<Bits>{};
+    for (auto index : indices) {
+        result.set(index);
+    }
+    return result;
+}
+
+
+/* The period of a maximal length LFSR, 2^degree - 1. Up to a degree of 64 this
+   fits in a `std::uint64_t`. Above that it can't be represented by any builtin
+   type, so it is returned as a `word_array` with every bit set, which read as
+   a multi-word unsigned integer is the same value. */
+template <std::size_t Degree>
+constexpr auto max_period()
+{
+    if constexpr (Degree < 64) {
+        return (std::uint64_t{1} << Degree) - 1;
+    } else if constexpr (Degree == 64) {
+        return ~std::uint64_t{};
+    } else {
+        return word_array<Degree>{}.set();
+    }
+}
+
 }
 
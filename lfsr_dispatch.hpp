@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <format>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <lfsr.hpp>
+
+namespace lfsr {
+
+/* The LFSRs are templated on their taps, so picking one at runtime (e.g. from
+   the command line) means choosing from a set that has been compiled in. This
+   is that set: the usual scrambler and PRBS polynomials, and a few long ones.
+   Tap lists are matched regardless of order, or whether they name tap 0. */
+using prebuilt_tap_lists = std::tuple<
+        tap_list<7, 4>,             // 802.11
+        tap_list<7, 6>,             // PRBS7, DVB
+        tap_list<9, 5>,             // PRBS9
+        tap_list<11, 9>,            // PRBS11
+        tap_list<15, 14>,           // PRBS15, DVB-S
+        tap_list<16, 5, 4, 3>,      // USB 3
+        tap_list<16, 15, 13, 4>,    // SATA
+        tap_list<18, 7>,            // DVB-S2 physical layer
+        tap_list<20, 3>,            // PRBS20
+        tap_list<20, 17>,
+        tap_list<23, 18>,           // PRBS23
+        tap_list<23, 21, 16, 8, 5, 2>, // PCIe 128b/130b
+        tap_list<31, 28>,           // PRBS31
+        tap_list<58, 39>,           // 64b/66b
+        tap_list<71, 6>,
+        tap_list<127, 1>,
+        tap_list<521, 32>
+    >;
+
+
+/* Names that can be given in place of a list of taps */
+constexpr auto polynomial_names = std::array<
+        std::pair<std::string_view, std::string_view>, 9>{{
+    {"ieee802.11", "7,4"},
+    {"prbs7",      "7,6"},
+    {"prbs9",      "9,5"},
+    {"prbs11",     "11,9"},
+    {"prbs15",     "15,14"},
+    {"prbs20",     "20,3"},
+    {"prbs23",     "23,18"},
+    {"prbs31",     "31,28"},
+    {"64b66b",     "58,39"},
+}};
+
+
+enum class engine_kind
+{
+    fibonacci,
+    galois,
+    fibonacci_bulk,
+    fibonacci_word,
+};
+
+
+inline auto to_string(engine_kind kind) -> std::string_view
+{
+    switch (kind) {
+        case engine_kind::fibonacci:      return "fibonacci";
+        case engine_kind::galois:         return "galois";
+        case engine_kind::fibonacci_bulk: return "fibonacci_bulk";
+        case engine_kind::fibonacci_word: return "fibonacci_word";
+    }
+    return "unknown";
+}
+
+
+inline auto parse_engine_kind(std::string_view name) -> engine_kind
+{
+    if (name == "fibonacci") {
+        return engine_kind::fibonacci;
+    }
+    if (name == "galois") {
+        return engine_kind::galois;
+    }
+    if (name == "fibonacci_bulk" || name == "bulk") {
+        return engine_kind::fibonacci_bulk;
+    }
+    if (name == "fibonacci_word" || name == "word") {
+        return engine_kind::fibonacci_word;
+    }
+    throw std::invalid_argument(std::format("unknown engine '{}', expected "
+            "fibonacci, galois, fibonacci_bulk or fibonacci_word", name));
+}
+
+
+/* The highest degree an engine of the given kind can be built for */
+inline auto max_degree(engine_kind kind) -> std::size_t
+{
+    return kind == engine_kind::fibonacci_word
+            ? 64
+            : std::numeric_limits<std::size_t>::max();
+}
+
+
+/* Parses either a comma separated list of taps, e.g. "0,17,20", or one of the
+   `polynomial_names`. */
+inline auto parse_taps(std::string_view text) -> std::vector<std::size_t>
+{
+    for (auto const & [name, taps] : polynomial_names) {
+        if (text == name) {
+            return parse_taps(taps);
+        }
+    }
+
+    /* Every token, including any after a last comma, has to be a number
+       that fits */
+    auto result = std::vector<std::size_t>{};
+    for (auto more = !text.empty(); more; )
+    {
+        auto const comma = text.find(',');
+        auto const token = text.substr(0, comma);
+        auto const last = token.data() + token.size();
+
+        auto tap = std::size_t{};
+        auto const [end, error] = std::from_chars(token.data(), last, tap);
+        if (error == std::errc::result_out_of_range) {
+            throw std::invalid_argument(std::format(
+                    "tap '{}' is out of range", token));
+        }
+        if (error != std::errc{} || end != last) {
+            throw std::invalid_argument(std::format("invalid tap '{}'", token));
+        }
+        result.push_back(tap);
+
+        more = comma != std::string_view::npos;
+        text = more ? text.substr(comma + 1) : std::string_view{};
+    }
+    return result;
+}
+
+
+
+namespace detail {
+
+/* Sorted, without duplicates and without the zero tap */
+inline auto normalise_taps(std::span<std::size_t const> taps)
+    -> std::vector<std::size_t>
+{
+    auto result = std::vector<std::size_t>{};
+    for (auto tap : taps) {
+        if (tap != 0) {
+            result.push_back(tap);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+
+template <typename TapList>
+struct prebuilt_engine;
+
+template <std::size_t ... Taps>
+struct prebuilt_engine<tap_list<Taps...>>
+{
+    template <typename Func>
+    static auto visit_if_matches(std::span<std::size_t const> taps,
+                                 engine_kind kind,
+                                 Func && func) -> bool
+    {
+        constexpr auto values = std::array<std::size_t, sizeof...(Taps)>{Taps...};
+        if (normalise_taps(values) != normalise_taps(taps)) {
+            return false;
+        }
+
+        switch (kind) {
+            case engine_kind::fibonacci: {
+                auto engine = feedthrough_fibonacci<Taps...>{};
+                func(engine);
+                break;
+            }
+            case engine_kind::galois: {
+                auto engine = feedthrough_galois<Taps...>{};
+                func(engine);
+                break;
+            }
+            case engine_kind::fibonacci_bulk: {
+                auto engine = feedthrough_fibonacci_bulk<Taps...>{};
+                func(engine);
+                break;
+            }
+            case engine_kind::fibonacci_word: {
+                if constexpr (std::max({Taps...}) <= 64) {
+                    auto engine = feedthrough_fibonacci_word<Taps...>{};
+                    func(engine);
+                } else {
+                    throw std::invalid_argument(std::format("the {} engine "
+                            "needs a degree of at most {}", to_string(kind),
+                            max_degree(kind)));
+                }
+                break;
+            }
+        }
+        return true;
+    }
+};
+
+}
+
+
+/* Whether `taps` is one of the `prebuilt_tap_lists`, in any order, with or
+   without tap 0 */
+inline auto is_prebuilt(std::span<std::size_t const> taps) -> bool
+{
+    auto const wanted = detail::normalise_taps(taps);
+    return [&]<typename ... Lists>(std::tuple<Lists...> const *) {
+        return ((detail::normalise_taps(Lists::values) == wanted) || ...);
+    }(static_cast<prebuilt_tap_lists const *>(nullptr));
+}
+
+
+/* Calls `func` with a newly constructed engine of the given kind for `taps`,
+   which must be one of the `prebuilt_tap_lists`, and no longer than the
+   kind's `max_degree`. Throws `std::invalid_argument` otherwise. */
+template <typename Func>
+auto visit_engine(std::span<std::size_t const> taps,
+                  engine_kind kind,
+                  Func && func) -> void
+{
+    auto found = [&]<typename ... Lists>(std::tuple<Lists...> const *) {
+        return (detail::prebuilt_engine<Lists>::visit_if_matches(
+                taps, kind, func) || ...);
+    }(static_cast<prebuilt_tap_lists const *>(nullptr));
+
+    if (!found)
+    {
+        auto names = std::string{};
+        for (auto tap : taps) {
+            names += std::format("{}{}", names.empty() ? "" : ",", tap);
+        }
+        throw std::invalid_argument(std::format(
+                "no prebuilt kernel for taps {}", names));
+    }
+}
+
+
+}
@@ -0,0 +1,359 @@
+#include <lfsr.hpp>
+#include <lfsr_dispatch.hpp>
+#include <lfsr_seek.hpp>
+
+#include <tool_detail.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/* Scrambles or descrambles a file of any size.
+
+   The default mode memory maps the input and output a window at a time, so
+   there is no copy through user space buffers and nothing grows. The `direct`
+   mode instead streams through a single aligned buffer using O_DIRECT, which
+   keeps multi-hundred GB captures from evicting everything else from the page
+   cache.
+
+   Descrambling can also start from any `offset` into the input, for a slice
+   of `length` bytes, which reads only as much before the offset as the
+   register holds (see lfsr_seek.hpp). */
+
+namespace {
+
+constexpr auto usage =
+R"(usage: lfsr_file <scramble|descramble> <input> <output> --taps <taps> [options]
+
+  --taps <taps>      Comma separated taps, e.g. 0,17,20, or a polynomial name
+                     such as prbs7, prbs31 or 64b66b
+  --engine <name>    fibonacci, galois, fibonacci_bulk (default) or
+                     fibonacci_word
+  --mode <mode>      mmap (default) or direct
+  --window <size>    Bytes mapped at a time in mmap mode (default 1G)
+  --block <size>     Buffer size in direct mode (default 4M)
+  --hugepages        Ask for transparent huge pages on the mappings
+  --offset <size>    Descramble from this offset into the input (mmap mode)
+  --length <size>    Descramble only this many bytes (mmap mode)
+)";
+
+constexpr auto page_size = std::size_t{4096};
+
+
+struct options
+{
+    detail::direction        dir;
+    std::string              input;
+    std::string              output;
+    std::vector<std::size_t> taps;
+    lfsr::engine_kind        engine;
+    std::string              mode;
+    std::size_t              window;
+    std::size_t              block;
+    bool                     hugepages;
+    std::uint64_t            offset;
+    std::uint64_t            length;
+};
+
+
+struct totals
+{
+    std::uint64_t bytes   = 0;
+    double        kernel  = 0;  /* Seconds spent scrambling */
+};
+
+
+auto round_up(std::size_t value, std::size_t multiple) -> std::size_t
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+
+auto round_down(std::uint64_t value, std::uint64_t multiple) -> std::uint64_t
+{
+    return value / multiple * multiple;
+}
+
+
+/* A region of a file mapped into memory */
+class mapping
+{
+public:
+    mapping(int fd, off_t offset, std::size_t length, int prot, bool hugepages)
+        : m_length{length}
+    {
+        auto const flags = MAP_SHARED | MAP_POPULATE;
+        m_data = ::mmap(nullptr, length, prot, flags, fd, offset);
+        if (m_data == MAP_FAILED) {
+            detail::throw_system_error("mmap");
+        }
+
+        /* These are only hints, so failure is not an error; huge pages in
+           particular are only honoured by some file systems. */
+        ::madvise(m_data, length, MADV_SEQUENTIAL);
+        if (hugepages) {
+            ::madvise(m_data, length, MADV_HUGEPAGE);
+        }
+    }
+
+    mapping(mapping const &) = delete;
+    auto operator=(mapping const &) -> mapping & = delete;
+
+    ~mapping()
+    {
+        ::munmap(m_data, m_length);
+    }
+
+    auto data() const -> std::uint8_t *
+    {
+        return static_cast<std::uint8_t *>(m_data);
+    }
+
+private:
+    void *      m_data;
+    std::size_t m_length;
+};
+
+
+template <typename LFSR>
+auto run_mmap(options const & opts, LFSR & lfsr) -> totals
+{
+    auto in = detail::file_descriptor{::open(opts.input.c_str(), O_RDONLY)};
+    if (in.get() == -1) {
+        detail::throw_system_error(opts.input);
+    }
+
+    struct stat info{};
+    if (::fstat(in.get(), &info) == -1) {
+        detail::throw_system_error(opts.input);
+    }
+    auto const input_size = static_cast<std::uint64_t>(info.st_size);
+    if (opts.offset > input_size) {
+        throw std::invalid_argument(std::format("offset {} is past the end of "
+                "'{}', at {}", opts.offset, opts.input, input_size));
+    }
+    auto const begin = opts.offset;
+    auto const end = begin + std::min(opts.length, input_size - begin);
+
+    /* Starting part way in, the register is filled from the bytes before */
+    if (begin != 0)
+    {
+        auto const preceding = begin - std::min<std::uint64_t>(begin,
+                lfsr::history_bytes<LFSR>);
+        auto const aligned = round_down(preceding, page_size);
+        auto const length = static_cast<std::size_t>(begin - aligned);
+        auto history = mapping{in.get(), static_cast<off_t>(aligned), length,
+                PROT_READ, false};
+        lfsr::synchronise(lfsr, std::span<std::uint8_t const>{
+                history.data(), length});
+    }
+
+    auto out = detail::file_descriptor{::open(opts.output.c_str(),
+            O_RDWR | O_CREAT | O_TRUNC, 0644)};
+    if (out.get() == -1 || ::ftruncate(out.get(),
+            static_cast<off_t>(end - begin)) == -1) {
+        detail::throw_system_error(opts.output);
+    }
+
+    /* Output windows are page aligned; input ones are from the page below */
+    auto result = totals{};
+    auto const window = round_up(std::max(opts.window, page_size), page_size);
+    for (auto offset = begin; offset < end; offset += window)
+    {
+        auto const length = static_cast<std::size_t>(
+                std::min<std::uint64_t>(window, end - offset));
+        auto const aligned = round_down(offset, page_size);
+        auto const skip = static_cast<std::size_t>(offset - aligned);
+
+        auto source = mapping{in.get(), static_cast<off_t>(aligned),
+                skip + length, PROT_READ, opts.hugepages};
+        auto dest = mapping{out.get(), static_cast<off_t>(offset - begin),
+                length, PROT_READ | PROT_WRITE, opts.hugepages};
+
+        auto timer = detail::stopwatch{};
+        detail::transform(lfsr, opts.dir, source.data() + skip,
+                source.data() + skip + length, dest.data());
+        result.kernel += timer.seconds();
+        result.bytes  += length;
+    }
+    return result;
+}
+
+
+/* Opens with O_DIRECT, falling back to buffered I/O on file systems that don't
+   support it (e.g. tmpfs). */
+auto open_direct(std::string const & path, int flags) -> detail::file_descriptor
+{
+    auto fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+    if (fd == -1 && errno == EINVAL) {
+        std::cerr << std::format("{}: O_DIRECT not supported, using buffered "
+                "I/O\n", path);
+        fd = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd == -1) {
+        detail::throw_system_error(path);
+    }
+    return detail::file_descriptor{fd};
+}
+
+
+/* Reads until `length` bytes have been read or the end of the file */
+auto read_fully(int fd, std::uint8_t * data, std::size_t length) -> std::size_t
+{
+    auto total = std::size_t{};
+    while (total != length)
+    {
+        auto const count = ::read(fd, data + total, length - total);
+        if (count == -1 && errno == EINTR) {
+            continue;
+        }
+        if (count == -1) {
+            detail::throw_system_error("read");
+        }
+        if (count == 0) {
+            break;
+        }
+        total += static_cast<std::size_t>(count);
+    }
+    return total;
+}
+
+
+auto write_fully(int fd, std::uint8_t const * data, std::size_t length) -> void
+{
+    while (length != 0)
+    {
+        auto const count = ::write(fd, data, length);
+        if (count == -1 && errno == EINTR) {
+            continue;
+        }
+        if (count == -1) {
+            detail::throw_system_error("write");
+        }
+        data   += count;
+        length -= static_cast<std::size_t>(count);
+    }
+}
+
+
+template <typename LFSR>
+auto run_direct(options const & opts, LFSR & lfsr) -> totals
+{
+    auto in  = open_direct(opts.input, O_RDONLY);
+    auto out = open_direct(opts.output, O_WRONLY | O_CREAT | O_TRUNC);
+
+    /* O_DIRECT needs the buffer, offsets and sizes to be block aligned. The
+       data is scrambled in place, so only the one buffer is needed. */
+    auto const block = round_up(std::max(opts.block, page_size), page_size);
+    auto buffer = std::unique_ptr<std::uint8_t, decltype(&std::free)>{
+            static_cast<std::uint8_t *>(std::aligned_alloc(page_size, block)),
+            &std::free};
+    if (!buffer) {
+        throw std::bad_alloc();
+    }
+
+    auto result = totals{};
+    while (true)
+    {
+        auto const count = read_fully(in.get(), buffer.get(), block);
+        if (count == 0) {
+            break;
+        }
+
+        auto timer = detail::stopwatch{};
+        detail::transform(lfsr, opts.dir,
+                buffer.get(), buffer.get() + count, buffer.get());
+        result.kernel += timer.seconds();
+        result.bytes  += count;
+
+        /* Only the last block can be short. It's written padded out to the
+           alignment, and the file is cut back to size afterwards. */
+        write_fully(out.get(), buffer.get(), round_up(count, page_size));
+        if (count != block) {
+            break;
+        }
+    }
+
+    if (::ftruncate(out.get(), static_cast<off_t>(result.bytes)) == -1) {
+        detail::throw_system_error(opts.output);
+    }
+    return result;
+}
+
+
+auto parse_options(int argc, char const * const * argv) -> options
+{
+    auto args = detail::arguments{argc, argv, {"hugepages", "help"}};
+    if (args.flag("help") || args.positional_count() != 3) {
+        throw std::invalid_argument(usage);
+    }
+
+    return options{
+        .dir       = detail::parse_direction(args.positional(0)),
+        .input     = args.positional(1),
+        .output    = args.positional(2),
+        .taps      = lfsr::parse_taps(args.value("taps", "")),
+        .engine    = lfsr::parse_engine_kind(
+                args.value("engine", "fibonacci_bulk")),
+        .mode      = args.value("mode", "mmap"),
+        .window    = args.size("window", std::size_t{1} << 30),
+        .block     = args.size("block", std::size_t{4} << 20),
+        .hugepages = args.flag("hugepages"),
+        .offset    = args.size("offset", 0),
+        .length    = args.size("length", std::numeric_limits<std::uint64_t>::max()),
+    };
+}
+
+}
+
+
+
+auto main(int argc, char ** argv) -> int
+{
+    try
+    {
+        auto const opts = parse_options(argc, argv);
+        if (opts.mode != "mmap" && opts.mode != "direct") {
+            throw std::invalid_argument(std::format(
+                    "unknown mode '{}', expected mmap or direct", opts.mode));
+        }
+        auto const sliced = opts.offset != 0
+                || opts.length != std::numeric_limits<std::uint64_t>::max();
+        if (sliced && (opts.mode != "mmap"
+                || opts.dir != detail::direction::descramble)) {
+            throw std::invalid_argument("--offset and --length are only for "
+                    "descrambling in mmap mode");
+        }
+
+        auto result = totals{};
+        auto timer  = detail::stopwatch{};
+        lfsr::visit_engine(opts.taps, opts.engine, [&](auto & lfsr) {
+            result = opts.mode == "mmap"
+                    ? run_mmap(opts, lfsr)
+                    : run_direct(opts, lfsr);
+        });
+        auto const elapsed = timer.seconds();
+
+        std::cerr << std::format("{} ({}, {}): total {}, kernel {}\n",
+                opts.dir == detail::direction::scramble
+                        ? "scrambled" : "descrambled",
+                lfsr::to_string(opts.engine),
+                opts.mode,
+                detail::format_throughput(result.bytes, elapsed),
+                detail::format_throughput(result.bytes, result.kernel));
+    }
+    catch (std::exception const & e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,600 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <lfsr_tap_list.hpp>
+
+namespace lfsr::gf2 {
+
+
+/* Polynomial arithmetic over GF(2), for checking that a set of taps is
+   maximal length without clocking the register through its period.
+
+   An LFSR's sequence is maximal length exactly when its feedback polynomial
+   is primitive, that is when x has order 2^n - 1 modulo the polynomial. That
+   holds when x^(2^n - 1) = 1, and x^((2^n - 1) / q) != 1 for every prime q
+   dividing 2^n - 1. Each power is a few hundred shifts and XORs, so the cost
+   is dominated by factoring 2^n - 1; it is split into its algebraic
+   (cyclotomic) factors first, which are small enough for Pollard's rho.
+
+   Everything is `constexpr`, so that a tap list can be checked with a
+   `static_assert`:
+
+     static_assert(lfsr::is_primitive_v<lfsr::tap_list<0, 17, 20>>);
+
+   A polynomial is held in a single unsigned word, which limits its degree to
+   the width of the word, so that 2^n - 1 fits in it too. `polynomial` goes
+   up to a degree of 64, and `wide_polynomial`, where the compiler has a 128
+   bit integer, up to 128. */
+
+#if defined(__SIZEOF_INT128__)
+#define LFSR_GF2_HAVE_INT128 1
+using uint128 = unsigned __int128;
+#endif
+
+
+namespace detail {
+
+template <typename Word>
+constexpr auto word_bits = sizeof(Word) * 8;
+
+/* `std::bit_width` and `std::countr_zero`, which don't take 128 bit words */
+template <typename Word>
+constexpr auto bit_width(Word value) noexcept -> std::size_t
+{
+    if constexpr (word_bits<Word> > 64) {
+        auto const high = static_cast<std::uint64_t>(value >> 64);
+        return high != 0
+                ? 64 + std::bit_width(high)
+                : std::bit_width(static_cast<std::uint64_t>(value));
+    } else {
+        return std::bit_width(value);
+    }
+}
+
+template <typename Word>
+constexpr auto countr_zero(Word value) noexcept -> std::size_t
+{
+    if constexpr (word_bits<Word> > 64) {
+        auto const low = static_cast<std::uint64_t>(value);
+        return low != 0
+                ? std::countr_zero(low)
+                : 64 + std::countr_zero(static_cast<std::uint64_t>(value >> 64));
+    } else {
+        return std::countr_zero(value);
+    }
+}
+
+}
+
+
+/* A polynomial of `degree` over GF(2). The x^degree term is implied, and
+   `low` holds the coefficients of x^0 to x^(degree - 1) in bits 0 upwards. */
+template <typename Word>
+struct basic_polynomial
+{
+    using word_type = Word;
+
+    constexpr static auto max_degree = detail::word_bits<Word>;
+
+    std::size_t degree;
+    Word        low;
+
+    constexpr basic_polynomial(std::size_t degree, Word low)
+        : degree{degree}
+        , low{low & mask(degree)}
+    {
+        if (degree == 0 || degree > max_degree) {
+            throw std::invalid_argument("polynomial degree out of range");
+        }
+    }
+
+    /* The mask of the bits below x^degree, which is also 2^degree - 1 */
+    constexpr static auto mask(std::size_t degree) noexcept -> Word
+    {
+        return degree >= max_degree
+                ? ~Word{}
+                : (Word{1} << degree) - 1;
+    }
+
+    friend constexpr auto operator==(basic_polynomial const &,
+            basic_polynomial const &) -> bool = default;
+};
+
+using polynomial = basic_polynomial<std::uint64_t>;
+#if defined(LFSR_GF2_HAVE_INT128)
+using wide_polynomial = basic_polynomial<uint128>;
+#endif
+
+
+/* The feedback polynomial of a set of taps: x^t for each tap, plus 1 for the
+   input. The reciprocal would do just as well, as it has the same order. */
+template <typename Word = std::uint64_t, std::size_t N>
+constexpr auto from_taps(std::array<std::size_t, N> const & taps)
+    -> basic_polynomial<Word>
+{
+    auto degree = std::size_t{};
+    for (auto tap : taps) {
+        degree = tap > degree ? tap : degree;
+    }
+    auto low = Word{1};
+    for (auto tap : taps) {
+        if (tap != degree) {
+            low |= Word{1} << tap;
+        }
+    }
+    return basic_polynomial<Word>{degree, low};
+}
+
+
+/* a * b mod p, with a and b already reduced.
+
+   Everything is shifted up to the top of the word, so that the bits being
+   tested are always the top bit rather than at a variable position, which is
+   much cheaper with 128 bit words. Masks are used rather than branches, as
+   the bits are random. */
+template <typename Word>
+constexpr auto multiply_mod(Word a, Word b, basic_polynomial<Word> const & p)
+    noexcept -> Word
+{
+    constexpr auto top = detail::word_bits<Word> - 1;
+
+    auto const align = detail::word_bits<Word> - p.degree;
+    auto const width = detail::bit_width(b);
+    auto const low   = p.low << align;
+    a <<= align;
+    b = width == 0 ? b : b << (detail::word_bits<Word> - width);
+
+    auto result = Word{};
+    for (auto ii = std::size_t{}; ii != width; ++ii) {
+        auto const carry = result >> top;
+        auto const bit   = b >> top;
+        result = (result << 1) ^ (low & (Word{} - carry)) ^ (a & (Word{} - bit));
+        b <<= 1;
+    }
+    return result >> align;
+}
+
+
+/* x^exponent mod p */
+template <typename Word>
+constexpr auto pow_x_mod(Word exponent, basic_polynomial<Word> const & p)
+    noexcept -> Word
+{
+    /* x itself, reduced: for a degree of 1 that's the constant term */
+    auto base   = p.degree == 1 ? p.low : Word{2};
+    auto result = Word{1};
+    for (; exponent != 0; exponent >>= 1) {
+        if (exponent & 1) {
+            result = multiply_mod(result, base, p);
+        }
+        base = multiply_mod(base, base, p);
+    }
+    return result;
+}
+
+
+
+namespace detail {
+
+/* a * b mod m, for m below 2^(bits - 1) */
+template <typename Word>
+constexpr auto multiply_mod(Word a, Word b, Word m) noexcept -> Word
+{
+#if defined(LFSR_GF2_HAVE_INT128)
+    if constexpr (word_bits<Word> <= 64) {
+        return static_cast<Word>(static_cast<uint128>(a) * b % m);
+    }
+#endif
+    /* Double and add. With m below 2^(bits - 1) neither the doubling nor the
+       sum can overflow, and one subtraction reduces them. */
+    auto const add = [m](Word x, Word y) {
+        auto const sum = x + y;
+        return sum >= m ? sum - m : sum;
+    };
+    auto result = Word{};
+    for (a %= m; b != 0; b >>= 1) {
+        if (b & 1) {
+            result = add(result, a);
+        }
+        a = add(a, a);
+    }
+    return result;
+}
+
+template <typename Word>
+constexpr auto pow_mod(Word base, Word exponent, Word m) noexcept -> Word
+{
+    auto result = Word{1} % m;
+    for (base %= m; exponent != 0; exponent >>= 1) {
+        if (exponent & 1) {
+            result = multiply_mod(result, base, m);
+        }
+        base = multiply_mod(base, base, m);
+    }
+    return result;
+}
+
+template <typename Word>
+constexpr auto gcd(Word a, Word b) noexcept -> Word
+{
+    while (b != 0) {
+        auto const t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+/* Miller-Rabin. These bases make it exact below 2^64; above that it is a
+   probable prime test, wrong with a probability of at most 4^-20. */
+template <typename Word>
+constexpr auto is_prime(Word n) noexcept -> bool
+{
+    constexpr unsigned bases[] = {
+        2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+        71
+    };
+    constexpr auto base_count = word_bits<Word> <= 64 ? 12 : 20;
+
+    if (n < 2) {
+        return false;
+    }
+    for (auto b : bases) {
+        if (n % b == 0) {
+            return n == b;
+        }
+    }
+
+    auto const shift = countr_zero(Word{n - 1});
+    auto const odd   = (n - 1) >> shift;
+    for (auto ii = 0; ii != base_count; ++ii)
+    {
+        auto x = pow_mod(Word{bases[ii]}, odd, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        auto composite = true;
+        for (auto jj = std::size_t{1}; jj < shift && composite; ++jj) {
+            x = multiply_mod(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+#if defined(LFSR_GF2_HAVE_INT128)
+/* Montgomery multiplication modulo an odd n below 2^127, with R = 2^128.
+   Double and add takes a few hundred cycles per product at 128 bits, which
+   is too slow for Pollard's rho on 2^101 - 1; this is a handful of 64 bit
+   multiplies. */
+class montgomery
+{
+public:
+    constexpr explicit montgomery(uint128 n) noexcept
+        : m_n{n}
+    {
+        /* n^-1 mod 2^128 by Newton's iteration, each step doubling the
+           number of correct bits from the 3 that n * n = 1 mod 8 gives */
+        auto inverse = n;
+        for (auto ii = 0; ii != 6; ++ii) {
+            inverse *= 2 - n * inverse;
+        }
+        m_neg_inverse = -inverse;
+    }
+
+    /* a * b / R mod n */
+    constexpr auto multiply(uint128 a, uint128 b) const noexcept -> uint128
+    {
+        auto const [high, low] = wide_multiply(a, b);
+        auto const m = low * m_neg_inverse;
+        auto const result = high + wide_multiply(m, m_n).high + (low != 0);
+        return result >= m_n ? result - m_n : result;
+    }
+
+private:
+    struct wide
+    {
+        uint128 high;
+        uint128 low;
+    };
+
+    constexpr static auto wide_multiply(uint128 a, uint128 b) noexcept -> wide
+    {
+        auto const a0 = static_cast<std::uint64_t>(a);
+        auto const a1 = static_cast<std::uint64_t>(a >> 64);
+        auto const b0 = static_cast<std::uint64_t>(b);
+        auto const b1 = static_cast<std::uint64_t>(b >> 64);
+
+        auto const p00 = uint128{a0} * b0;
+        auto const p01 = uint128{a0} * b1;
+        auto const p10 = uint128{a1} * b0;
+        auto const p11 = uint128{a1} * b1;
+
+        auto const middle = (p00 >> 64) + static_cast<std::uint64_t>(p01)
+                          + static_cast<std::uint64_t>(p10);
+        return {
+            p11 + (p01 >> 64) + (p10 >> 64) + (middle >> 64),
+            (middle << 64) | static_cast<std::uint64_t>(p00),
+        };
+    }
+
+    uint128 m_n;
+    uint128 m_neg_inverse;
+};
+#endif
+
+
+/* A non-trivial factor of the odd composite `n`, by Pollard's rho with
+   Brent's cycle detection. The differences are multiplied together and only
+   checked with a gcd every `batch` steps, going back over the last batch if
+   that overshoots.
+
+   For 128 bit words the products are Montgomery products, which are the
+   ordinary products times R^-1. That is still a pseudo-random map, and R is
+   coprime to n, so the factors found are the same. */
+template <typename Word>
+constexpr auto find_factor(Word n) noexcept -> Word
+{
+    constexpr auto batch = 64;
+
+#if defined(LFSR_GF2_HAVE_INT128)
+    auto const multiply = [mont = montgomery{n}, n](Word a, Word b) {
+        if constexpr (word_bits<Word> > 64) {
+            return mont.multiply(a, b);
+        } else {
+            return multiply_mod(a, b, n);
+        }
+    };
+#else
+    auto const multiply = [n](Word a, Word b) {
+        return multiply_mod(a, b, n);
+    };
+#endif
+
+    for (auto c = Word{1};; ++c)
+    {
+        auto const f = [&](Word x) {
+            return (multiply(x, x) + c) % n;
+        };
+        auto const distance = [](Word x, Word y) {
+            return x > y ? x - y : y - x;
+        };
+
+        auto x = Word{2};
+        auto y = x;
+        auto saved = y;
+        auto d = Word{1};
+        for (auto length = std::size_t{1}; d == 1; length *= 2)
+        {
+            x = y;
+            for (auto done = std::size_t{}; done < length && d == 1;) {
+                saved = y;
+                auto product = Word{1};
+                for (auto ii = 0; ii != batch && done != length; ++ii, ++done) {
+                    y = f(y);
+                    product = multiply(product, distance(x, y));
+                }
+                d = gcd(product, n);
+            }
+        }
+
+        if (d == n) {
+            /* The batch went past the factor; step through it again */
+            y = saved;
+            do {
+                y = f(y);
+                d = gcd(distance(x, y), n);
+            } while (d == 1);
+        }
+        if (d != n) {
+            return d;
+        }
+    }
+}
+
+}
+
+
+
+/* The distinct prime factors of a number, in no particular order */
+template <typename Word>
+struct basic_factorisation
+{
+    std::array<Word, 64> primes = {};
+    std::size_t          count  = 0;
+
+    constexpr auto add(Word prime) noexcept -> void
+    {
+        for (auto ii = std::size_t{}; ii != count; ++ii) {
+            if (primes[ii] == prime) {
+                return;
+            }
+        }
+        primes[count++] = prime;
+    }
+
+    /* Adds the prime factors of `n` */
+    constexpr auto add_factors_of(Word n) noexcept -> void
+    {
+        for (auto p : {2u, 3u, 5u, 7u}) {
+            if (n % p == 0) {
+                add(p);
+                while (n % p == 0) {
+                    n /= p;
+                }
+            }
+        }
+        if (n == 1) {
+            return;
+        }
+        if (detail::is_prime(n)) {
+            add(n);
+            return;
+        }
+        auto const d = detail::find_factor(n);
+        add_factors_of(d);
+        add_factors_of(n / d);
+    }
+
+    constexpr auto begin() const noexcept { return primes.begin(); }
+    constexpr auto end()   const noexcept { return primes.begin() + count; }
+};
+
+using factorisation = basic_factorisation<std::uint64_t>;
+
+
+/* The prime factors of 2^n - 1.
+
+   2^n - 1 is the product of the cyclotomic values Phi_d(2) for each d
+   dividing n, and each of those is found by dividing 2^d - 1 by the values
+   for the divisors of d. They are much smaller than 2^n - 1 itself: the
+   largest for n <= 64 is 2^61 - 1, and for n <= 128 is 2^127 - 1, both of
+   which are prime. The hardest to split up to 128 is 2^101 - 1, whose
+   smallest factor is 13 digits long; that takes well under a second. */
+template <typename Word = std::uint64_t>
+constexpr auto mersenne_factors(std::size_t n) -> basic_factorisation<Word>
+{
+    using poly = basic_polynomial<Word>;
+
+    if (n == 0 || n > poly::max_degree) {
+        throw std::invalid_argument("exponent out of range");
+    }
+
+    auto cyclotomic = std::array<Word, poly::max_degree + 1>{};
+    auto result = basic_factorisation<Word>{};
+    for (auto d = std::size_t{1}; d <= n; ++d)
+    {
+        if (n % d != 0) {
+            continue;
+        }
+        auto value = poly::mask(d);
+        for (auto k = std::size_t{1}; k < d; ++k) {
+            if (d % k == 0) {
+                value /= cyclotomic[k];
+            }
+        }
+        cyclotomic[d] = value;
+        result.add_factors_of(value);
+    }
+    return result;
+}
+
+
+namespace detail {
+
+/* Whether x^(2^degree - 1) = 1 modulo `p`. When x is invertible (the constant
+   term is 1) that is the same as x^(2^degree) = x, which takes `degree`
+   squarings without the multiplications in between. Most polynomials fail
+   here, so it is most of the cost of a search. */
+template <typename Word>
+constexpr auto order_divides_full(basic_polynomial<Word> const & p) noexcept
+    -> bool
+{
+    if ((p.low & 1) == 0) {
+        return false;
+    }
+    auto const x = pow_x_mod(Word{1}, p);
+    auto power = x;
+    for (auto ii = std::size_t{}; ii != p.degree; ++ii) {
+        power = multiply_mod(power, power, p);
+    }
+    return power == x;
+}
+
+}
+
+
+/* The order of x modulo `p`, which is the period of the LFSR from any nonzero
+   state when `p` is irreducible, and 2^degree - 1 when it is primitive.
+
+   Returns 0 if x^(2^degree - 1) != 1. That can only happen for a reducible
+   polynomial, whose LFSR doesn't have a single period anyway: it depends on
+   the starting state.
+
+   The factors of 2^degree - 1 can be passed in when checking many
+   polynomials of the same degree. */
+template <typename Word>
+constexpr auto period(basic_polynomial<Word> const & p,
+                      basic_factorisation<Word> const & factors) -> Word
+{
+    if (!detail::order_divides_full(p)) {
+        return 0;
+    }
+
+    auto const full = basic_polynomial<Word>::mask(p.degree);
+
+    auto result = full;
+    for (auto q : factors) {
+        while (result % q == 0 && pow_x_mod(Word{result / q}, p) == 1) {
+            result /= q;
+        }
+    }
+    return result;
+}
+
+template <typename Word>
+constexpr auto period(basic_polynomial<Word> const & p) -> Word
+{
+    return period(p, mersenne_factors<Word>(p.degree));
+}
+
+
+/* Whether `p` is primitive, i.e. its LFSR is maximal length */
+template <typename Word>
+constexpr auto is_primitive(basic_polynomial<Word> const & p,
+                            basic_factorisation<Word> const & factors) -> bool
+{
+    if (!detail::order_divides_full(p)) {
+        return false;
+    }
+
+    auto const full = basic_polynomial<Word>::mask(p.degree);
+    for (auto q : factors) {
+        if (pow_x_mod(Word{full / q}, p) == 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Word>
+constexpr auto is_primitive(basic_polynomial<Word> const & p) -> bool
+{
+    return is_primitive(p, mersenne_factors<Word>(p.degree));
+}
+
+}
+
+
+
+namespace lfsr {
+
+template <typename TapList>
+constexpr auto feedback_polynomial() -> gf2::polynomial
+{
+    static_assert(TapList::highest() <= gf2::polynomial::max_degree,
+            "GF(2) polynomials of tap lists are limited to a degree of 64");
+    return gf2::from_taps(TapList::values);
+}
+
+/* Whether an LFSR with the taps in `TapList` (a `tap_list`) is maximal
+   length */
+template <typename TapList>
+constexpr auto is_primitive_v =
+        gf2::is_primitive(feedback_polynomial<TapList>());
+
+/* The period of an LFSR with the taps in `TapList`; see `gf2::period` */
+template <typename TapList>
+constexpr auto period_v = gf2::period(feedback_polynomial<TapList>());
+
+}
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include <lfsr.hpp>
+#include <lfsr_gf2.hpp>
+
+namespace lfsr {
+
+
+/* Gold and Kasami sequences: the XOR of two free running LFSRs, as used for
+   spreading and scrambling codes.
+
+   Free running, a feedthrough scrambler fed zeroes outputs its own sequence,
+   so each register's state is that of a `feedthrough_fibonacci_word`; its
+   sequence is then worked out a word at a time by `detail::sequence_words`.
+   The sequence is bit 0 of the first word first, as everywhere else.
+
+   For a Gold code the two registers have the same degree and are a
+   "preferred pair"; each relative shift between them is another code of the
+   family (see `shift_second`). The small set of Kasami codes of degree n is
+   built the same way from an m-sequence of degree n and one of degree n / 2,
+   the first decimated by 2^(n / 2) + 1. */
+
+
+namespace detail {
+
+template <typename TapList>
+struct word_engine;
+
+template <std::size_t ... Taps>
+struct word_engine<tap_list<Taps...>>
+{
+    using type = basic_feedthrough_fibonacci_word<no_stats, Taps...>;
+};
+
+
+/* The characteristic polynomial of a free running register: a bit is the
+   sum of those t before it, for each tap t, so x^n = sum of x^(n - t). This
+   is the reciprocal of `gf2::from_taps`. */
+template <typename LFSR>
+constexpr auto characteristic_polynomial() -> gf2::polynomial
+{
+    constexpr auto degree = LFSR::degree;
+    auto low = std::uint64_t{};
+    for (auto tap : LFSR::traits::tap_list::values) {
+        low |= std::uint64_t{1} << (degree - tap);
+    }
+    return gf2::polynomial{degree, low};
+}
+
+
+/* Moves a free running register `steps` bits on, without clocking it.
+
+   With x^steps = sum of c_i x^i modulo the characteristic polynomial, the
+   bit `steps` after bit j is the sum of c_i times bit j + i. Taking j from
+   the oldest bit of the state, x^(steps + m) gives each bit of the new
+   state from the old one, which is a few hundred shifts and XORs at most,
+   whatever the number of steps. */
+template <typename LFSR>
+auto jump(LFSR & lfsr, std::uint64_t steps) noexcept -> void
+{
+    constexpr auto degree = LFSR::degree;
+    constexpr auto p = characteristic_polynomial<LFSR>();
+
+    /* The state with its oldest bit in bit 0 */
+    auto const state = lfsr.state();
+    auto window = std::uint64_t{};
+    for (auto ii = std::size_t{}; ii != degree; ++ii) {
+        window |= std::uint64_t{state.test(degree - 1 - ii)} << ii;
+    }
+
+    auto const x = gf2::pow_x_mod(std::uint64_t{1}, p);
+    auto power = gf2::pow_x_mod(steps, p);
+    auto result = std::bitset<degree>{};
+    for (auto m = std::size_t{}; m != degree; ++m) {
+        result.set(degree - 1 - m, std::popcount(power & window) & 1);
+        power = gf2::multiply_mod(power, x, p);
+    }
+    lfsr.set_state(result);
+}
+
+
+
+/* The sequence of a free running register, a word at a time.
+
+   The sequence satisfies its characteristic polynomial p, and so p^2, p^4
+   and so on too; as everything is mod 2, p^2^k is p with each tap t moved
+   to t * 2^k. Once the lowest tap is at least 64, no bit of a word depends
+   on another in the same word, and each word is just the XOR of a couple of
+   shifts of earlier words per tap. The last `depth` words are kept, the
+   most recent first; to start with, the word engine works them out, and
+   they are handed out before any more are. */
+template <typename TapList>
+class sequence_words
+{
+public:
+    using engine_type = typename word_engine<TapList>::type;
+
+    constexpr static auto degree = engine_type::degree;
+
+    explicit sequence_words(engine_type engine) noexcept
+    {
+        for (auto ii = depth; ii != 0; --ii) {
+            m_words[ii - 1] = engine.scramble_word(0);
+        }
+    }
+
+    auto next() noexcept -> std::uint64_t
+    {
+        if (m_pending != 0) [[unlikely]] {
+            return m_words[--m_pending];
+        }
+        return compute();
+    }
+
+    /* Words from the engine not yet handed out */
+    auto pending() const noexcept -> std::size_t
+    {
+        return m_pending;
+    }
+
+    /* The next word, once there are none pending */
+    auto compute() noexcept -> std::uint64_t
+    {
+        auto const word = [this]<std::size_t ... Indices>(
+                std::index_sequence<Indices...>) {
+            return (std::uint64_t{} ^ ... ^ lagged<
+                    engine_type::traits::tap_list::values[Indices] * scale>());
+        }(std::make_index_sequence<engine_type::traits::tap_list::values.size()>{});
+
+        for (auto ii = depth - 1; ii != 0; --ii) {
+            m_words[ii] = m_words[ii - 1];
+        }
+        m_words[0] = word;
+        return word;
+    }
+
+private:
+    constexpr static auto scale = [] {
+        auto result = std::size_t{1};
+        while (result * engine_type::traits::lowest_tap < 64) {
+            result *= 2;
+        }
+        return result;
+    }();
+
+    /* The oldest word read is the one before the highest tap's */
+    constexpr static auto depth = degree * scale / 64 + 1;
+
+    /* Bits i - lag of the next word: the word `lag / 64` back, shifted up,
+       and the one before it, shifted down */
+    template <std::size_t Lag>
+    auto lagged() const noexcept -> std::uint64_t
+    {
+        constexpr auto words = Lag / 64;
+        constexpr auto shift = Lag % 64;
+        if constexpr (shift == 0) {
+            return m_words[words - 1];
+        } else {
+            return (m_words[words - 1] << shift)
+                    | (m_words[words] >> (64 - shift));
+        }
+    }
+
+    std::array<std::uint64_t, depth> m_words;
+    std::size_t m_pending = depth;
+};
+
+}
+
+
+
+/* Two registers clocked in lockstep, each from its own initial state, and
+   their outputs XORed together. Both must have a degree of 64 or less.
+
+   Chips are worked out a word at a time by `detail::sequence_words`; those
+   taken a bit at a time come from a spare word. `seek` and `shift_second`
+   jump with the algebra in `detail::jump` rather than clocking the
+   registers, so moving to any index costs the same. */
+template <typename TapsA, typename TapsB>
+class gold_sequence
+{
+public:
+    using first_type  = typename detail::word_engine<TapsA>::type;
+    using second_type = typename detail::word_engine<TapsB>::type;
+
+    constexpr static auto first_degree  = first_type::degree;
+    constexpr static auto second_degree = second_type::degree;
+
+    /* Both registers start as all ones */
+    gold_sequence() noexcept
+        : m_first{m_initial_first}
+        , m_second{m_initial_second}
+    {
+    }
+
+    /* Initial states are as from the engines' `state()`: the `degree` bits
+       before the first chip, the most recent in bit 0 */
+    gold_sequence(std::bitset<first_degree> const & first,
+                  std::bitset<second_degree> const & second) noexcept
+        : m_initial_first{with_state<first_type>(first)}
+        , m_initial_second{with_state<second_type>(second)}
+        , m_first{m_initial_first}
+        , m_second{m_initial_second}
+    {
+    }
+
+    auto next_bit() noexcept -> bool
+    {
+        if (m_spare_bits == 0) {
+            m_spare = m_first.next() ^ m_second.next();
+            m_spare_bits = 64;
+        }
+        auto const result = m_spare & 1;
+        m_spare >>= 1;
+        --m_spare_bits;
+        ++m_index;
+        return result;
+    }
+
+    /* The next 64 chips, the first in bit 0 */
+    auto next_word() noexcept -> std::uint64_t
+    {
+        m_index += 64;
+        auto const word = m_first.next() ^ m_second.next();
+        if (m_spare_bits == 0) {
+            return word;
+        }
+        auto const result = m_spare | (word << m_spare_bits);
+        m_spare = word >> (64 - m_spare_bits);
+        return result;
+    }
+
+    auto generate(std::span<std::uint64_t> out) noexcept -> void
+    {
+        auto word = out.begin();
+        for (; word != out.end() && (m_first.pending() != 0
+                || m_second.pending() != 0); ++word) {
+            *word = next_word();
+        }
+
+        auto first = m_first;
+        auto second = m_second;
+        auto const count = static_cast<std::size_t>(out.end() - word);
+        if (m_spare_bits == 0) {
+            for (; word != out.end(); ++word) {
+                *word = first.compute() ^ second.compute();
+            }
+        }
+        else {
+            for (; word != out.end(); ++word) {
+                auto const next = first.compute() ^ second.compute();
+                *word = m_spare | (next << m_spare_bits);
+                m_spare = next >> (64 - m_spare_bits);
+            }
+        }
+        m_first = first;
+        m_second = second;
+        m_index += count * 64;
+    }
+
+    /* As above, a byte at a time; the bytes are the words in little endian
+       order, so this is bit 0 of the first byte first */
+    auto generate(std::span<std::uint8_t> out) noexcept -> void
+    {
+        auto const words = out.size() / 8;
+        auto bytes = out.data();
+        for (auto ii = std::size_t{}; ii != words; ++ii, bytes += 8) {
+            detail::store_le64(bytes, next_word());
+        }
+        for (; bytes != out.data() + out.size(); ++bytes)
+        {
+            auto byte = std::uint8_t{};
+            for (auto ii = 0u; ii != 8; ++ii) {
+                byte |= static_cast<std::uint8_t>(next_bit() << ii);
+            }
+            *bytes = byte;
+        }
+    }
+
+    /* The index of the next chip */
+    auto index() const noexcept -> std::uint64_t
+    {
+        return m_index;
+    }
+
+    /* Moves to chip `index` of the sequence, forwards or backwards */
+    auto seek(std::uint64_t index) noexcept -> void
+    {
+        auto first = m_initial_first;
+        auto second = m_initial_second;
+        detail::jump(first, index);
+        detail::jump(second, index);
+        m_first = words_type<TapsA>{first};
+        m_second = words_type<TapsB>{second};
+        m_spare_bits = 0;
+        m_index = index;
+    }
+
+    /* Skips `count` chips */
+    auto discard(std::uint64_t count) noexcept -> void
+    {
+        seek(m_index + count);
+    }
+
+    /* Moves the second register `steps` chips ahead of the first, giving
+       another code of the family, and goes back to the start */
+    auto shift_second(std::uint64_t steps) noexcept -> void
+    {
+        detail::jump(m_initial_second, steps);
+        seek(0);
+    }
+
+    /* A copy at chip `index`, for generating several phases of the same
+       code */
+    auto phase(std::uint64_t index) const noexcept -> gold_sequence
+    {
+        auto result = *this;
+        result.seek(index);
+        return result;
+    }
+
+private:
+    template <typename TapList>
+    using words_type = detail::sequence_words<TapList>;
+
+    template <typename LFSR>
+    static auto with_state(std::bitset<LFSR::degree> const & state) noexcept
+        -> LFSR
+    {
+        auto result = LFSR{};
+        result.set_state(state);
+        return result;
+    }
+
+    first_type          m_initial_first;
+    second_type         m_initial_second;
+    words_type<TapsA>   m_first;
+    words_type<TapsB>   m_second;
+    std::uint64_t       m_spare = 0;
+    unsigned            m_spare_bits = 0;
+    std::uint64_t       m_index = 0;
+};
+
+
+
+/* Generates `out.size() / generators.size()` words from each generator,
+   those of generator g from `out[g * words]` on, as for a bank of
+   correlators each with its own code phase (see `gold_sequence::phase`).
+
+   Each generator is one after another: a word takes a couple of dozen
+   independent shifts and XORs, which already keep the processor busy, so
+   interleaving them gains nothing. */
+template <typename TapsA, typename TapsB>
+auto generate_phases(std::span<gold_sequence<TapsA, TapsB>> generators,
+                     std::span<std::uint64_t> out) -> void
+{
+    if (generators.empty()) {
+        return;
+    }
+    if (out.size() % generators.size() != 0) {
+        throw std::invalid_argument(
+                "output must be a whole number of words per generator");
+    }
+
+    auto const words = out.size() / generators.size();
+    for (auto g = std::size_t{}; g != generators.size(); ++g) {
+        generators[g].generate(out.subspan(g * words, words));
+    }
+}
+
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <lfsr_detail.hpp>
+#include <lfsr_seek.hpp>
+
+namespace lfsr {
+
+
+/* Additive, frame synchronous scrambling, as in 802.11, where the register
+   is reseeded at the start of each frame and the frame is XORed with its
+   output. That output, the keystream, is what a feedthrough engine makes of
+   zeroes, so for a small degree the first `Bytes` of it can be worked out
+   for every seed up front, and a frame that fits is then scrambled with a
+   table lookup and an XOR rather than by clocking the register. Longer
+   frames carry on from the end of the table's row.
+
+   Seeds are as for the engines' `reset(seed)`. Scrambling and descrambling
+   are the same XOR. The table takes 2^degree * `Bytes` bytes: 16K for a
+   degree of 7 and 128 bytes a frame. */
+template <typename LFSR, std::size_t Bytes>
+class keystream_table
+{
+public:
+    constexpr static auto degree = LFSR::degree;
+    constexpr static auto seeds  = std::size_t{1} << degree;
+    constexpr static auto bytes  = Bytes;
+
+    static_assert(degree <= 16, "a table per seed is only for small degrees");
+    static_assert(Bytes >= history_bytes<LFSR>,
+            "the rows have to hold the register to carry on past them");
+
+    keystream_table()
+        : m_table(seeds * Bytes)
+    {
+        auto const zeroes = std::array<std::uint8_t, Bytes>{};
+        auto lfsr = LFSR{};
+        for (auto seed = std::size_t{}; seed != seeds; ++seed)
+        {
+            lfsr.reset(seed);
+            lfsr.scramble_range(zeroes.begin(), zeroes.end(),
+                    m_table.begin() + static_cast<std::ptrdiff_t>(seed * Bytes));
+        }
+    }
+
+    /* The first `Bytes` of the keystream from `seed` */
+    auto keystream(std::uint64_t seed) const -> std::span<std::uint8_t const, Bytes>
+    {
+        check_seed(seed);
+        return std::span<std::uint8_t const, Bytes>{
+                m_table.data() + seed * Bytes, Bytes};
+    }
+
+    /* XORs a frame from [first, last) into d_first, which may be first, with
+       the keystream from `seed` */
+    auto scramble(std::uint64_t seed, std::uint8_t const * first,
+                  std::uint8_t const * last, std::uint8_t * d_first) const
+        -> void
+    {
+        auto const row = keystream(seed);
+        auto const size = static_cast<std::size_t>(last - first);
+        auto const head = std::min(size, Bytes);
+        xor_bytes(first, row.data(), head, d_first);
+        if (size == head) {
+            return;
+        }
+
+        /* Past the row, the engine is put where it would be at its end, and
+           makes the rest of the keystream from zeroes */
+        auto lfsr = LFSR{};
+        synchronise(lfsr, row);
+        auto keystream = std::array<std::uint8_t, 256>{};
+        auto const zeroes = std::array<std::uint8_t, 256>{};
+        for (auto offset = head; offset != size; )
+        {
+            auto const count = std::min(keystream.size(), size - offset);
+            lfsr.scramble_range(zeroes.data(), zeroes.data() + count,
+                    keystream.data());
+            xor_bytes(first + offset, keystream.data(), count, d_first + offset);
+            offset += count;
+        }
+    }
+
+    auto descramble(std::uint64_t seed, std::uint8_t const * first,
+                    std::uint8_t const * last, std::uint8_t * d_first) const
+        -> void
+    {
+        scramble(seed, first, last, d_first);
+    }
+
+private:
+    auto check_seed(std::uint64_t seed) const -> void
+    {
+        if (seed >= seeds) {
+            throw std::out_of_range(std::format(
+                    "seed {} doesn't fit a register of degree {}", seed, degree));
+        }
+    }
+
+    /* A word at a time, which the compiler widens further */
+    static auto xor_bytes(std::uint8_t const * data, std::uint8_t const * key,
+                          std::size_t size, std::uint8_t * out) noexcept -> void
+    {
+        auto ii = std::size_t{};
+        for (; ii + 8 <= size; ii += 8) {
+            detail::store_le64(out + ii,
+                    detail::load_le64(data + ii) ^ detail::load_le64(key + ii));
+        }
+        for (; ii != size; ++ii) {
+            out[ii] = data[ii] ^ key[ii];
+        }
+    }
+
+    std::vector<std::uint8_t> m_table;
+};
+
+
+}
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lfsr {
+
+
+/* Lock free, bounded, single producer single consumer queue.
+
+   The head is only written by the consumer and the tail only by the producer,
+   each on its own cache line, so the two sides never contend for a line except
+   to read the other's index. When the queue is empty (or full) the waiting
+   side sleeps on the index with `std::atomic::wait` rather than spinning,
+   because in a pipeline that usually means it is waiting on I/O. */
+template <typename T>
+class spsc_ring
+{
+public:
+    /* The capacity is rounded up to a power of two */
+    explicit spsc_ring(std::size_t capacity)
+        : m_slots(std::bit_ceil(std::max<std::size_t>(capacity, 1)))
+        , m_mask{m_slots.size() - 1}
+    {
+    }
+
+    auto capacity() const noexcept -> std::size_t
+    {
+        return m_slots.size();
+    }
+
+    auto try_push(T value) -> bool
+    {
+        auto const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+            return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        m_tail.notify_one();
+        return true;
+    }
+
+    auto push(T value) -> void
+    {
+        auto const tail = m_tail.load(std::memory_order_relaxed);
+        auto head = m_head.load(std::memory_order_acquire);
+        while (tail - head == m_slots.size()) {
+            m_head.wait(head, std::memory_order_acquire);
+            head = m_head.load(std::memory_order_acquire);
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        m_tail.notify_one();
+    }
+
+    auto try_pop(T & value) -> bool
+    {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        m_head.notify_one();
+        return true;
+    }
+
+    auto pop() -> T
+    {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        auto tail = m_tail.load(std::memory_order_acquire);
+        while (head == tail) {
+            m_tail.wait(tail, std::memory_order_acquire);
+            tail = m_tail.load(std::memory_order_acquire);
+        }
+        auto value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        m_head.notify_one();
+        return value;
+    }
+
+private:
+    constexpr static auto cache_line = std::size_t{64};
+
+    std::vector<T> m_slots;
+    std::size_t    m_mask;
+
+    alignas(cache_line) std::atomic<std::size_t> m_head{0};
+    alignas(cache_line) std::atomic<std::size_t> m_tail{0};
+};
+
+
+
+struct pipeline_options
+{
+    /* Bytes handed between the stages at a time */
+    std::size_t block_size  = std::size_t{1} << 20;
+
+    /* Number of blocks in flight. With a depth of n, the reader can be up to
+       n - 1 blocks ahead of the writer. */
+    std::size_t queue_depth = 8;
+};
+
+
+/* Scrambles a stream in three stages, so that I/O and scrambling overlap:
+
+     reader thread -> [filled] -> scramble worker -> [scrambled] -> writer thread
+           ^                                                            |
+           +-------------------------- [free] <-------------------------+
+
+   The blocks are allocated once up front and cycle round the three rings, so
+   nothing is allocated or copied while running. The worker runs on the calling
+   thread and is the only thing that touches the LFSR, which keeps its state
+   between calls.
+
+   `read(data, capacity)` fills up to `capacity` bytes and returns how many it
+   read, 0 meaning the end of the stream. `write(data, size)` must write all of
+   it. If either throws, the stream is drained and the exception rethrown from
+   `scramble`/`descramble`. */
+template <typename LFSR>
+class pipeline
+{
+public:
+    explicit pipeline(LFSR lfsr = LFSR{}, pipeline_options options = {})
+        : m_lfsr{std::move(lfsr)}
+        , m_options{options}
+        , m_blocks(std::max<std::size_t>(options.queue_depth, 2))
+    {
+        for (auto & block : m_blocks) {
+            block.data = std::make_unique_for_overwrite<std::uint8_t[]>(
+                    m_options.block_size);
+        }
+    }
+
+    template <typename Read, typename Write>
+    auto scramble(Read && read, Write && write) -> std::uint64_t
+    {
+        return run(read, write, [this](block & b) {
+            m_lfsr.scramble_range(b.data.get(), b.data.get() + b.size,
+                    b.data.get());
+        });
+    }
+
+    template <typename Read, typename Write>
+    auto descramble(Read && read, Write && write) -> std::uint64_t
+    {
+        return run(read, write, [this](block & b) {
+            m_lfsr.descramble_range(b.data.get(), b.data.get() + b.size,
+                    b.data.get());
+        });
+    }
+
+    auto engine() noexcept -> LFSR &
+    {
+        return m_lfsr;
+    }
+
+    auto options() const noexcept -> pipeline_options const &
+    {
+        return m_options;
+    }
+
+private:
+    struct block
+    {
+        std::unique_ptr<std::uint8_t[]> data;
+        std::size_t                     size = 0;
+    };
+
+    /* A block with a size of zero marks the end of the stream */
+    template <typename Read, typename Write, typename Process>
+    auto run(Read & read, Write & write, Process process) -> std::uint64_t
+    {
+        auto const depth = m_blocks.size();
+        auto free      = spsc_ring<block *>{depth};
+        auto filled    = spsc_ring<block *>{depth};
+        auto scrambled = spsc_ring<block *>{depth};
+        for (auto & b : m_blocks) {
+            free.push(&b);
+        }
+
+        auto read_error   = std::exception_ptr{};
+        auto write_error  = std::exception_ptr{};
+        auto write_failed = std::atomic<bool>{false};
+
+        auto reader = std::jthread{[&] {
+            while (true)
+            {
+                auto * b = free.pop();
+                try {
+                    /* Stop reading once there's nowhere to write to */
+                    b->size = write_failed.load(std::memory_order_acquire)
+                            ? 0
+                            : read(b->data.get(), m_options.block_size);
+                } catch (...) {
+                    read_error = std::current_exception();
+                    b->size = 0;
+                }
+                auto const last = b->size == 0;
+                filled.push(b);
+                if (last) {
+                    return;
+                }
+            }
+        }};
+
+        auto writer = std::jthread{[&] {
+            while (true)
+            {
+                auto * b = scrambled.pop();
+                auto const last = b->size == 0;
+                if (!last && !write_error) {
+                    try {
+                        write(static_cast<std::uint8_t const *>(b->data.get()),
+                                b->size);
+                    } catch (...) {
+                        write_error = std::current_exception();
+                        write_failed.store(true, std::memory_order_release);
+                    }
+                }
+                free.push(b);
+                if (last) {
+                    return;
+                }
+            }
+        }};
+
+        auto total = std::uint64_t{};
+        while (true)
+        {
+            /* Once the block is pushed it belongs to the writer, and then the
+               reader, so nothing of it can be looked at afterwards. */
+            auto * b = filled.pop();
+            auto const size = b->size;
+            process(*b);
+            scrambled.push(b);
+            total += size;
+            if (size == 0) {
+                break;
+            }
+        }
+
+        reader.join();
+        writer.join();
+        if (read_error) {
+            std::rethrow_exception(read_error);
+        }
+        if (write_error) {
+            std::rethrow_exception(write_error);
+        }
+        return total;
+    }
+
+    LFSR               m_lfsr;
+    pipeline_options   m_options;
+    std::vector<block> m_blocks;
+};
+
+
+
+/* Scrambles frames into one stream in order of their sequence numbers, 0, 1,
+   2 and so on, as any number of threads finish them, in any order.
+
+   A submitted frame goes into a ring at its sequence number, and then the
+   submitting thread tries to take over draining it: whichever thread gets to
+   drain scrambles every consecutive frame that's ready, in place, and hands
+   each to the sink, `sink(sequence, frame)`, until it reaches a gap. Others
+   just leave their frame for it, so no thread ever waits on another to
+   scramble, and the sink is only called by one thread at a time. A thread
+   only waits if its frame is the capacity or more ahead of the next one due.
+
+   Handing over the draining is a flag, and the only race is a frame landing
+   just as the drainer gives up: it looks again after letting go, and the
+   flag and that look are sequentially consistent with the submitter's
+   store and its own go at the flag, so one of them sees the frame.
+
+   A frame has to stay valid until the sink has been called with it, and a
+   sequence number submitted once. If the sink throws, the exception comes
+   out of the `submit` that was draining, with that frame counted as done,
+   and any ready behind it wait for the next `submit` or `drain`. */
+template <typename LFSR, typename Sink>
+class sequencer
+{
+public:
+    /* The capacity is rounded up to a power of two */
+    sequencer(std::size_t capacity, Sink sink, LFSR lfsr = LFSR{})
+        : m_slots(std::bit_ceil(std::max<std::size_t>(capacity, 1)))
+        , m_mask{m_slots.size() - 1}
+        , m_sink{std::move(sink)}
+        , m_lfsr{std::move(lfsr)}
+    {
+    }
+
+    auto submit(std::uint64_t sequence, std::span<std::uint8_t> frame) -> void
+    {
+        auto next = m_next.load(std::memory_order_acquire);
+        if (sequence < next) {
+            throw std::invalid_argument("frame submitted after its turn");
+        }
+        while (sequence - next >= m_slots.size()) {
+            m_next.wait(next, std::memory_order_acquire);
+            next = m_next.load(std::memory_order_acquire);
+        }
+
+        auto & s = m_slots[sequence & m_mask];
+        s.frame = frame;
+        s.sequence.store(sequence, std::memory_order_seq_cst);
+        drain();
+    }
+
+    /* Scrambles whatever's ready, unless another thread is */
+    auto drain() -> void
+    {
+        while (!m_draining.exchange(true, std::memory_order_seq_cst))
+        {
+            auto next = m_next.load(std::memory_order_relaxed);
+            {
+                auto const release = draining_guard{m_draining};
+                for (auto * s = &m_slots[next & m_mask];
+                     s->sequence.load(std::memory_order_acquire) == next;
+                     s = &m_slots[next & m_mask])
+                {
+                    auto const frame = s->frame;
+                    m_lfsr.scramble_range(frame.data(),
+                            frame.data() + frame.size(), frame.data());
+                    auto const done = finished_guard{m_next, next + 1};
+                    m_sink(next, frame);
+                    ++next;
+                }
+            }
+
+            if (m_slots[next & m_mask].sequence.load(std::memory_order_seq_cst)
+                    != next) {
+                return;
+            }
+        }
+    }
+
+    /* Frames scrambled and handed to the sink so far */
+    auto completed() const noexcept -> std::uint64_t
+    {
+        return m_next.load(std::memory_order_acquire);
+    }
+
+    /* Waits until `count` frames have been */
+    auto wait(std::uint64_t count) const -> void
+    {
+        auto next = m_next.load(std::memory_order_acquire);
+        while (next < count) {
+            m_next.wait(next, std::memory_order_acquire);
+            next = m_next.load(std::memory_order_acquire);
+        }
+    }
+
+    /* Only while nothing's being submitted */
+    auto engine() noexcept -> LFSR &
+    {
+        return m_lfsr;
+    }
+
+private:
+    constexpr static auto cache_line = std::size_t{64};
+
+    struct alignas(cache_line) slot
+    {
+        std::atomic<std::uint64_t> sequence{~std::uint64_t{}};
+        std::span<std::uint8_t>    frame;
+    };
+
+    struct draining_guard
+    {
+        std::atomic<bool> & flag;
+
+        ~draining_guard()
+        {
+            flag.store(false, std::memory_order_seq_cst);
+        }
+    };
+
+    /* Frees the frame's slot and wakes any waiting for it, sink or no sink */
+    struct finished_guard
+    {
+        std::atomic<std::uint64_t> & next;
+        std::uint64_t                value;
+
+        ~finished_guard()
+        {
+            next.store(value, std::memory_order_release);
+            next.notify_all();
+        }
+    };
+
+    std::vector<slot> m_slots;
+    std::size_t       m_mask;
+    Sink              m_sink;
+    LFSR              m_lfsr;
+
+    alignas(cache_line) std::atomic<std::uint64_t> m_next{0};
+    alignas(cache_line) std::atomic<bool>          m_draining{false};
+};
+
+
+}
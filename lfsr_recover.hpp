@@ -0,0 +1,438 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <lfsr.hpp>
+#include <lfsr_dispatch.hpp>
+
+namespace lfsr {
+
+
+/* Recovering the taps and state of a scrambler from a capture of its output.
+
+   The scramblers here are self synchronising: the register holds the last
+   `degree` scrambled bits, y, and each scrambled bit is the input bit x XORed
+   with the register at the taps:
+
+     y[k] = x[k] ^ y[k - t1] ^ y[k - t2] ^ ...
+
+   Over a stretch where the input is all zeroes (an idle link, say), y is then
+   the output of a plain LFSR, and Berlekamp-Massey finds the shortest one
+   that produces it from 2 * degree bits, in O(n * degree / 64) word
+   operations (`recover_from_zeros`).
+
+   Where the input is known but not zero, y isn't an LFSR sequence (the
+   register holds scrambled bits, not the input), so the taps are instead
+   solved for as a linear system, y[k] ^ x[k] being the sum of the earlier y
+   at the taps. That's O(degree^3 / 64) word operations, which is still a
+   few milliseconds for a degree of 1000 or so (`recover_from_plaintext`).
+
+   Captures are bytes, with each byte's bits in the order the engines
+   process them, least significant first. */
+
+
+/* A scrambler recovered from a capture */
+struct recovered_lfsr
+{
+    /* Taps, in ascending order, without the 0 for the input */
+    std::vector<std::size_t> taps;
+
+    /* The last `degree()` scrambled bits of the capture, bit 0 of the first
+       word being the most recent, the same as `state()` */
+    std::vector<std::uint64_t> history;
+
+    auto degree() const noexcept -> std::size_t
+    {
+        return taps.empty() ? 0 : taps.back();
+    }
+
+    /* The history as a Fibonacci engine's `state()` */
+    template <std::size_t Degree>
+    auto state() const -> std::bitset<Degree>
+    {
+        check_degree(Degree);
+        auto result = std::bitset<Degree>{};
+        for (auto ii = std::size_t{}; ii != Degree; ++ii) {
+            result.set(ii, (history[ii / 64] >> (ii % 64)) & 1);
+        }
+        return result;
+    }
+
+    /* An engine in the state it would be in at the end of the capture, so
+       that it can carry on descrambling (or scrambling) where the capture
+       left off. Throws `std::invalid_argument` if the engine's taps differ. */
+    template <typename LFSR>
+    auto make_engine() const -> LFSR
+    {
+        using tap_list = typename LFSR::traits::tap_list;
+        if (detail::normalise_taps(tap_list::values) != taps) {
+            auto names = std::string{};
+            for (auto tap : taps) {
+                names += std::format("{}{}", names.empty() ? "" : ",", tap);
+            }
+            throw std::invalid_argument(std::format(
+                    "recovered taps {} don't match the engine's", names));
+        }
+        auto result = LFSR{};
+        synchronise(result);
+        return result;
+    }
+
+    /* Calls `func` with an engine of the given kind in the state it would be
+       in at the end of the capture, if the taps are among the
+       `prebuilt_tap_lists`; throws `std::invalid_argument` otherwise. */
+    template <typename Func>
+    auto visit_engine(engine_kind kind, Func && func) const -> void
+    {
+        lfsr::visit_engine(taps, kind, [&](auto & engine) {
+            synchronise(engine);
+            func(engine);
+        });
+    }
+
+private:
+    auto check_degree(std::size_t degree) const -> void
+    {
+        if (degree != this->degree()) {
+            throw std::invalid_argument(std::format("recovered degree is {}, "
+                    "not {}", this->degree(), degree));
+        }
+    }
+
+    /* Every engine's register depends only on the last `degree` scrambled
+       bits, so descrambling them, oldest first, brings any engine with the
+       same taps into the same state; this works for the Galois engine too,
+       whose state isn't the history itself */
+    template <typename LFSR>
+    auto synchronise(LFSR & lfsr) const -> void
+    {
+        for (auto ii = degree(); ii-- != 0;) {
+            lfsr.descramble_bit((history[ii / 64] >> (ii % 64)) & 1);
+        }
+    }
+};
+
+
+
+namespace detail {
+
+/* A fixed length vector of bits, packed into words */
+class bit_vector
+{
+public:
+    explicit bit_vector(std::size_t bits = 0)
+        : m_words((bits + 63) / 64 + 1)
+    {
+    }
+
+    auto test(std::size_t index) const noexcept -> bool
+    {
+        return (m_words[index / 64] >> (index % 64)) & 1;
+    }
+
+    auto flip(std::size_t index) noexcept -> void
+    {
+        m_words[index / 64] ^= std::uint64_t{1} << (index % 64);
+    }
+
+    /* The 64 bits from `index` upwards */
+    auto word_at(std::size_t index) const noexcept -> std::uint64_t
+    {
+        auto const word  = index / 64;
+        auto const shift = index % 64;
+        auto result = word < m_words.size() ? m_words[word] >> shift : 0;
+        if (shift != 0 && word + 1 < m_words.size()) {
+            result |= m_words[word + 1] << (64 - shift);
+        }
+        return result;
+    }
+
+    /* this ^= other << shift, for `count` bits of other */
+    auto xor_shifted(bit_vector const & other, std::size_t shift,
+                     std::size_t count) noexcept -> void
+    {
+        auto const word  = shift / 64;
+        auto const bits  = shift % 64;
+        auto const words = (count + 63) / 64;
+        for (auto ii = std::size_t{}; ii != words; ++ii)
+        {
+            auto const value = other.m_words[ii];
+            if (word + ii < m_words.size()) {
+                m_words[word + ii] ^= value << bits;
+            }
+            if (bits != 0 && word + ii + 1 < m_words.size()) {
+                m_words[word + ii + 1] ^= value >> (64 - bits);
+            }
+        }
+    }
+
+    /* Parity of this & (other >> offset), over the first `count` bits */
+    auto dot(bit_vector const & other, std::size_t offset,
+             std::size_t count) const noexcept -> bool
+    {
+        auto parity = std::uint64_t{};
+        for (auto ii = std::size_t{}; ii < count; ii += 64) {
+            auto value = m_words[ii / 64] & other.word_at(offset + ii);
+            if (count - ii < 64) {
+                value &= (std::uint64_t{1} << (count - ii)) - 1;
+            }
+            parity ^= value;
+        }
+        return std::popcount(parity) & 1;
+    }
+
+    auto words() const noexcept -> std::vector<std::uint64_t> const &
+    {
+        return m_words;
+    }
+
+    auto words() noexcept -> std::vector<std::uint64_t> &
+    {
+        return m_words;
+    }
+
+private:
+    std::vector<std::uint64_t> m_words;
+};
+
+
+/* The capture as bits, and reversed, so that the bits before a given one
+   read upwards from it */
+inline auto reversed_bits(std::span<std::uint8_t const> bytes) -> bit_vector
+{
+    auto const count = bytes.size() * 8;
+    auto result = bit_vector{count};
+    for (auto ii = std::size_t{}; ii != count; ++ii) {
+        if ((bytes[ii / 8] >> (ii % 8)) & 1) {
+            result.flip(count - 1 - ii);
+        }
+    }
+    return result;
+}
+
+
+/* The last `degree` bits of the capture, most recent first */
+inline auto history_of(std::span<std::uint8_t const> bytes,
+                       std::size_t degree) -> std::vector<std::uint64_t>
+{
+    auto const reversed = reversed_bits(bytes);
+    auto result = std::vector<std::uint64_t>((degree + 63) / 64);
+    for (auto ii = std::size_t{}; ii != result.size(); ++ii) {
+        result[ii] = reversed.word_at(ii * 64);
+    }
+    if (degree % 64 != 0) {
+        result.back() &= (std::uint64_t{1} << (degree % 64)) - 1;
+    }
+    return result;
+}
+
+
+inline auto make_recovered(std::span<std::uint8_t const> scrambled,
+                           std::vector<std::size_t> taps) -> recovered_lfsr
+{
+    if (taps.empty()) {
+        throw std::invalid_argument("the capture is all zeroes, or the "
+                "scrambler has no taps, so there is nothing to recover");
+    }
+    auto history = history_of(scrambled, taps.back());
+    return recovered_lfsr{std::move(taps), std::move(history)};
+}
+
+}
+
+
+
+/* The taps, in ascending order, of the shortest LFSR that generates the bits
+   of `bytes`, by Berlekamp-Massey. The result is only unique if the stream is
+   at least twice as long as the largest tap. */
+inline auto berlekamp_massey(std::span<std::uint8_t const> bytes)
+    -> std::vector<std::size_t>
+{
+    auto const count = bytes.size() * 8;
+
+    /* Reversed, so that the discrepancy at bit n is the parity of the
+       connection polynomial and the reversed bits from n downwards */
+    auto const reversed = detail::reversed_bits(bytes);
+
+    auto connection = detail::bit_vector{count};
+    auto previous   = detail::bit_vector{count};
+    connection.flip(0);
+    previous.flip(0);
+
+    auto length = std::size_t{};
+    auto previous_length = std::size_t{};
+    auto gap = std::size_t{1};
+    for (auto n = std::size_t{}; n != count; ++n)
+    {
+        if (!connection.dot(reversed, count - 1 - n, length + 1)) {
+            ++gap;
+            continue;
+        }
+        if (2 * length <= n) {
+            auto const saved = connection;
+            connection.xor_shifted(previous, gap, previous_length + 1);
+            previous_length = length;
+            length = n + 1 - length;
+            previous = saved;
+            gap = 1;
+        } else {
+            connection.xor_shifted(previous, gap, previous_length + 1);
+            ++gap;
+        }
+    }
+
+    auto result = std::vector<std::size_t>{};
+    for (auto t = std::size_t{1}; t <= length; ++t) {
+        if (connection.test(t)) {
+            result.push_back(t);
+        }
+    }
+    return result;
+}
+
+
+/* Recovers the scrambler from a capture of it scrambling zeroes. That needs
+   at least 2 * degree bits; with fewer, a shorter LFSR that happens to
+   produce the same bits is found instead, which can only be detected when
+   it's longer than half the capture. */
+inline auto recover_from_zeros(std::span<std::uint8_t const> scrambled)
+    -> recovered_lfsr
+{
+    auto taps = berlekamp_massey(scrambled);
+    if (!taps.empty() && 2 * taps.back() > scrambled.size() * 8) {
+        throw std::invalid_argument(std::format("a degree {} scrambler needs "
+                "at least {} bytes to recover", taps.back(),
+                (2 * taps.back() + 7) / 8));
+    }
+    return detail::make_recovered(scrambled, std::move(taps));
+}
+
+
+/* Recovers a scrambler of at most `max_degree` (by default half the length
+   of the capture) from a capture of it scrambling `plaintext`.
+
+   Each bit from `max_degree` onwards gives an equation, with a column for
+   each possible tap: y[k] ^ x[k] = sum of c[t] * y[k - t]. The columns are
+   added to an echelon basis one tap at a time, until the left hand side is
+   in their span, so the solution found is the one with the lowest degree. */
+inline auto recover_from_plaintext(std::span<std::uint8_t const> scrambled,
+                                   std::span<std::uint8_t const> plaintext,
+                                   std::size_t max_degree = 0)
+    -> recovered_lfsr
+{
+    if (scrambled.size() != plaintext.size()) {
+        throw std::invalid_argument("the capture and plaintext must be the "
+                "same length");
+    }
+
+    auto const count = scrambled.size() * 8;
+    if (max_degree == 0) {
+        max_degree = count / 2;
+    }
+    if (max_degree == 0 || 2 * max_degree > count) {
+        throw std::invalid_argument(std::format("a degree of up to {} needs "
+                "at least {} bytes to recover", max_degree,
+                (2 * max_degree + 7) / 8));
+    }
+
+    auto const bit = [](std::span<std::uint8_t const> bytes, std::size_t ii) {
+        return (bytes[ii / 8] >> (ii % 8)) & 1;
+    };
+
+    /* Row r is bit max_degree + r, so column t holds the scrambled bits from
+       max_degree - t onwards */
+    auto const rows = count - max_degree;
+    auto target = detail::bit_vector{rows};
+    auto scrambled_bits = detail::bit_vector{count};
+    for (auto ii = std::size_t{}; ii != count; ++ii) {
+        if (bit(scrambled, ii)) {
+            scrambled_bits.flip(ii);
+        }
+    }
+    for (auto r = std::size_t{}; r != rows; ++r) {
+        if (bit(scrambled, max_degree + r) ^ bit(plaintext, max_degree + r)) {
+            target.flip(r);
+        }
+    }
+
+    struct basis_vector
+    {
+        detail::bit_vector value;
+        detail::bit_vector taps;
+        std::size_t        pivot;
+    };
+
+    /* Reduces `value` (and its record of taps) by the basis */
+    auto basis = std::vector<basis_vector>{};
+    auto const reduce = [&](detail::bit_vector & value,
+                            detail::bit_vector & taps) {
+        for (auto const & b : basis) {
+            if (value.test(b.pivot)) {
+                value.xor_shifted(b.value, 0, rows);
+                taps.xor_shifted(b.taps, 0, max_degree + 1);
+            }
+        }
+    };
+    auto const first_set = [&](detail::bit_vector const & value) {
+        auto const & words = value.words();
+        for (auto ii = std::size_t{}; ii != words.size(); ++ii) {
+            if (words[ii] != 0) {
+                return ii * 64 + std::countr_zero(words[ii]);
+            }
+        }
+        return rows;
+    };
+
+    auto target_taps = detail::bit_vector{max_degree + 1};
+    for (auto t = std::size_t{1}; t <= max_degree; ++t)
+    {
+        auto column = detail::bit_vector{rows};
+        auto& words = column.words();
+        for (auto ii = std::size_t{}; ii * 64 < rows; ++ii) {
+            words[ii] = scrambled_bits.word_at(max_degree - t + ii * 64);
+        }
+        if (rows % 64 != 0) {
+            words[rows / 64] &= (std::uint64_t{1} << (rows % 64)) - 1;
+        }
+
+        auto column_taps = detail::bit_vector{max_degree + 1};
+        column_taps.flip(t);
+        reduce(column, column_taps);
+
+        auto const pivot = first_set(column);
+        if (pivot == rows) {
+            continue;
+        }
+        if (target.test(pivot)) {
+            target.xor_shifted(column, 0, rows);
+            target_taps.xor_shifted(column_taps, 0, max_degree + 1);
+        }
+        basis.push_back({std::move(column), std::move(column_taps), pivot});
+
+        if (first_set(target) == rows)
+        {
+            auto taps = std::vector<std::size_t>{};
+            for (auto ii = std::size_t{1}; ii <= max_degree; ++ii) {
+                if (target_taps.test(ii)) {
+                    taps.push_back(ii);
+                }
+            }
+            return detail::make_recovered(scrambled, std::move(taps));
+        }
+    }
+
+    throw std::invalid_argument(std::format("no scrambler of degree {} or "
+            "less produces this capture from this plaintext", max_degree));
+}
+
+
+}
@@ -0,0 +1,321 @@
+#include <lfsr_gf2.hpp>
+
+#include <tool_detail.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/* Searches for primitive polynomials of a given degree and number of terms,
+   and writes the best of them out as a header of `lfsr::tap_list`s.
+
+   Every polynomial x^n + x^a + ... + 1 with the given number of terms is
+   checked with `lfsr::gf2::is_primitive`, the candidates being shared out
+   between threads by their lowest middle tap. 2^n - 1 is factored once up
+   front.
+
+   The primitive ones are ranked by a rough model of the kernels' cost, per 64
+   bits of output:
+
+   * The lowest tap is the shortest distance between a bit and the bits it
+     depends on, so that many bits (up to a word) can be worked out at once
+     from the register alone. The bulk kernel needs at least 8 for a byte to
+     have no dependencies within itself.
+   * Each step reads every word of the register that holds a tap, and
+     combines each tap.
+
+   So the cost is ceil(64 / min(lowest tap, 64)) * (words + taps). Ties go to
+   the larger lowest tap. */
+
+namespace {
+
+constexpr auto usage =
+R"(usage: lfsr_search --degree <n> [options]
+
+  --degree <n>       Degree of the polynomials, 2 to 128 (64 without a 128
+                     bit integer type)
+  --weight <n>       Number of terms, including x^n and 1; odd, as every
+                     polynomial with an even number is divisible by x + 1
+                     (default 3, a trinomial)
+  --count <n>        Number of polynomials to write out (default 16)
+  --threads <n>      Threads to search with (default: one per core)
+  --output <file>    Write the header here rather than to stdout
+  --prefix <name>    Prefix for the aliases (default taps)
+)";
+
+
+struct options
+{
+    std::size_t degree;
+    std::size_t weight;
+    std::size_t count;
+    std::size_t threads;
+    std::string output;
+    std::string prefix;
+    std::string command_line;
+};
+
+
+/* A primitive polynomial's taps, highest first and without the 0 for the
+   input, and its predicted cost */
+struct candidate
+{
+    std::vector<std::size_t> taps;
+    std::size_t              lowest;
+    std::size_t              words;
+    std::size_t              cost;
+
+    explicit candidate(std::vector<std::size_t> taps_)
+        : taps{std::move(taps_)}
+    {
+        std::sort(taps.begin(), taps.end(), std::greater{});
+
+        lowest = taps.back();
+        auto word_list = std::vector<std::size_t>{};
+        for (auto t : taps) {
+            word_list.push_back((t - 1) / 64);
+        }
+        word_list.erase(std::unique(word_list.begin(), word_list.end()),
+                word_list.end());
+        words = word_list.size();
+
+        auto const parallel = std::min<std::size_t>(lowest, 64);
+        cost = (64 + parallel - 1) / parallel * (words + taps.size());
+    }
+
+    friend auto operator<(candidate const & a, candidate const & b) -> bool
+    {
+        if (a.cost != b.cost) {
+            return a.cost < b.cost;
+        }
+        if (a.lowest != b.lowest) {
+            return a.lowest > b.lowest;
+        }
+        return a.taps > b.taps;
+    }
+};
+
+
+/* Checks every polynomial with `middle` taps between 1 and degree - 1 */
+template <typename Word>
+class searcher
+{
+public:
+    explicit searcher(options const & opts)
+        : m_opts{opts}
+        , m_factors{lfsr::gf2::mersenne_factors<Word>(opts.degree)}
+    {
+    }
+
+    auto run() -> std::vector<candidate>
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto t = std::size_t{}; t != m_opts.threads; ++t) {
+            threads.emplace_back([this] { work(); });
+        }
+        threads.clear();
+
+        std::sort(m_found.begin(), m_found.end());
+        return std::move(m_found);
+    }
+
+    auto checked() const -> std::uint64_t
+    {
+        return m_checked;
+    }
+
+private:
+    auto work() -> void
+    {
+        auto const middle = m_opts.weight - 2;
+        auto found   = std::vector<candidate>{};
+        auto checked = std::uint64_t{};
+        auto taps    = std::vector<std::size_t>(middle);
+
+        /* Picks taps[index] onwards, each above the last */
+        auto const pick = [&](auto & self, std::size_t index) -> void {
+            if (index == middle) {
+                check(taps, found);
+                ++checked;
+                return;
+            }
+            for (auto t = taps[index - 1] + 1; t + (middle - index)
+                    <= m_opts.degree; ++t) {
+                taps[index] = t;
+                self(self, index + 1);
+            }
+        };
+
+        /* Lowest taps are handed out one at a time; the low ones have the
+           most candidates above them, so go first */
+        for (;;)
+        {
+            auto const first = m_next.fetch_add(1) + 1;
+            if (first + middle > m_opts.degree) {
+                break;
+            }
+            taps[0] = first;
+            pick(pick, 1);
+        }
+
+        auto lock = std::lock_guard{m_mutex};
+        m_found.insert(m_found.end(), found.begin(), found.end());
+        m_checked += checked;
+    }
+
+    auto check(std::vector<std::size_t> const & taps,
+               std::vector<candidate> & found) const -> void
+    {
+        auto low = Word{1};
+        for (auto t : taps) {
+            low |= Word{1} << t;
+        }
+        auto const p = lfsr::gf2::basic_polynomial<Word>{m_opts.degree, low};
+        if (lfsr::gf2::is_primitive(p, m_factors))
+        {
+            auto all = taps;
+            all.push_back(m_opts.degree);
+            found.emplace_back(std::move(all));
+        }
+    }
+
+    options                               m_opts;
+    lfsr::gf2::basic_factorisation<Word>  m_factors;
+    std::atomic<std::size_t>              m_next = 0;
+    std::mutex                            m_mutex;
+    std::vector<candidate>                m_found;
+    std::uint64_t                         m_checked = 0;
+};
+
+
+auto write_header(std::ostream & out, options const & opts,
+                  std::vector<candidate> const & found) -> void
+{
+    out << std::format("#pragma once\n\n#include <lfsr_tap_list.hpp>\n\n"
+            "/* Primitive polynomials of degree {} with {} terms, ranked by "
+            "predicted\n   kernel throughput. Generated by:\n\n     {}\n*/\n",
+            opts.degree, opts.weight, opts.command_line);
+
+    auto const count = std::min(opts.count, found.size());
+    for (auto ii = std::size_t{}; ii != count; ++ii)
+    {
+        auto const & c = found[ii];
+        auto polynomial = std::string{};
+        auto name = opts.prefix + "_0";
+        auto list = std::string{"0"};
+        for (auto t = c.taps.rbegin(); t != c.taps.rend(); ++t) {
+            name += std::format("_{}", *t);
+            list += std::format(", {}", *t);
+        }
+        for (auto t : c.taps) {
+            polynomial += std::format("x^{} + ", t);
+        }
+
+        out << std::format("\n/* {}1: lowest tap {}, {} word{}, cost {} */\n"
+                "using {} = lfsr::tap_list<{}>;\n", polynomial, c.lowest,
+                c.words, c.words == 1 ? "" : "s", c.cost, name, list);
+    }
+}
+
+
+auto parse_options(int argc, char const * const * argv) -> options
+{
+    auto args = detail::arguments{argc, argv, {"help"}};
+    if (args.flag("help") || args.positional_count() != 0
+            || !args.flag("degree")) {
+        throw std::invalid_argument(usage);
+    }
+
+    auto command_line = std::string{"lfsr_search"};
+    for (auto ii = 1; ii < argc; ++ii) {
+        command_line += std::string{" "} + argv[ii];
+    }
+
+    auto result = options{
+        .degree       = args.size("degree", 0),
+        .weight       = args.size("weight", 3),
+        .count        = args.size("count", 16),
+        .threads      = args.size("threads",
+                std::max(1u, std::thread::hardware_concurrency())),
+        .output       = args.value("output", ""),
+        .prefix       = args.value("prefix", "taps"),
+        .command_line = command_line,
+    };
+
+#if defined(LFSR_GF2_HAVE_INT128)
+    auto const max_degree = lfsr::gf2::wide_polynomial::max_degree;
+#else
+    auto const max_degree = lfsr::gf2::polynomial::max_degree;
+#endif
+    if (result.degree < 2 || result.degree > max_degree) {
+        throw std::invalid_argument(std::format(
+                "degree must be between 2 and {}", max_degree));
+    }
+    if (result.weight < 3 || result.weight % 2 == 0
+            || result.weight > result.degree + 1) {
+        throw std::invalid_argument(std::format("weight must be odd, and "
+                "between 3 and {}", result.degree + 1));
+    }
+    if (result.threads == 0) {
+        throw std::invalid_argument("threads must be at least 1");
+    }
+    return result;
+}
+
+
+template <typename Word>
+auto search(options const & opts) -> void
+{
+    auto timer = detail::stopwatch{};
+    auto s = searcher<Word>{opts};
+    auto const found = s.run();
+
+    std::cerr << std::format("checked {} polynomials, {} primitive, in "
+            "{:.2f} s on {} threads\n", s.checked(), found.size(),
+            timer.seconds(), opts.threads);
+
+    if (opts.output.empty()) {
+        write_header(std::cout, opts, found);
+        return;
+    }
+    auto out = std::ofstream{opts.output};
+    write_header(out, opts, found);
+    if (!out) {
+        throw std::runtime_error(std::format(
+                "failed to write '{}'", opts.output));
+    }
+}
+
+}
+
+
+
+auto main(int argc, char ** argv) -> int
+{
+    try
+    {
+        auto const opts = parse_options(argc, argv);
+        if (opts.degree <= lfsr::gf2::polynomial::max_degree) {
+            search<std::uint64_t>(opts);
+        } else {
+#if defined(LFSR_GF2_HAVE_INT128)
+            search<lfsr::gf2::uint128>(opts);
+#endif
+        }
+    }
+    catch (std::exception const & e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
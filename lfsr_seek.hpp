@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+
+namespace lfsr {
+
+
+/* Descrambling from anywhere in a scrambled stream.
+
+   The scramblers here are self synchronising: each one's register is a
+   function of the last `degree` scrambled bits alone (for the Fibonacci
+   engines, it's those bits), whichever way it's going. So the state at any
+   offset into a stored stream is already in the stream, just before it, and
+   descrambling from there needs the `history_bytes` before it put through
+   the descrambler first, whatever state it was in, rather than everything
+   from the start. The stream is its own checkpoint index, at every byte, and
+   costs nothing to write. Only the first `history_bytes` depend on the
+   initial state, and for those the engine has to start from it. */
+
+
+/* Scrambled bytes that determine the state of `LFSR` */
+template <typename LFSR>
+constexpr auto history_bytes = (LFSR::degree + 7) / 8;
+
+
+/* Puts `lfsr` in the state it would have after `preceding`, the scrambled
+   bytes up to some point of a stream, of which only the last
+   `history_bytes` are read. With fewer than that, `preceding` must be the
+   start of the stream, and `lfsr` in its initial state. */
+template <typename LFSR>
+auto synchronise(LFSR & lfsr, std::span<std::uint8_t const> preceding) noexcept
+    -> void
+{
+    constexpr auto history = history_bytes<LFSR>;
+    auto const tail = preceding.last(std::min(history, preceding.size()));
+
+    /* The descrambled bytes aren't wanted, just the state */
+    auto discard = std::array<std::uint8_t, 256>{};
+    for (auto offset = std::size_t{}; offset != tail.size(); )
+    {
+        auto const size = std::min(discard.size(), tail.size() - offset);
+        lfsr.descramble_range(tail.data() + offset, tail.data() + offset + size,
+                discard.data());
+        offset += size;
+    }
+}
+
+
+/* Reads from anywhere in a scrambled stream held in memory, e.g. a file
+   mapped whole, each read costing `history_bytes` more than its size, or
+   nothing more where it carries on from the last */
+template <typename LFSR>
+class random_access_descrambler
+{
+public:
+    /* `initial` is the engine as it was at the start of the stream */
+    explicit random_access_descrambler(std::span<std::uint8_t const> scrambled,
+                                       LFSR const & initial = LFSR{})
+        : m_scrambled{scrambled}
+        , m_initial{initial}
+        , m_lfsr{initial}
+    {
+    }
+
+    auto size() const noexcept -> std::uint64_t
+    {
+        return m_scrambled.size();
+    }
+
+    /* Descrambles from `offset` into `out`, returning how much was read,
+       which is short only at the end. Throws `std::out_of_range` past it. */
+    auto read(std::uint64_t offset, std::span<std::uint8_t> out) -> std::size_t
+    {
+        if (offset > m_scrambled.size()) {
+            throw std::out_of_range(std::format(
+                    "offset {} is past the end of the stream, at {}",
+                    offset, m_scrambled.size()));
+        }
+        auto const start = static_cast<std::size_t>(offset);
+        if (start != m_position)
+        {
+            constexpr auto history = history_bytes<LFSR>;
+            if (start < history) {
+                m_lfsr = m_initial;
+            }
+            synchronise(m_lfsr, m_scrambled.first(start));
+        }
+
+        auto const count = std::min(out.size(), m_scrambled.size() - start);
+        auto const first = m_scrambled.data() + start;
+        m_lfsr.descramble_range(first, first + count, out.data());
+        m_position = start + count;
+        return count;
+    }
+
+private:
+    std::span<std::uint8_t const> m_scrambled;
+    LFSR                          m_initial;
+    LFSR                          m_lfsr;
+    std::size_t                   m_position = 0;
+};
+
+
+}
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define LFSR_STATS_HAVE_RDTSC 1
+#endif
+
+namespace lfsr {
+
+
+/* Statistics policies.
+
+   Each engine takes a policy type, which is told about every call made to it
+   through the public API. A policy provides:
+
+     constexpr static bool enabled;
+     static auto now() noexcept -> std::uint64_t;   // a timestamp, or 0
+     static auto record(stats_event const &) noexcept -> void;
+
+   `no_stats` is the default, and is disabled, in which case the engines don't
+   call it at all and nothing is added to the hot path. `counting_stats` keeps
+   counts per thread and adds them up on demand. */
+
+enum class stats_direction : std::uint8_t
+{
+    scramble,
+    descramble,
+};
+
+enum class stats_call : std::uint8_t
+{
+    bit,
+    byte,
+    range,
+    word,   /* `scramble_word` and `descramble_word`, 64 bits a call */
+};
+
+/* The implementation that did the work */
+enum class stats_kernel : std::uint8_t
+{
+    fibonacci,
+    galois,
+    fibonacci_bulk,
+    fibonacci_word,
+};
+
+constexpr auto stats_direction_count = std::size_t{2};
+constexpr auto stats_call_count      = std::size_t{4};
+constexpr auto stats_kernel_count    = std::size_t{4};
+
+
+struct stats_event
+{
+    stats_direction direction;
+    stats_call      call;
+    stats_kernel    kernel;
+    std::uint64_t   bits;
+    std::uint64_t   ticks;
+};
+
+
+
+struct no_stats
+{
+    constexpr static bool enabled = false;
+
+    static auto now() noexcept -> std::uint64_t
+    {
+        return 0;
+    }
+
+    static auto record(stats_event const &) noexcept -> void
+    {
+    }
+};
+
+
+
+/* Totals from a `counting_stats`, as added up by `snapshot()` */
+struct stats_snapshot
+{
+    using per_direction = std::array<std::uint64_t, stats_direction_count>;
+    using per_call      = std::array<per_direction, stats_call_count>;
+
+    per_direction bits  = {};
+    per_call      calls = {};
+    per_call      ticks = {};
+    std::array<std::uint64_t, stats_kernel_count> kernel_calls = {};
+
+    auto bytes(stats_direction dir) const noexcept -> std::uint64_t
+    {
+        return bits[static_cast<std::size_t>(dir)] / 8;
+    }
+
+    auto call_count(stats_direction dir, stats_call call) const noexcept
+        -> std::uint64_t
+    {
+        return calls[static_cast<std::size_t>(call)]
+                    [static_cast<std::size_t>(dir)];
+    }
+
+    auto call_ticks(stats_direction dir, stats_call call) const noexcept
+        -> std::uint64_t
+    {
+        return ticks[static_cast<std::size_t>(call)]
+                    [static_cast<std::size_t>(dir)];
+    }
+
+    auto kernel_count(stats_kernel kernel) const noexcept -> std::uint64_t
+    {
+        return kernel_calls[static_cast<std::size_t>(kernel)];
+    }
+};
+
+
+
+/* Counts every call, per thread.
+
+   Each thread takes its own slot the first time it records, and is then the
+   only writer to it, so the counters are bumped with a relaxed load and store
+   rather than a locked read-modify-write. The slots are cache line aligned so
+   that threads don't share lines. Threads beyond `MaxThreads` share a last
+   slot, which they update atomically.
+
+   `Tag` separates the counts of different users; every engine using the same
+   `counting_stats` type adds to the same counts. With `Ticks` each call is
+   also timed, with rdtsc where available, otherwise the steady clock in
+   nanoseconds. */
+template <typename Tag = void, bool Ticks = false, std::size_t MaxThreads = 64>
+class counting_stats
+{
+public:
+    constexpr static bool enabled = true;
+
+    static auto now() noexcept -> std::uint64_t
+    {
+        if constexpr (!Ticks) {
+            return 0;
+        }
+#if defined(LFSR_STATS_HAVE_RDTSC)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+#endif
+    }
+
+    static auto record(stats_event const & event) noexcept -> void
+    {
+        auto & s = this_thread_slot();
+        auto const dir  = static_cast<std::size_t>(event.direction);
+        auto const call = static_cast<std::size_t>(event.call);
+        auto const add  = &s == &slots().back() ? &add_shared : &add_owned;
+
+        add(s.bits[dir], event.bits);
+        add(s.calls[call][dir], 1);
+        add(s.kernels[static_cast<std::size_t>(event.kernel)], 1);
+        if constexpr (Ticks) {
+            add(s.ticks[call][dir], event.ticks);
+        }
+    }
+
+    /* Adds up every thread's counts. Counts being made at the same time may
+       or may not be included. */
+    static auto snapshot() noexcept -> stats_snapshot
+    {
+        auto result = stats_snapshot{};
+        for (auto const & s : slots())
+        {
+            for (auto dir = 0u; dir != stats_direction_count; ++dir) {
+                result.bits[dir] += load(s.bits[dir]);
+                for (auto call = 0u; call != stats_call_count; ++call) {
+                    result.calls[call][dir] += load(s.calls[call][dir]);
+                    result.ticks[call][dir] += load(s.ticks[call][dir]);
+                }
+            }
+            for (auto k = 0u; k != stats_kernel_count; ++k) {
+                result.kernel_calls[k] += load(s.kernels[k]);
+            }
+        }
+        return result;
+    }
+
+    /* Zeroes the counts. Only safe while no thread is recording. */
+    static auto reset() noexcept -> void
+    {
+        for (auto & s : slots())
+        {
+            for (auto dir = 0u; dir != stats_direction_count; ++dir) {
+                s.bits[dir].store(0, std::memory_order_relaxed);
+                for (auto call = 0u; call != stats_call_count; ++call) {
+                    s.calls[call][dir].store(0, std::memory_order_relaxed);
+                    s.ticks[call][dir].store(0, std::memory_order_relaxed);
+                }
+            }
+            for (auto & k : s.kernels) {
+                k.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    using counter = std::atomic<std::uint64_t>;
+
+    constexpr static auto cache_line = std::size_t{64};
+
+    struct alignas(cache_line) slot
+    {
+        std::array<counter, stats_direction_count> bits{};
+        std::array<std::array<counter, stats_direction_count>,
+                stats_call_count> calls{};
+        std::array<std::array<counter, stats_direction_count>,
+                stats_call_count> ticks{};
+        std::array<counter, stats_kernel_count> kernels{};
+    };
+
+    /* The last slot is the shared one */
+    static auto slots() noexcept -> std::array<slot, MaxThreads + 1> &
+    {
+        static auto result = std::array<slot, MaxThreads + 1>{};
+        return result;
+    }
+
+    static auto this_thread_slot() noexcept -> slot &
+    {
+        static auto next = std::atomic<std::size_t>{0};
+        thread_local auto & result = slots()[std::min(
+                next.fetch_add(1, std::memory_order_relaxed), MaxThreads)];
+        return result;
+    }
+
+    static auto add_owned(counter & c, std::uint64_t value) noexcept -> void
+    {
+        c.store(c.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+    }
+
+    static auto add_shared(counter & c, std::uint64_t value) noexcept -> void
+    {
+        c.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static auto load(counter const & c) noexcept -> std::uint64_t
+    {
+        return c.load(std::memory_order_relaxed);
+    }
+};
+
+
+
+namespace detail {
+
+/* Reports one call to the API to `Stats` when it goes out of scope. Empty,
+   and so free, when the policy is disabled. */
+template <typename Stats>
+class stats_scope
+{
+public:
+    stats_scope(stats_direction dir, stats_call call, stats_kernel kernel,
+                std::uint64_t bits = 0) noexcept
+        : m_event{dir, call, kernel, bits, Stats::now()}
+    {
+    }
+
+    stats_scope(stats_scope const &) = delete;
+    auto operator=(stats_scope const &) -> stats_scope & = delete;
+
+    ~stats_scope()
+    {
+        m_event.ticks = Stats::now() - m_event.ticks;
+        Stats::record(m_event);
+    }
+
+    auto add_bits(std::uint64_t bits) noexcept -> void
+    {
+        m_event.bits += bits;
+    }
+
+private:
+    stats_event m_event;
+};
+
+
+template <typename Stats>
+    requires (!Stats::enabled)
+class stats_scope<Stats>
+{
+public:
+    constexpr stats_scope(stats_direction, stats_call, stats_kernel,
+                          std::uint64_t = 0) noexcept
+    {
+    }
+
+    constexpr auto add_bits(std::uint64_t) noexcept -> void
+    {
+    }
+};
+
+}
+
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <streambuf>
+#include <utility>
+
+namespace lfsr {
+
+
+/* Stream buffers that scramble or descramble whatever goes through them to
+   or from another stream buffer, e.g. an `std::ofstream`'s:
+
+       auto file = std::ofstream{"out.bin", std::ios::binary};
+       auto buf = lfsr::scrambling_streambuf{*file.rdbuf(), engine};
+       auto out = std::ostream{&buf};
+
+   Writes collect in a buffer that is transformed in place, with the range
+   kernel, and passed on when it fills, on a flush, or on destruction. Writes
+   larger than the buffer skip collecting and are transformed straight from
+   the caller's memory. Reads fill the buffer from the other stream buffer
+   and transform it in place; reads larger than it go straight to the
+   caller's memory.
+
+   There's one engine, so a stream buffer should be written to or read from,
+   not both. The engine is copied in, and `engine()` is that copy. The other
+   stream buffer isn't owned, and has to outlive this one, which passes on
+   what's left when it's destroyed. Seeking isn't supported. */
+
+
+constexpr auto default_stream_buffer = std::size_t{1} << 16;
+
+
+namespace detail {
+
+template <typename LFSR, bool Scramble>
+class transform_streambuf : public std::streambuf
+{
+public:
+    explicit transform_streambuf(std::streambuf & other, LFSR lfsr = LFSR{},
+                                 std::size_t buffer_size = default_stream_buffer)
+        : m_other{&other}
+        , m_lfsr{std::move(lfsr)}
+        , m_size{std::max<std::size_t>(buffer_size, 1)}
+        , m_buffer{std::make_unique_for_overwrite<char[]>(m_size)}
+    {
+        setp(m_buffer.get(), m_buffer.get() + m_size);
+    }
+
+    transform_streambuf(transform_streambuf const &) = delete;
+    auto operator=(transform_streambuf const &) -> transform_streambuf & = delete;
+
+    ~transform_streambuf() override
+    {
+        flush_put_area();
+    }
+
+    auto engine() noexcept -> LFSR &
+    {
+        return m_lfsr;
+    }
+
+protected:
+    auto overflow(int_type ch) -> int_type override
+    {
+        if (!flush_put_area()) {
+            return traits_type::eof();
+        }
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+            return traits_type::not_eof(ch);
+        }
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+    auto sync() -> int override
+    {
+        if (!flush_put_area()) {
+            return -1;
+        }
+        return m_other->pubsync();
+    }
+
+    auto xsputn(char const * s, std::streamsize n) -> std::streamsize override
+    {
+        auto const total = n;
+        auto const room = static_cast<std::streamsize>(epptr() - pptr());
+        if (n < room) {
+            std::copy_n(s, n, pptr());
+            pbump(static_cast<int>(n));
+            return n;
+        }
+
+        /* Too much to collect: pass on what's collected, then transform
+           from `s` into the buffer a whole buffer at a time */
+        if (!flush_put_area()) {
+            return 0;
+        }
+        auto const size = static_cast<std::streamsize>(m_size);
+        for (; n >= size; n -= size, s += size)
+        {
+            transform(s, size, m_buffer.get());
+            if (m_other->sputn(m_buffer.get(), size) != size) {
+                return total - n;
+            }
+        }
+        std::copy_n(s, n, pptr());
+        pbump(static_cast<int>(n));
+        return total;
+    }
+
+    auto underflow() -> int_type override
+    {
+        auto const read = m_other->sgetn(m_buffer.get(),
+                static_cast<std::streamsize>(m_size));
+        if (read <= 0) {
+            return traits_type::eof();
+        }
+        transform(m_buffer.get(), read, m_buffer.get());
+        setg(m_buffer.get(), m_buffer.get(), m_buffer.get() + read);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    auto xsgetn(char * s, std::streamsize n) -> std::streamsize override
+    {
+        /* What's left in the get area first, then large reads go straight
+           into `s` and are transformed there */
+        auto const buffered = std::min(n,
+                static_cast<std::streamsize>(egptr() - gptr()));
+        std::copy_n(gptr(), buffered, s);
+        gbump(static_cast<int>(buffered));
+
+        auto done = buffered;
+        while (done != n)
+        {
+            if (n - done >= static_cast<std::streamsize>(m_size))
+            {
+                auto const read = m_other->sgetn(s + done, n - done);
+                if (read <= 0) {
+                    break;
+                }
+                transform(s + done, read, s + done);
+                done += read;
+            }
+            else
+            {
+                if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+                    break;
+                }
+                auto const count = std::min(n - done,
+                        static_cast<std::streamsize>(egptr() - gptr()));
+                std::copy_n(gptr(), count, s + done);
+                gbump(static_cast<int>(count));
+                done += count;
+            }
+        }
+        return done;
+    }
+
+private:
+    auto transform(char const * first, std::streamsize size, char * d_first)
+        noexcept -> void
+    {
+        auto const in = reinterpret_cast<std::uint8_t const *>(first);
+        auto const out = reinterpret_cast<std::uint8_t *>(d_first);
+        if constexpr (Scramble) {
+            m_lfsr.scramble_range(in, in + size, out);
+        } else {
+            m_lfsr.descramble_range(in, in + size, out);
+        }
+    }
+
+    /* Transforms and passes on the put area, emptying it either way */
+    auto flush_put_area() -> bool
+    {
+        auto const size = static_cast<std::streamsize>(pptr() - pbase());
+        setp(m_buffer.get(), m_buffer.get() + m_size);
+        if (size == 0) {
+            return true;
+        }
+        transform(m_buffer.get(), size, m_buffer.get());
+        return m_other->sputn(m_buffer.get(), size) == size;
+    }
+
+    std::streambuf *        m_other;
+    LFSR                    m_lfsr;
+    std::size_t             m_size;
+    std::unique_ptr<char[]> m_buffer;
+};
+
+}
+
+
+/* Scrambles what's written to it on the way to `other`, or what's read from
+   `other` on the way out */
+template <typename LFSR>
+class scrambling_streambuf final : public detail::transform_streambuf<LFSR, true>
+{
+public:
+    using detail::transform_streambuf<LFSR, true>::transform_streambuf;
+};
+
+/* As above, descrambling */
+template <typename LFSR>
+class descrambling_streambuf final : public detail::transform_streambuf<LFSR, false>
+{
+public:
+    using detail::transform_streambuf<LFSR, false>::transform_streambuf;
+};
+
+
+template <typename LFSR>
+scrambling_streambuf(std::streambuf &, LFSR, std::size_t = default_stream_buffer)
+    -> scrambling_streambuf<LFSR>;
+
+template <typename LFSR>
+descrambling_streambuf(std::streambuf &, LFSR, std::size_t = default_stream_buffer)
+    -> descrambling_streambuf<LFSR>;
+
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace lfsr {
+
+
+/* Range adaptors that scramble or descramble lazily, a block at a time:
+
+       for (auto byte : payload | lfsr::views::scramble(engine)
+                                | std::views::take(100)) ...
+
+   A block is pulled from the underlying range and put through the range
+   kernel when the view's iterated from, and then as each one is stepped
+   past, so stopping early costs at most one block more than was read. Where
+   the underlying range is contiguous bytes, the kernel reads it directly;
+   otherwise it's copied into the block first.
+
+   The views are input ranges, as they hold the engine and move it along:
+   they can be iterated once, and `begin()` called once. The engine is copied
+   in, unless it's given as `std::ref(engine)`, in which case that engine is
+   moved along instead. */
+
+
+/* Bytes per block: enough to amortise the kernel's setup, few enough to stay
+   in L1 with whatever the consumer does with them */
+constexpr auto view_block = std::size_t{4096};
+
+
+namespace detail {
+
+template <typename V>
+concept contiguous_bytes = std::ranges::contiguous_range<V>
+        && std::sized_sentinel_for<std::ranges::sentinel_t<V>,
+                                   std::ranges::iterator_t<V>>
+        && std::is_integral_v<std::ranges::range_value_t<V>>
+        && sizeof(std::ranges::range_value_t<V>) == 1;
+
+
+template <std::ranges::input_range V, typename LFSR, bool Scramble>
+    requires std::ranges::view<V>
+          && std::convertible_to<std::ranges::range_reference_t<V>, std::uint8_t>
+class block_transform_view
+    : public std::ranges::view_interface<block_transform_view<V, LFSR, Scramble>>
+{
+public:
+    /* The position in the block is kept here, rather than in the view, so
+       that it can stay in a register while the consumer writes bytes */
+    class iterator
+    {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type       = std::uint8_t;
+        using difference_type  = std::ptrdiff_t;
+
+        iterator() = default;
+
+        explicit iterator(block_transform_view * parent)
+            : m_parent{parent}
+        {
+            next_block();
+        }
+
+        auto operator*() const noexcept -> std::uint8_t
+        {
+            return *m_next;
+        }
+
+        auto operator++() -> iterator &
+        {
+            if (++m_next == m_last) {
+                next_block();
+            }
+            return *this;
+        }
+
+        auto operator++(int) -> void
+        {
+            ++*this;
+        }
+
+        friend auto operator==(iterator const & it, std::default_sentinel_t)
+            -> bool
+        {
+            return it.m_next == it.m_last;
+        }
+
+    private:
+        auto next_block() -> void
+        {
+            m_next = m_parent->m_buffer.get();
+            m_last = m_next + m_parent->fill();
+        }
+
+        block_transform_view * m_parent = nullptr;
+        std::uint8_t const *   m_next = nullptr;
+        std::uint8_t const *   m_last = nullptr;
+    };
+
+
+    block_transform_view(V base, LFSR lfsr)
+        : m_base{std::move(base)}
+        , m_lfsr{std::move(lfsr)}
+    {
+    }
+
+    auto begin() -> iterator
+    {
+        m_buffer = std::make_unique_for_overwrite<std::uint8_t[]>(view_block);
+        m_current = std::ranges::begin(m_base);
+        return iterator{this};
+    }
+
+    auto end() const noexcept -> std::default_sentinel_t
+    {
+        return std::default_sentinel;
+    }
+
+    auto size() requires std::ranges::sized_range<V>
+    {
+        return std::ranges::size(m_base);
+    }
+
+    auto base() const & -> V requires std::copy_constructible<V>
+    {
+        return m_base;
+    }
+
+private:
+    /* Pulls and transforms the next block, returning its size, which is
+       only zero at the end */
+    auto fill() -> std::size_t
+    {
+        auto & current = *m_current;
+        auto const last = std::ranges::end(m_base);
+        auto * const block = m_buffer.get();
+        auto size = std::size_t{};
+        if constexpr (contiguous_bytes<V>)
+        {
+            size = std::min(view_block, static_cast<std::size_t>(last - current));
+            auto const first = reinterpret_cast<std::uint8_t const *>(
+                    std::to_address(current));
+            transform(first, first + size, block);
+            current += static_cast<std::ranges::range_difference_t<V>>(size);
+        }
+        else
+        {
+            for (; size != view_block && current != last; ++size, ++current) {
+                block[size] = static_cast<std::uint8_t>(*current);
+            }
+            transform(block, block + size, block);
+        }
+        return size;
+    }
+
+    auto transform(std::uint8_t const * first, std::uint8_t const * last,
+                   std::uint8_t * d_first) noexcept -> void
+    {
+        std::unwrap_reference_t<LFSR> & lfsr = m_lfsr;
+        if constexpr (Scramble) {
+            lfsr.scramble_range(first, last, d_first);
+        } else {
+            lfsr.descramble_range(first, last, d_first);
+        }
+    }
+
+    V                                           m_base;
+    LFSR                                        m_lfsr;
+    std::unique_ptr<std::uint8_t[]>             m_buffer;
+    std::optional<std::ranges::iterator_t<V>>   m_current;
+};
+
+
+template <typename LFSR, bool Scramble>
+struct block_transform_closure
+{
+    template <std::ranges::viewable_range R>
+    auto operator()(R && range) const
+    {
+        return block_transform_view<std::views::all_t<R>, LFSR, Scramble>{
+                std::views::all(std::forward<R>(range)), lfsr};
+    }
+
+    template <std::ranges::viewable_range R>
+    friend auto operator|(R && range, block_transform_closure const & closure)
+    {
+        return closure(std::forward<R>(range));
+    }
+
+    LFSR lfsr;
+};
+
+}
+
+
+namespace views {
+
+/* `range | views::scramble(engine)`, or `views::scramble(engine)(range)` */
+template <typename LFSR>
+auto scramble(LFSR lfsr = LFSR{}) -> detail::block_transform_closure<LFSR, true>
+{
+    return {std::move(lfsr)};
+}
+
+/* As above, descrambling */
+template <typename LFSR>
+auto descramble(LFSR lfsr = LFSR{}) -> detail::block_transform_closure<LFSR, false>
+{
+    return {std::move(lfsr)};
+}
+
+}
+
+
+}
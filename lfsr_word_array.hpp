@@ -0,0 +1,297 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace lfsr {
+
+/* A fixed size set of bits stored in an array of 64 bit words.
+
+   This does the same job as `std::bitset`, with two differences that matter
+   for the LFSR kernels: every operation is `constexpr` (`std::bitset` isn't
+   until C++23), and the words themselves are accessible, so that a kernel can
+   operate on a word at a time and skip words that it knows are empty.
+
+   Bit 0 is the least significant bit of word 0. Bits in the last word above
+   `Bits` are always kept clear, so that shifts, counts and comparisons never
+   see stale values. Read as a number, it is a little-endian multi-word
+   unsigned integer, which is how periods of more than 64 bits are held.
+*/
+template <std::size_t Bits>
+struct word_array
+{
+    using word_type = std::uint64_t;
+
+    constexpr static auto bits       = Bits;
+    constexpr static auto word_bits  = std::size_t{64};
+    constexpr static auto word_count = (Bits + word_bits - 1) / word_bits;
+
+    /* Mask of the valid bits in the last word */
+    constexpr static auto last_word_mask = (Bits % word_bits) == 0
+            ? ~word_type{}
+            : (word_type{1} << (Bits % word_bits)) - 1;
+
+    std::array<word_type, word_count> words{};
+
+
+    constexpr auto test(std::size_t index) const noexcept -> bool
+    {
+        return (words[index / word_bits] >> (index % word_bits)) & 1;
+    }
+
+    constexpr auto set(std::size_t index, bool value = true) noexcept
+        -> word_array &
+    {
+        auto const bit = word_type{1} << (index % word_bits);
+        auto & word = words[index / word_bits];
+        word = value ? (word | bit) : (word & ~bit);
+        return *this;
+    }
+
+    constexpr auto set() noexcept -> word_array &
+    {
+        for (auto & word : words) {
+            word = ~word_type{};
+        }
+        words[word_count - 1] &= last_word_mask;
+        return *this;
+    }
+
+    constexpr auto reset() noexcept -> word_array &
+    {
+        for (auto & word : words) {
+            word = 0;
+        }
+        return *this;
+    }
+
+    constexpr auto flip(std::size_t index) noexcept -> word_array &
+    {
+        words[index / word_bits] ^= word_type{1} << (index % word_bits);
+        return *this;
+    }
+
+    /* XORs up to 64 bits of `value` into the array, starting at bit `index`.
+       Bits that would land beyond `Bits` are discarded. */
+    constexpr auto deposit(std::size_t index, word_type value) noexcept
+        -> word_array &
+    {
+        auto const word   = index / word_bits;
+        auto const offset = index % word_bits;
+
+        words[word] ^= value << offset;
+        if (offset != 0 && word + 1 < word_count) {
+            words[word + 1] ^= value >> (word_bits - offset);
+        }
+        words[word_count - 1] &= last_word_mask;
+        return *this;
+    }
+
+    constexpr auto count() const noexcept -> std::size_t
+    {
+        auto result = std::size_t{};
+        for (auto word : words) {
+            result += std::popcount(word);
+        }
+        return result;
+    }
+
+    /* Parity of the set bits, i.e. all bits XORed together. */
+    constexpr auto parity() const noexcept -> bool
+    {
+        auto folded = word_type{};
+        for (auto word : words) {
+            folded ^= word;
+        }
+        return std::popcount(folded) & 1;
+    }
+
+    constexpr auto any() const noexcept -> bool
+    {
+        for (auto word : words) {
+            if (word != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr auto none() const noexcept -> bool
+    {
+        return !any();
+    }
+
+    constexpr auto operator^=(word_array const & other) noexcept -> word_array &
+    {
+        for (auto ii = 0ull; ii != word_count; ++ii) {
+            words[ii] ^= other.words[ii];
+        }
+        return *this;
+    }
+
+    constexpr auto operator&=(word_array const & other) noexcept -> word_array &
+    {
+        for (auto ii = 0ull; ii != word_count; ++ii) {
+            words[ii] &= other.words[ii];
+        }
+        return *this;
+    }
+
+    constexpr auto operator|=(word_array const & other) noexcept -> word_array &
+    {
+        for (auto ii = 0ull; ii != word_count; ++ii) {
+            words[ii] |= other.words[ii];
+        }
+        return *this;
+    }
+
+    constexpr auto operator<<=(std::size_t shift) noexcept -> word_array &
+    {
+        auto const word_shift = shift / word_bits;
+        auto const bit_shift  = shift % word_bits;
+
+        for (auto ii = word_count; ii-- != 0; )
+        {
+            auto value = word_type{};
+            if (ii >= word_shift) {
+                value = words[ii - word_shift] << bit_shift;
+                if (bit_shift != 0 && ii > word_shift) {
+                    value |= words[ii - word_shift - 1]
+                            >> (word_bits - bit_shift);
+                }
+            }
+            words[ii] = value;
+        }
+        words[word_count - 1] &= last_word_mask;
+        return *this;
+    }
+
+    constexpr auto operator>>=(std::size_t shift) noexcept -> word_array &
+    {
+        auto const word_shift = shift / word_bits;
+        auto const bit_shift  = shift % word_bits;
+
+        for (auto ii = 0ull; ii != word_count; ++ii)
+        {
+            auto value = word_type{};
+            if (ii + word_shift < word_count) {
+                value = words[ii + word_shift] >> bit_shift;
+                if (bit_shift != 0 && ii + word_shift + 1 < word_count) {
+                    value |= words[ii + word_shift + 1]
+                            << (word_bits - bit_shift);
+                }
+            }
+            words[ii] = value;
+        }
+        return *this;
+    }
+
+    friend constexpr auto operator^(word_array lhs, word_array const & rhs)
+        noexcept -> word_array
+    {
+        return lhs ^= rhs;
+    }
+
+    friend constexpr auto operator&(word_array lhs, word_array const & rhs)
+        noexcept -> word_array
+    {
+        return lhs &= rhs;
+    }
+
+    friend constexpr auto operator|(word_array lhs, word_array const & rhs)
+        noexcept -> word_array
+    {
+        return lhs |= rhs;
+    }
+
+    friend constexpr auto operator<<(word_array lhs, std::size_t shift)
+        noexcept -> word_array
+    {
+        return lhs <<= shift;
+    }
+
+    friend constexpr auto operator>>(word_array lhs, std::size_t shift)
+        noexcept -> word_array
+    {
+        return lhs >>= shift;
+    }
+
+    friend constexpr auto operator==(word_array const &, word_array const &)
+        -> bool = default;
+
+
+    auto to_bitset() const -> std::bitset<Bits>
+    {
+        auto result = std::bitset<Bits>{};
+        for (auto ii = word_count; ii-- != 0; ) {
+            result <<= word_bits;
+            result |= std::bitset<Bits>{words[ii]};
+        }
+        return result;
+    }
+
+    static auto from_bitset(std::bitset<Bits> const & value) -> word_array
+    {
+        constexpr auto low_word = std::bitset<Bits>{~word_type{}};
+
+        auto result    = word_array{};
+        auto remaining = value;
+        for (auto & word : result.words) {
+            word = (remaining & low_word).to_ullong();
+            remaining >>= word_bits;
+        }
+        return result;
+    }
+};
+
+
+
+namespace detail {
+
+/* Calls `func` with a `std::integral_constant` for each index in [0, N), so
+   that the index can be used in `if constexpr`. This is how kernels unroll
+   over the words of a `word_array` while skipping the ones that are known to
+   be empty. */
+template <std::size_t N, typename Func>
+constexpr auto for_each_index(Func && func) -> void
+{
+    [&]<std::size_t ... Indices>(std::index_sequence<Indices...>) {
+        (func(std::integral_constant<std::size_t, Indices>{}), ...);
+    }(std::make_index_sequence<N>{});
+}
+
+/* Parity of `value & Mask`. The mask is a template argument so that its words
+   are immediates, and words of it that are empty are never read from `value`.
+   Since the parity of a whole is the parity of the XOR of its parts, the words
+   are folded together first and only a single popcount is needed. */
+template <auto Mask, std::size_t Bits>
+constexpr auto masked_parity(word_array<Bits> const & value) noexcept -> bool
+{
+    auto folded = typename word_array<Bits>::word_type{};
+    for_each_index<word_array<Bits>::word_count>([&](auto word) {
+        if constexpr (Mask.words[word] != 0) {
+            folded ^= value.words[word] & Mask.words[word];
+        }
+    });
+    return std::popcount(folded) & 1;
+}
+
+/* `value ^= Mask`, with the mask as a template argument so that words of it
+   that are empty are never touched. */
+template <auto Mask, std::size_t Bits>
+constexpr auto masked_xor(word_array<Bits> & value) noexcept -> void
+{
+    for_each_index<word_array<Bits>::word_count>([&](auto word) {
+        if constexpr (Mask.words[word] != 0) {
+            value.words[word] ^= Mask.words[word];
+        }
+    });
+}
+
+}
+
+}
@@ -32,6 +32,14 @@ using taps_0_21_22          = lfsr::tap_list<0, 21, 22>;
 using taps_0_18_23          = lfsr::tap_list<0, 18, 23>;
 using taps_0_17_20_22_23_24 = lfsr::tap_list<0, 17, 22, 23, 24>;
 
+/* Primitive trinomials above a degree of 64, which need a multi-word register.
+   Maximality can't be tested by clocking these through their period. */
+using taps_0_6_71           = lfsr::tap_list<0, 6, 71>;
+using taps_0_38_89          = lfsr::tap_list<0, 38, 89>;
+using taps_0_1_127          = lfsr::tap_list<0, 1, 127>;
+using taps_0_32_521         = lfsr::tap_list<0, 32, 521>;
+using taps_0_216_1279       = lfsr::tap_list<0, 216, 1279>;
+
 
 
 
@@ -163,6 +171,23 @@ using feedthrough_galois_from_list_t
 
 
 
+
+template <typename TapList>
+struct feedthrough_fibonacci_word_from_list;
+
+template <std::size_t ... Taps>
+struct feedthrough_fibonacci_word_from_list<lfsr::tap_list<Taps...>>
+{
+    using type = lfsr::feedthrough_fibonacci_word<Taps...>;
+};
+
+template <typename TapList>
+using feedthrough_fibonacci_word_from_list_t 
+    = typename feedthrough_fibonacci_word_from_list<TapList>::type;
+
+
+
+
 template <fixed_string BaseName>
 struct NameGenerator 
 {
@@ -1,12 +1,36 @@
 #include <lfsr.hpp>
-
+#include <lfsr_64b66b.hpp>
+#include <lfsr_c.h>
+#include <lfsr_cascade.hpp>
+#include <lfsr_crc.hpp>
+#include <lfsr_dispatch.hpp>
+#include <lfsr_gf2.hpp>
+#include <lfsr_gold.hpp>
+#include <lfsr_keystream.hpp>
+#include <lfsr_pipeline.hpp>
+#include <lfsr_recover.hpp>
+#include <lfsr_seek.hpp>
+#include <lfsr_stream.hpp>
+#include <lfsr_views.hpp>
+
+#include <bench_detail.hpp>
 #include <test_detail.hpp>
+#include <tool_detail.hpp>
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstring>
 #include <format>
+#include <list>
+#include <ranges>
 #include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <cmath>
+#include <thread>
+#include <type_traits>
 
 
 using tap_lists = ::testing::Types<
@@ -36,6 +60,15 @@ using tap_lists = ::testing::Types<
     >;
 
 
+using wide_tap_lists = ::testing::Types<
+        detail::taps_0_6_71,
+        detail::taps_0_38_89,
+        detail::taps_0_1_127,
+        detail::taps_0_32_521,
+        detail::taps_0_216_1279
+    >;
+
+
 
 
 template <typename TapList>
@@ -50,6 +83,14 @@ template <typename TapList>
 struct LFSRGalois : public testing::Test {};
 
 
+template <typename TapList>
+struct LFSRWide : public testing::Test {};
+
+
+template <typename TapList>
+struct LFSRFibonacciWord : public testing::Test {};
+
+
 
 TYPED_TEST_SUITE(LFSRFibonacciBulk, 
         tap_lists, 
@@ -64,27 +105,86 @@ TYPED_TEST_SUITE(LFSRGalois,
         tap_lists, 
         detail::NameGenerator<"feedthrough_galois">);
 
+TYPED_TEST_SUITE(LFSRWide,     
+        wide_tap_lists, 
+        detail::NameGenerator<"wide">);
+
+TYPED_TEST_SUITE(LFSRFibonacciWord,
+        tap_lists,
+        detail::NameGenerator<"feedthrough_fibonacci_word">);
+
 
 
-TYPED_TEST(LFSRFibonacciBulk, IsMaximalLength)
+/* Maximal length is checked algebraically, with `lfsr::is_primitive_v`, in
+   `LFSRPrimitive`. Here the engines are checked against the recurrence that
+   the taps stand for, for a few thousand bits. */
+constexpr auto reference_bits = std::size_t{4096};
+
+
+/* The bits out of a Fibonacci register scrambling zeroes from all ones,
+   straight from the recurrence: each is the sum of those t before it, for
+   each tap t */
+template <typename TapList>
+auto reference_sequence() -> std::vector<bool>
 {
-    using lfsr_type = detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>;
+    constexpr auto degree = TapList::highest();
+    auto result = std::vector<bool>(degree, true);
+    for (auto n = degree; n != degree + reference_bits; ++n)
+    {
+        auto bit = false;
+        for (auto tap : TapList::values) {
+            bit ^= tap != 0 && result[n - tap];
+        }
+        result.push_back(bit);
+    }
+    return {result.begin() + degree, result.end()};
+}
+
+
+/* The bits out of an engine scrambling zeroes, through its range kernel */
+template <typename LFSR>
+auto engine_sequence() -> std::vector<bool>
+{
+    auto lfsr = LFSR{};
+    auto const zeroes = std::vector<std::uint8_t>(reference_bits / 8);
+    auto bytes = std::vector<std::uint8_t>(zeroes.size());
+    lfsr.scramble_range(zeroes.begin(), zeroes.end(), bytes.begin());
+
+    auto result = std::vector<bool>{};
+    for (auto byte : bytes) {
+        for (auto ii = 0u; ii != 8; ++ii) {
+            result.push_back((byte >> ii) & 1);
+        }
+    }
+    return result;
+}
 
-    auto lfsr = lfsr_type{};
-    auto period = 0;
-    auto limit = lfsr_type::period * 2;
-    auto expected_period = lfsr_type::period;
-    auto expected_state = lfsr.state();
 
-    while (period++ < limit)
+/* A Galois register isn't a history, so its first `degree` bits differ from
+   the Fibonacci engines', but every one after is the sum of those t before
+   it, for each tap t */
+template <typename TapList>
+auto follows_recurrence(std::vector<bool> const & sequence) -> bool
+{
+    for (auto n = TapList::highest(); n != sequence.size(); ++n)
     {
-        lfsr.scramble_bit(0);
-        if (lfsr.state() == expected_state) {
-            break;
+        auto bit = false;
+        for (auto tap : TapList::values) {
+            bit ^= tap != 0 && sequence[n - tap];
+        }
+        if (bit != sequence[n]) {
+            return false;
         }
     }
+    return true;
+}
 
-    EXPECT_EQ(period, expected_period);
+
+TYPED_TEST(LFSRFibonacciBulk, MatchesReferenceSequence)
+{
+    EXPECT_EQ(engine_sequence<
+                detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>>(),
+            reference_sequence<TypeParam>());
 }
 
 
@@ -135,13 +235,37 @@ TYPED_TEST(LFSRFibonacciBulk, ScrambledDoesNotEqualInput)
 }
 
 
+TYPED_TEST(LFSRFibonacciBulk, ConstructedAtCompileTime)
+{
+    using lfsr_type = detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>;
+
+    static_assert(std::is_nothrow_default_constructible_v<lfsr_type>);
+
+    /* Each input bit depends on itself, in both directions. */
+    static_assert(lfsr_type::deps_scramble[0].test(lfsr_type::degree));
+    static_assert(lfsr_type::deps_descramble[7].test(lfsr_type::degree + 7));
+
+    constexpr auto lfsr = lfsr_type{};
+    EXPECT_TRUE(lfsr.state().all());
+}
+
+
+TYPED_TEST(LFSRFibonacciBulk, OnlyStoresState)
+{
+    using lfsr_type = detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>;
+    using state_words = lfsr::word_array<lfsr_type::degree>;
+
+    EXPECT_EQ(sizeof(lfsr_type), sizeof(state_words));
+}
+
+
 TYPED_TEST(LFSRFibonacciBulk, ScrambledResultIsSameAsNonBulk)
 {
     using lfsr_type      = detail::feedthrough_fibonacci_from_list_t<TypeParam>;
     using lfsr_bulk_type = detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>;
 
     auto scrambler      = lfsr_type{};
-    auto bulk_scrambler = lfsr_type{};
+    auto bulk_scrambler = lfsr_bulk_type{};
 
     auto to_scramble = std::vector<std::uint8_t>{
         0x00, 0x01, 0x02, 0x03,
@@ -157,25 +281,21 @@ TYPED_TEST(LFSRFibonacciBulk, ScrambledResultIsSameAsNonBulk)
 }
 
 
-TYPED_TEST(LFSRFibonacci, IsMaximalLength)
+TYPED_TEST(LFSRFibonacci, MatchesReferenceSequence)
 {
-    using lfsr_type = detail::feedthrough_fibonacci_from_list_t<TypeParam>;
+    EXPECT_EQ(engine_sequence<
+                detail::feedthrough_fibonacci_from_list_t<TypeParam>>(),
+            reference_sequence<TypeParam>());
+}
 
-    auto lfsr = lfsr_type{};
-    auto period = 0;
-    auto limit = lfsr_type::period * 2;
-    auto expected_period = lfsr_type::period;
-    auto expected_state = lfsr.state();
 
-    while (period++ < limit)
-    {
-        lfsr.scramble_bit(0);
-        if (lfsr.state() == expected_state) {
-            break;
-        }
-    }
 
-    EXPECT_EQ(period, expected_period);
+TYPED_TEST(LFSRFibonacci, OnlyStoresState)
+{
+    using lfsr_type = detail::feedthrough_fibonacci_from_list_t<TypeParam>;
+    using state_words = lfsr::word_array<lfsr_type::degree>;
+
+    EXPECT_EQ(sizeof(lfsr_type), sizeof(state_words));
 }
 
 
@@ -227,25 +347,20 @@ TYPED_TEST(LFSRFibonacci, ScrambledDoesNotEqualInput)
 
 
 
-TYPED_TEST(LFSRGalois, IsMaximalLength)
+TYPED_TEST(LFSRGalois, FollowsReferenceRecurrence)
 {
-    using lfsr_type = detail::feedthrough_galois_from_list_t<TypeParam>;
+    EXPECT_TRUE(follows_recurrence<TypeParam>(engine_sequence<
+            detail::feedthrough_galois_from_list_t<TypeParam>>()));
+}
 
-    auto lfsr = lfsr_type{};
-    auto period = 0;
-    auto limit = lfsr_type::period * 2;
-    auto expected_period = lfsr_type::period;
-    auto expected_state = lfsr.state();
 
-    while (period++ < limit)
-    {
-        lfsr.scramble_bit(0);
-        if (lfsr.state() == expected_state) {
-            break;
-        }
-    }
 
-    EXPECT_EQ(period, expected_period);
+TYPED_TEST(LFSRGalois, OnlyStoresState)
+{
+    using lfsr_type = detail::feedthrough_galois_from_list_t<TypeParam>;
+    using state_words = lfsr::word_array<lfsr_type::degree>;
+
+    EXPECT_EQ(sizeof(lfsr_type), sizeof(state_words));
 }
 
 
@@ -289,3 +404,1868 @@ TYPED_TEST(LFSRGalois, ScrambledDoesNotEqualInput)
             << std::format("0x{:02x} -> 0x{:02x}", b, scrambled);
     }
 }
+
+
+
+template <typename LFSR>
+auto scramble_then_descramble_bytes() -> void
+{
+    auto scrambler = LFSR{};
+    auto descrambler = LFSR{};
+
+    for (auto ii = 0; ii != 1024; ++ii) {
+        auto b = static_cast<std::uint8_t>(ii * 37);
+        auto scrambled = scrambler.scramble_byte(b);
+        auto descrambled = descrambler.descramble_byte(scrambled);
+        ASSERT_EQ(b, descrambled)
+            << std::format("0x{:02x} -> 0x{:02x} -> 0x{:02x}", b, scrambled, descrambled);
+    }
+}
+
+
+TYPED_TEST(LFSRWide, ScrambledThenDescrambledEqualsInput)
+{
+    scramble_then_descramble_bytes<
+            detail::feedthrough_fibonacci_from_list_t<TypeParam>>();
+    scramble_then_descramble_bytes<
+            detail::feedthrough_galois_from_list_t<TypeParam>>();
+    scramble_then_descramble_bytes<
+            detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>>();
+}
+
+
+TYPED_TEST(LFSRWide, MatchesReferenceSequence)
+{
+    auto const expected = reference_sequence<TypeParam>();
+    EXPECT_EQ(engine_sequence<
+                detail::feedthrough_fibonacci_from_list_t<TypeParam>>(),
+            expected);
+    EXPECT_EQ(engine_sequence<
+                detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>>(),
+            expected);
+    EXPECT_TRUE(follows_recurrence<TypeParam>(engine_sequence<
+            detail::feedthrough_galois_from_list_t<TypeParam>>()));
+}
+
+
+TYPED_TEST(LFSRWide, BulkMatchesNonBulk)
+{
+    using lfsr_type      = detail::feedthrough_fibonacci_from_list_t<TypeParam>;
+    using lfsr_bulk_type = detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>;
+
+    auto scrambler      = lfsr_type{};
+    auto bulk_scrambler = lfsr_bulk_type{};
+
+    /* The register is long enough that the output only starts to depend on
+       the initial state after `degree` bits, so run well past that. */
+    for (auto ii = 0; ii != 1024; ++ii) {
+        auto b = static_cast<std::uint8_t>(ii * 37);
+        auto scrambled      = scrambler.scramble_byte(b);
+        auto bulk_scrambled = bulk_scrambler.scramble_byte(b);
+        ASSERT_EQ(scrambled, bulk_scrambled)
+            << std::format("0x{:02x} (-> 0x{:02x}) (-> 0x{:02x})", b, scrambled, bulk_scrambled);
+    }
+
+    EXPECT_EQ(scrambler.state(), bulk_scrambler.state());
+}
+
+
+TYPED_TEST(LFSRWide, BulkBitsAndBytesCanBeMixed)
+{
+    using lfsr_type      = detail::feedthrough_fibonacci_from_list_t<TypeParam>;
+    using lfsr_bulk_type = detail::feedthrough_fibonacci_bulk_from_list_t<TypeParam>;
+
+    auto scrambler        = lfsr_type{};
+    auto bulk_scrambler   = lfsr_bulk_type{};
+    auto bulk_descrambler = lfsr_bulk_type{};
+
+    for (auto ii = 0; ii != 1024; ++ii) {
+        auto b = static_cast<std::uint8_t>(ii * 37);
+        if (ii % 3 == 0) {
+            auto scrambled = scrambler.scramble_bit(b & 1);
+            ASSERT_EQ(scrambled, bulk_scrambler.scramble_bit(b & 1));
+            ASSERT_EQ(b & 1, bulk_descrambler.descramble_bit(scrambled));
+        } else {
+            auto scrambled = scrambler.scramble_byte(b);
+            ASSERT_EQ(scrambled, bulk_scrambler.scramble_byte(b));
+            ASSERT_EQ(b, bulk_descrambler.descramble_byte(scrambled));
+        }
+        ASSERT_EQ(scrambler.state(), bulk_scrambler.state());
+    }
+}
+
+
+/* Scrambles and descrambles the same data with `LFSR` and the bit at a time
+   Fibonacci engine, through every call, and runs of every length up to a
+   few words so that ranges end at every point within a word */
+template <typename LFSR>
+auto matches_fibonacci() -> void
+{
+    using reference_type = detail::feedthrough_fibonacci_from_list_t<
+            typename LFSR::traits::tap_list>;
+
+    auto reference = reference_type{};
+    auto scrambler = LFSR{};
+    auto descrambler = LFSR{};
+    auto const input = random_payload(4096);
+    auto scrambled = std::vector<std::uint8_t>(input.size());
+    auto descrambled = std::vector<std::uint8_t>(input.size());
+
+    auto offset = std::size_t{};
+    for (auto length = std::size_t{}; offset + length <= input.size();
+            offset += length, ++length)
+    {
+        auto const first = input.begin() + offset;
+        auto const out = scrambled.begin() + offset;
+        auto const back = descrambled.begin() + offset;
+        if (length == 1)
+        {
+            /* A bit at a time one way, and a byte the other */
+            *out = 0;
+            for (auto bit = 0; bit != 8; ++bit) {
+                *out |= static_cast<std::uint8_t>(
+                        scrambler.scramble_bit((*first >> bit) & 1) << bit);
+            }
+            *back = descrambler.descramble_byte(*out);
+            continue;
+        }
+        scrambler.scramble_range(first, first + length, out);
+        descrambler.descramble_range(out, out + length, back);
+    }
+    auto const used = std::vector<std::uint8_t>(input.begin(),
+            input.begin() + static_cast<std::ptrdiff_t>(offset));
+    auto expected = std::vector<std::uint8_t>(offset);
+    reference.scramble_range(used.begin(), used.end(), expected.begin());
+    scrambled.resize(offset);
+    descrambled.resize(offset);
+
+    EXPECT_EQ(scrambled, expected);
+    EXPECT_EQ(descrambled, used);
+    EXPECT_EQ(scrambler.state(), reference.state());
+    EXPECT_EQ(descrambler.state(), reference.state());
+}
+
+
+TYPED_TEST(LFSRFibonacciWord, MatchesFibonacci)
+{
+    matches_fibonacci<detail::feedthrough_fibonacci_word_from_list_t<TypeParam>>();
+}
+
+
+TYPED_TEST(LFSRFibonacciWord, MatchesReferenceSequence)
+{
+    EXPECT_EQ(engine_sequence<
+                detail::feedthrough_fibonacci_word_from_list_t<TypeParam>>(),
+            reference_sequence<TypeParam>());
+}
+
+
+TYPED_TEST(LFSRFibonacciWord, WordsMatchBytes)
+{
+    using lfsr_type = detail::feedthrough_fibonacci_word_from_list_t<TypeParam>;
+
+    auto words = lfsr_type{};
+    auto bytes = lfsr_type{};
+    for (auto ii = std::uint64_t{}; ii != 256; ++ii)
+    {
+        auto const value = ii * 0x9e3779b97f4a7c15ull;
+        auto const scrambled = words.scramble_word(value);
+        for (auto b = 0u; b != 8; ++b) {
+            ASSERT_EQ(static_cast<std::uint8_t>(scrambled >> (8 * b)),
+                    bytes.scramble_byte(static_cast<std::uint8_t>(value >> (8 * b))));
+        }
+        ASSERT_EQ(words.state(), bytes.state());
+    }
+}
+
+
+TEST(LFSRFibonacciWord, UpToSixtyFourBits)
+{
+    matches_fibonacci<lfsr::feedthrough_fibonacci_word<0, 39, 58>>();
+    matches_fibonacci<lfsr::feedthrough_fibonacci_word<0, 62, 63>>();
+    matches_fibonacci<lfsr::feedthrough_fibonacci_word<0, 60, 61, 63, 64>>();
+    matches_fibonacci<lfsr::feedthrough_fibonacci_word<0, 1, 2>>();
+
+    /* Setting the state carries on from there */
+    auto reference = lfsr::feedthrough_fibonacci<0, 60, 61, 63, 64>{};
+    auto lfsr = lfsr::feedthrough_fibonacci_word<0, 60, 61, 63, 64>{};
+    for (auto ii = 0; ii != 100; ++ii) {
+        reference.scramble_byte(static_cast<std::uint8_t>(ii * 7));
+    }
+    lfsr.set_state(reference.state());
+    EXPECT_EQ(lfsr.state(), reference.state());
+    for (auto ii = 0; ii != 100; ++ii) {
+        ASSERT_EQ(lfsr.scramble_byte(ii), reference.scramble_byte(ii));
+    }
+}
+
+
+TEST(LFSRFibonacciWord, WritesIntoOtherContainers)
+{
+    /* Anything a byte converts to, as for the other engines, which a
+       contiguous output of some other value type mustn't take as bytes */
+    using lfsr_type = lfsr::feedthrough_fibonacci_word<0, 39, 58>;
+    auto const input = random_payload(1001);
+    auto expected = std::vector<std::uint8_t>(input.size());
+    lfsr_type{}.scramble_range(input.begin(), input.end(), expected.begin());
+
+    auto chars = std::string(input.size(), '\0');
+    lfsr_type{}.scramble_range(input.begin(), input.end(), chars.begin());
+    EXPECT_TRUE(std::ranges::equal(chars, expected, {},
+            [](char c) { return static_cast<std::uint8_t>(c); }));
+
+    auto words = std::vector<std::uint32_t>(input.size());
+    lfsr_type{}.scramble_range(input.data(), input.data() + input.size(),
+            words.data());
+    EXPECT_TRUE(std::ranges::equal(words, expected));
+
+    auto descrambled = std::vector<char>(input.size());
+    lfsr_type{}.descramble_range(expected.begin(), expected.end(),
+            descrambled.begin());
+    EXPECT_TRUE(std::ranges::equal(descrambled, input, {},
+            [](char c) { return static_cast<std::uint8_t>(c); }));
+}
+
+
+TEST(LFSRWide, PeriodDoesNotOverflow)
+{
+    using wide_type   = lfsr::feedthrough_galois<0, 1, 127>;
+    using narrow_type = lfsr::feedthrough_galois<0, 63, 64>;
+
+    EXPECT_EQ(wide_type::period.count(), 127);
+    EXPECT_EQ(narrow_type::period, ~std::uint64_t{});
+}
+
+
+
+template <typename TapList>
+struct LFSRPrimitive : public testing::Test {};
+
+TYPED_TEST_SUITE(LFSRPrimitive,
+        tap_lists,
+        detail::NameGenerator<"primitive">);
+
+
+/* Every test tap list is maximal length, checked at compile time rather than
+   by clocking the register through its period, and its period is the one
+   the engines are declared with */
+TYPED_TEST(LFSRPrimitive, IsPrimitive)
+{
+    using lfsr_type = detail::feedthrough_fibonacci_from_list_t<TypeParam>;
+
+    static_assert(lfsr::is_primitive_v<TypeParam>);
+    static_assert(lfsr::period_v<TypeParam> == lfsr_type::period);
+}
+
+
+template <typename ... TapLists>
+auto all_primitive() -> bool
+{
+    return (lfsr::gf2::is_primitive(lfsr::feedback_polynomial<TapLists>()) && ...);
+}
+
+
+TEST(GF2, BenchPolynomialsArePrimitive)
+{
+    EXPECT_TRUE((all_primitive<
+            Degree_5,  Degree_6,  Degree_7,  Degree_8,  Degree_9,  Degree_10,
+            Degree_11, Degree_12, Degree_13, Degree_14, Degree_15, Degree_16,
+            Degree_17, Degree_18, Degree_19, Degree_20, Degree_21, Degree_22,
+            Degree_23, Degree_24, Degree_25, Degree_26, Degree_27, Degree_28,
+            Degree_29, Degree_30, Degree_31, Degree_32, Degree_33, Degree_34,
+            Degree_35, Degree_36, Degree_37, Degree_38, Degree_39, Degree_40,
+            Degree_41, Degree_42, Degree_43, Degree_44, Degree_45, Degree_46,
+            Degree_47, Degree_48, Degree_49, Degree_50, Degree_51, Degree_52,
+            Degree_53, Degree_54, Degree_55, Degree_56, Degree_57, Degree_58,
+            Degree_59, Degree_60, Degree_61, Degree_62, Degree_63>()));
+
+    static_assert(lfsr::is_primitive_v<lfsr::tap_list<0, 60, 61, 63, 64>>);
+    static_assert(!lfsr::is_primitive_v<lfsr::tap_list<0, 63, 64>>);
+}
+
+
+TEST(GF2, NonPrimitivePolynomials)
+{
+    /* x^4 + x^3 + x^2 + x + 1 is irreducible, but x^5 = 1 */
+    auto const irreducible = lfsr::gf2::polynomial{4, 0b1111};
+    EXPECT_FALSE(lfsr::gf2::is_primitive(irreducible));
+    EXPECT_EQ(lfsr::gf2::period(irreducible), 5);
+
+    /* (x^2 + x + 1)^2, for which x has order 6, which doesn't divide 15 */
+    auto const square = lfsr::gf2::polynomial{4, 0b0101};
+    EXPECT_FALSE(lfsr::gf2::is_primitive(square));
+    EXPECT_EQ(lfsr::gf2::period(square), 0);
+
+    /* Divisible by x, so never returns to 1 */
+    EXPECT_FALSE(lfsr::gf2::is_primitive(lfsr::gf2::polynomial{8, 0b10}));
+
+    static_assert(!lfsr::is_primitive_v<lfsr::tap_list<0, 1, 2, 3, 4>>);
+    static_assert(lfsr::period_v<lfsr::tap_list<0, 1, 2, 3, 4>> == 5);
+}
+
+
+TEST(GF2, FactorsMersenneNumbers)
+{
+    auto const as_set = [](lfsr::gf2::factorisation const & f) {
+        return std::set<std::uint64_t>(f.begin(), f.end());
+    };
+
+    EXPECT_EQ(as_set(lfsr::gf2::mersenne_factors(12)),
+            (std::set<std::uint64_t>{3, 5, 7, 13}));
+    EXPECT_EQ(as_set(lfsr::gf2::mersenne_factors(59)),
+            (std::set<std::uint64_t>{179951, 3203431780337}));
+    EXPECT_EQ(as_set(lfsr::gf2::mersenne_factors(61)),
+            (std::set<std::uint64_t>{2305843009213693951}));
+    EXPECT_EQ(as_set(lfsr::gf2::mersenne_factors(64)),
+            (std::set<std::uint64_t>{3, 5, 17, 257, 641, 65537, 6700417}));
+    EXPECT_THROW(lfsr::gf2::mersenne_factors(65), std::invalid_argument);
+}
+
+
+#if defined(LFSR_GF2_HAVE_INT128)
+TEST(GF2, WidePolynomials)
+{
+    using lfsr::gf2::uint128;
+
+    auto const primitive = [](auto ... taps) {
+        return lfsr::gf2::is_primitive(lfsr::gf2::from_taps<uint128>(
+                std::array<std::size_t, sizeof...(taps)>{
+                    static_cast<std::size_t>(taps)...}));
+    };
+
+    EXPECT_TRUE(primitive(0, 6, 71));
+    EXPECT_TRUE(primitive(0, 38, 89));
+    EXPECT_TRUE(primitive(0, 1, 127));
+    EXPECT_FALSE(primitive(0, 2, 127));
+
+    /* 2^101 - 1 is the slowest to factor up to 128 */
+    auto const factors = lfsr::gf2::mersenne_factors<uint128>(101);
+    EXPECT_EQ(factors.count, 2);
+    EXPECT_EQ(factors.primes[0] * factors.primes[1],
+            (uint128{1} << 101) - 1);
+}
+#endif
+
+
+
+TEST(LFSRRecover, SetStateRoundTrips)
+{
+    auto fibonacci = lfsr::feedthrough_fibonacci<0, 17, 20>{};
+    auto galois    = lfsr::feedthrough_galois<0, 17, 20>{};
+    auto bulk      = lfsr::feedthrough_fibonacci_bulk<0, 17, 20>{};
+    auto const state = std::bitset<20>{0x5a5a5};
+
+    fibonacci.set_state(state);
+    galois.set_state(state);
+    bulk.set_state(state);
+    EXPECT_EQ(fibonacci.state(), state);
+    EXPECT_EQ(galois.state(), state);
+    EXPECT_EQ(bulk.state(), state);
+
+    /* The Fibonacci engines hold the same thing */
+    for (auto ii = 0; ii != 64; ++ii) {
+        ASSERT_EQ(fibonacci.scramble_byte(ii), bulk.scramble_byte(ii));
+    }
+}
+
+
+/* Scrambles some data, so the state isn't the initial one, then captures the
+   scrambler's output for `plaintext` */
+template <typename LFSR>
+auto capture_after_data(LFSR & scrambler,
+                        std::vector<std::uint8_t> const & plaintext)
+    -> std::vector<std::uint8_t>
+{
+    auto const data = random_payload(64, 2);
+    auto ignored = std::vector<std::uint8_t>(data.size());
+    scrambler.scramble_range(data.begin(), data.end(), ignored.begin());
+
+    auto result = std::vector<std::uint8_t>(plaintext.size());
+    scrambler.scramble_range(plaintext.begin(), plaintext.end(),
+            result.begin());
+    return result;
+}
+
+
+/* Whether `descrambler` carries on where `scrambler` left off */
+template <typename LFSR1, typename LFSR2>
+auto carries_on(LFSR1 & scrambler, LFSR2 & descrambler) -> bool
+{
+    auto const more = random_payload(256, 3);
+    for (auto b : more) {
+        if (descrambler.descramble_byte(scrambler.scramble_byte(b)) != b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+TEST(LFSRRecover, RecoversFromZeroes)
+{
+    auto scrambler = lfsr::feedthrough_fibonacci_bulk<0, 17, 20>{};
+    auto const capture = capture_after_data(scrambler,
+            std::vector<std::uint8_t>(5));
+
+    auto const recovered = lfsr::recover_from_zeros(capture);
+    EXPECT_EQ(recovered.taps, (std::vector<std::size_t>{17, 20}));
+    EXPECT_EQ(recovered.state<20>(), scrambler.state());
+
+    auto descrambler = recovered.make_engine<
+            lfsr::feedthrough_galois<0, 17, 20>>();
+    auto copy = scrambler;
+    EXPECT_TRUE(carries_on(copy, descrambler));
+
+    recovered.visit_engine(lfsr::engine_kind::fibonacci, [&](auto & engine) {
+        EXPECT_TRUE(carries_on(scrambler, engine));
+    });
+
+    EXPECT_THROW((recovered.make_engine<lfsr::feedthrough_galois<0, 3, 20>>()),
+            std::invalid_argument);
+    EXPECT_THROW(lfsr::recover_from_zeros(std::vector<std::uint8_t>(4)),
+            std::invalid_argument);
+}
+
+
+TEST(LFSRRecover, RecoversWideFromZeroes)
+{
+    auto scrambler = lfsr::feedthrough_galois<0, 1, 127>{};
+    auto const capture = capture_after_data(scrambler,
+            std::vector<std::uint8_t>(32));
+
+    auto const recovered = lfsr::recover_from_zeros(capture);
+    EXPECT_EQ(recovered.taps, (std::vector<std::size_t>{1, 127}));
+
+    auto descrambler = recovered.make_engine<
+            lfsr::feedthrough_fibonacci_bulk<0, 1, 127>>();
+    EXPECT_TRUE(carries_on(scrambler, descrambler));
+}
+
+
+TEST(LFSRRecover, RecoversFromPlaintext)
+{
+    auto scrambler = detail::feedthrough_fibonacci_from_list_t<Degree_31>{};
+    auto const plaintext = random_payload(16, 4);
+    auto const capture = capture_after_data(scrambler, plaintext);
+
+    auto const recovered = lfsr::recover_from_plaintext(capture, plaintext);
+    EXPECT_EQ(recovered.taps, (std::vector<std::size_t>{28, 29, 30, 31}));
+
+    auto descrambler = recovered.make_engine<
+            detail::feedthrough_galois_from_list_t<Degree_31>>();
+    EXPECT_TRUE(carries_on(scrambler, descrambler));
+
+    /* Not enough to rule out longer scramblers */
+    EXPECT_THROW(lfsr::recover_from_plaintext(capture, plaintext, 100),
+            std::invalid_argument);
+}
+
+
+auto random_blocks(std::size_t count, std::uint64_t seed)
+    -> std::vector<lfsr::block_66>
+{
+    auto const bytes = random_payload(count * 9, seed);
+    auto result = std::vector<lfsr::block_66>(count);
+    for (auto ii = std::size_t{}; ii != count; ++ii) {
+        result[ii].header = bytes[ii * 9] & 1 ? lfsr::sync_data : lfsr::sync_control;
+        std::memcpy(&result[ii].payload, bytes.data() + ii * 9 + 1, 8);
+    }
+    return result;
+}
+
+
+/* Packed a bit at a time, to check the codec's word at a time packing */
+auto pack_blocks(std::vector<lfsr::block_66> const & blocks)
+    -> std::vector<std::uint8_t>
+{
+    auto result = std::vector<std::uint8_t>(lfsr::packed_size_66(blocks.size()));
+    auto bit = std::size_t{};
+    auto const put = [&](bool value) {
+        result[bit / 8] |= static_cast<std::uint8_t>(value << (bit % 8));
+        ++bit;
+    };
+    for (auto const & block : blocks) {
+        put(block.header & 1);
+        put(block.header & 2);
+        for (auto ii = 0; ii != 64; ++ii) {
+            put((block.payload >> ii) & 1);
+        }
+    }
+    return result;
+}
+
+
+TEST(LFSR64b66b, ScramblesPayloadsOnly)
+{
+    auto const blocks = random_blocks(1000, 1);
+    auto scrambled = std::vector<lfsr::block_66>(blocks.size());
+    auto codec = lfsr::codec_64b66b{};
+    codec.scramble(blocks.begin(), blocks.end(), scrambled.begin());
+
+    /* The payloads are one continuous stream through the usual scrambler */
+    auto reference = lfsr::feedthrough_fibonacci<0, 39, 58>{};
+    for (auto ii = std::size_t{}; ii != blocks.size(); ++ii)
+    {
+        ASSERT_EQ(scrambled[ii].header, blocks[ii].header);
+        auto bytes = std::array<std::uint8_t, 8>{};
+        std::memcpy(bytes.data(), &blocks[ii].payload, 8);
+        reference.scramble_range(bytes.begin(), bytes.end(), bytes.begin());
+        auto expected = std::uint64_t{};
+        std::memcpy(&expected, bytes.data(), 8);
+        ASSERT_EQ(scrambled[ii].payload, expected) << "block " << ii;
+    }
+
+    auto descrambled = std::vector<lfsr::block_66>(blocks.size());
+    codec.descramble(scrambled.begin(), scrambled.end(), descrambled.begin());
+    EXPECT_EQ(descrambled, blocks);
+}
+
+
+TEST(LFSR64b66b, PackedMatchesUnpacked)
+{
+    /* Not a multiple of four, so the last byte is padded */
+    auto const blocks = random_blocks(1001, 2);
+    auto const packed = pack_blocks(blocks);
+    ASSERT_EQ(packed.size(), 8259u);
+
+    auto unpacked_codec = lfsr::codec_64b66b{};
+    auto scrambled = std::vector<lfsr::block_66>(blocks.size());
+    unpacked_codec.scramble(blocks.begin(), blocks.end(), scrambled.begin());
+    auto const expected = pack_blocks(scrambled);
+
+    /* Split where a block starts on a byte, and in place */
+    auto packed_codec = lfsr::codec_64b66b{};
+    auto buffer = packed;
+    packed_codec.scramble_packed(buffer.data(), 400, buffer.data());
+    packed_codec.scramble_packed(buffer.data() + lfsr::packed_size_66(400),
+            601, buffer.data() + lfsr::packed_size_66(400));
+    EXPECT_EQ(buffer, expected);
+
+    auto descrambled = std::vector<std::uint8_t>(packed.size());
+    packed_codec.descramble_packed(buffer.data(), blocks.size(),
+            descrambled.data());
+    EXPECT_EQ(descrambled, packed);
+    EXPECT_TRUE(packed_codec.locked());
+}
+
+
+TEST(LFSR64b66b, TracksBlockLock)
+{
+    auto lock = lfsr::block_lock{};
+
+    /* Unlocked, every invalid header is a slip */
+    EXPECT_TRUE(lock.observe(0b00));
+    EXPECT_TRUE(lock.observe(0b11));
+    EXPECT_EQ(lock.slips(), 2u);
+
+    for (auto ii = 0; ii != 63; ++ii) {
+        ASSERT_FALSE(lock.observe(lfsr::sync_data));
+    }
+    EXPECT_FALSE(lock.locked());
+    lock.observe(lfsr::sync_control);
+    EXPECT_TRUE(lock.locked());
+
+    /* Locked, 15 bad headers in 64 are put up with, but not 16 */
+    for (auto ii = 0; ii != 64; ++ii) {
+        ASSERT_FALSE(lock.observe(ii < 15 ? 0b00 : lfsr::sync_data));
+    }
+    EXPECT_TRUE(lock.locked());
+    for (auto ii = 0; ii != 15; ++ii) {
+        ASSERT_FALSE(lock.observe(0b11));
+    }
+    EXPECT_TRUE(lock.observe(0b11));
+    EXPECT_FALSE(lock.locked());
+    EXPECT_EQ(lock.slips(), 3u);
+    EXPECT_EQ(lock.invalid_headers(), 2u + 15u + 16u);
+}
+
+
+/* 3GPP's downlink scrambling code registers, x^18 + x^7 + 1 and
+   x^18 + x^10 + x^7 + x^5 + 1 */
+using gold_18 = lfsr::gold_sequence<lfsr::tap_list<0, 11, 18>,
+                                    lfsr::tap_list<0, 8, 11, 13, 18>>;
+
+
+TEST(LFSRGold, MatchesPairOfRegisters)
+{
+    auto gold = gold_18{0b1, 0x3ffff};
+    auto first = lfsr::feedthrough_fibonacci<0, 11, 18>{};
+    auto second = lfsr::feedthrough_fibonacci<0, 8, 11, 13, 18>{};
+    first.set_state(0b1);
+    second.set_state(0x3ffff);
+
+    auto bits = gold;
+    auto words = std::vector<std::uint64_t>(20);
+    gold.generate(std::span{words});
+    for (auto ii = 0u; ii != words.size() * 64; ++ii) {
+        auto const expected = first.scramble_bit(false) != second.scramble_bit(false);
+        ASSERT_EQ(bits.next_bit(), expected) << ii;
+        ASSERT_EQ((words[ii / 64] >> (ii % 64)) & 1, expected) << ii;
+    }
+    EXPECT_EQ(gold.index(), bits.index());
+
+    /* Bytes are the same words, and can end part way through one */
+    auto bytes = std::vector<std::uint8_t>(words.size() * 8 - 3);
+    auto again = gold_18{0b1, 0x3ffff};
+    again.generate(std::span{bytes});
+    EXPECT_EQ(std::memcmp(bytes.data(), words.data(), bytes.size()), 0);
+}
+
+
+TEST(LFSRGold, SeeksAndDiscards)
+{
+    auto const gold = gold_18{0x2468a, 0x13579};
+    auto words = std::vector<std::uint64_t>(100);
+    auto copy = gold;
+    copy.generate(std::span{words});
+
+    auto const chips_at = [&](std::uint64_t index) {
+        auto const word = index / 64;
+        auto const shift = index % 64;
+        return shift == 0 ? words[word]
+                : (words[word] >> shift) | (words[word + 1] << (64 - shift));
+    };
+
+    for (auto index : {0u, 1u, 63u, 64u, 777u, 4000u, 6335u})
+    {
+        auto phase = gold.phase(index);
+        EXPECT_EQ(phase.index(), index);
+        EXPECT_EQ(phase.next_word(), chips_at(index)) << index;
+
+        /* Backwards, from where `copy` has got to */
+        copy.seek(index);
+        EXPECT_EQ(copy.next_word(), chips_at(index)) << index;
+    }
+
+    /* Words after odd bits straddle the generated ones */
+    auto mixed = gold;
+    for (auto ii = 0u; ii != 3; ++ii) {
+        EXPECT_EQ(mixed.next_bit(), (words[0] >> ii) & 1);
+    }
+    EXPECT_EQ(mixed.next_word(), chips_at(3));
+    auto straddled = std::vector<std::uint64_t>(20);
+    mixed.generate(std::span{straddled});
+    for (auto ii = 0u; ii != straddled.size(); ++ii) {
+        EXPECT_EQ(straddled[ii], chips_at(67 + ii * 64)) << ii;
+    }
+    EXPECT_EQ(mixed.index(), 67u + 20 * 64);
+
+    auto skipped = gold;
+    skipped.next_bit();
+    skipped.discard(200);
+    EXPECT_EQ(skipped.index(), 201u);
+    EXPECT_EQ(skipped.next_word(), chips_at(201));
+
+    /* Both registers are maximal length, so they both repeat */
+    EXPECT_EQ(gold.phase((1u << 18) - 1 + 321).next_word(), chips_at(321));
+}
+
+
+/* The periodic correlation of every pair of codes at every shift, save for
+   each code with itself unshifted */
+template <typename Gold>
+auto correlations(std::size_t period, std::size_t codes)
+{
+    auto chips = std::vector<std::vector<int>>{};
+    for (auto k = std::size_t{}; k != codes; ++k)
+    {
+        auto gold = Gold{};
+        gold.shift_second(k);
+        auto & code = chips.emplace_back();
+        for (auto ii = std::size_t{}; ii != period; ++ii) {
+            code.push_back(gold.next_bit() ? -1 : 1);
+        }
+    }
+
+    auto result = std::set<int>{};
+    for (auto a = std::size_t{}; a != codes; ++a) {
+        for (auto b = std::size_t{}; b != codes; ++b) {
+            for (auto shift = std::size_t{}; shift != period; ++shift)
+            {
+                if (a == b && shift == 0) {
+                    continue;
+                }
+                auto sum = 0;
+                for (auto ii = std::size_t{}; ii != period; ++ii) {
+                    sum += chips[a][ii] * chips[b][(ii + shift) % period];
+                }
+                result.insert(sum);
+            }
+        }
+    }
+    return result;
+}
+
+
+TEST(LFSRGold, GoldCodesHaveThreeValuedCorrelation)
+{
+    /* x^5 + x^2 + 1 and x^5 + x^4 + x^3 + x^2 + 1 are a preferred pair, so
+       their 31 codes correlate at -1, -1 - 2^3 or -1 + 2^3 */
+    using gold_5 = lfsr::gold_sequence<lfsr::tap_list<0, 3, 5>,
+                                       lfsr::tap_list<0, 1, 2, 3, 5>>;
+    EXPECT_EQ(correlations<gold_5>(31, 31), (std::set<int>{-9, -1, 7}));
+}
+
+
+TEST(LFSRGold, KasamiCodesHaveThreeValuedCorrelation)
+{
+    /* The small Kasami set of degree 4, from x^4 + x + 1 and x^2 + x + 1:
+       correlations are -1, -1 - 2^2 or -1 + 2^2 */
+    using kasami_4 = lfsr::gold_sequence<lfsr::tap_list<0, 3, 4>,
+                                         lfsr::tap_list<0, 1, 2>>;
+    EXPECT_EQ(correlations<kasami_4>(15, 3), (std::set<int>{-5, -1, 3}));
+}
+
+
+TEST(LFSRGold, GeneratesPhases)
+{
+    auto const gold = gold_18{0x2468a, 0x13579};
+    auto generators = std::vector<gold_18>{};
+    for (auto ii = 0u; ii != 7; ++ii) {
+        generators.push_back(gold.phase(ii * 1000));
+    }
+
+    auto const words = std::size_t{33};
+    auto out = std::vector<std::uint64_t>(generators.size() * words);
+    lfsr::generate_phases(std::span{generators}, std::span{out});
+
+    for (auto ii = 0u; ii != generators.size(); ++ii)
+    {
+        auto expected = std::vector<std::uint64_t>(words);
+        gold.phase(ii * 1000).generate(std::span{expected});
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                out.begin() + ii * words)) << ii;
+        EXPECT_EQ(generators[ii].index(), ii * 1000 + words * 64);
+    }
+
+    EXPECT_THROW(lfsr::generate_phases(std::span{generators},
+            std::span{out}.first(words)), std::invalid_argument);
+}
+
+
+TEST(LFSRCrc, MatchesCheckValue)
+{
+    auto const check = std::string_view{"123456789"};
+    auto const bytes = reinterpret_cast<std::uint8_t const *>(check.data());
+    auto crc = lfsr::crc32c{};
+    crc.update(bytes, bytes + check.size());
+    EXPECT_EQ(crc.value(), 0xe3069283u);
+
+    /* Both ways, at every alignment and length up to a few words */
+    auto const data = random_payload(64);
+    for (auto offset = 0u; offset != 8; ++offset) {
+        for (auto size = 0u; size != 40; ++size)
+        {
+            auto const first = data.data() + offset;
+            auto const expected = lfsr::detail::crc32c_software(
+                    ~0u, first, size);
+            ASSERT_EQ(lfsr::detail::crc32c_hardware(~0u, first, size),
+                    expected) << offset << " " << size;
+
+            /* And in pieces */
+            auto pieces = lfsr::crc32c{};
+            pieces.update(first, first + size / 3);
+            pieces.update(first + size / 3, first + size);
+            ASSERT_EQ(pieces.value(), ~expected);
+        }
+    }
+}
+
+
+template <typename LFSR>
+auto fused_matches_separate(lfsr::crc_of over) -> void
+{
+    /* Enough for a few chunks and a bit */
+    auto const input = random_payload(3 * 4096 + 1001);
+    auto const whole = [](std::vector<std::uint8_t> const & bytes) {
+        auto crc = lfsr::crc32c{};
+        crc.update(bytes.data(), bytes.data() + bytes.size());
+        return crc.value();
+    };
+
+    auto scrambler = LFSR{};
+    auto scrambled = std::vector<std::uint8_t>(input.size());
+    scrambler.scramble_range(input.begin(), input.end(), scrambled.begin());
+
+    auto fused = LFSR{};
+    auto output = input;
+    auto crc = lfsr::crc32c{};
+    lfsr::scramble_with_crc(fused, output.data(), output.data() + output.size(),
+            output.data(), crc, over);
+    EXPECT_EQ(output, scrambled);
+    EXPECT_EQ(crc.value(), whole(over == lfsr::crc_of::plaintext ? input : scrambled));
+    EXPECT_EQ(fused.state(), scrambler.state());
+
+    auto descrambler = LFSR{};
+    auto descrambled = std::vector<std::uint8_t>(input.size());
+    EXPECT_TRUE(lfsr::descramble_and_check(descrambler, scrambled.data(),
+            scrambled.data() + scrambled.size(), descrambled.data(),
+            crc.value(), over));
+    EXPECT_EQ(descrambled, input);
+
+    scrambled[5000] ^= 0x10;
+    auto corrupted = LFSR{};
+    EXPECT_FALSE(lfsr::descramble_and_check(corrupted, scrambled.data(),
+            scrambled.data() + scrambled.size(), descrambled.data(),
+            crc.value(), over));
+}
+
+
+TEST(LFSRCrc, FusedMatchesSeparate)
+{
+    for (auto over : {lfsr::crc_of::plaintext, lfsr::crc_of::scrambled})
+    {
+        fused_matches_separate<lfsr::feedthrough_fibonacci<0, 17, 20>>(over);
+        fused_matches_separate<lfsr::feedthrough_fibonacci_bulk<0, 17, 20>>(over);
+        fused_matches_separate<lfsr::feedthrough_fibonacci_word<0, 39, 58>>(over);
+    }
+}
+
+
+/* Against a Fibonacci engine for each stage, one after the other, from
+   their initial states and from states handed over part way through */
+template <typename TapsA, typename TapsB>
+auto cascade_matches_stages() -> void
+{
+    using cascade = lfsr::cascade<TapsA, TapsB>;
+    auto const input = random_payload(2001);
+    auto const middle = input.begin() + 777;
+
+    auto first = detail::feedthrough_fibonacci_from_list_t<TapsA>{};
+    auto second = detail::feedthrough_fibonacci_from_list_t<TapsB>{};
+    auto between = std::vector<std::uint8_t>(input.size());
+    auto expected = std::vector<std::uint8_t>(input.size());
+    first.scramble_range(input.begin(), middle, between.begin());
+    second.scramble_range(between.begin(), between.begin() + 777, expected.begin());
+
+    auto fused = cascade{};
+    auto output = std::vector<std::uint8_t>(input.size());
+    fused.scramble_range(input.begin(), middle, output.begin());
+    EXPECT_EQ(fused.first_state(), first.state());
+    EXPECT_EQ(fused.second_state(), second.state());
+
+    auto handed = cascade{};
+    handed.set_states(first.state(), second.state());
+    EXPECT_EQ(handed.state(), fused.state());
+
+    first.scramble_range(middle, input.end(), between.begin() + 777);
+    second.scramble_range(between.begin() + 777, between.end(),
+            expected.begin() + 777);
+    handed.scramble_range(middle, input.end(), output.begin() + 777);
+    EXPECT_EQ(output, expected);
+
+    /* Descrambling undoes both, a bit, a byte and a range at a time */
+    auto descrambler = cascade{};
+    auto descrambled = std::vector<std::uint8_t>(input.size());
+    auto byte = std::uint8_t{};
+    for (auto ii = 0u; ii != 8; ++ii) {
+        byte |= descrambler.descramble_bit((expected[0] >> ii) & 1) << ii;
+    }
+    descrambled[0] = byte;
+    descrambled[1] = descrambler.descramble_byte(expected[1]);
+    descrambler.descramble_range(expected.begin() + 2, expected.end(),
+            descrambled.begin() + 2);
+    EXPECT_EQ(descrambled, input);
+}
+
+
+TEST(LFSRCascade, MatchesStagesInSeries)
+{
+    /* Two word sized stages, one with equal lowest taps, which cancel in
+       the product */
+    cascade_matches_stages<lfsr::tap_list<0, 3, 5>, lfsr::tap_list<0, 6, 7>>();
+    cascade_matches_stages<lfsr::tap_list<0, 5, 6>, lfsr::tap_list<0, 5, 7>>();
+    cascade_matches_stages<lfsr::tap_list<0, 39, 58>, lfsr::tap_list<0, 17, 20>>();
+
+    /* Over the product */
+    cascade_matches_stages<lfsr::tap_list<0, 3, 5>, Degree_127>();
+}
+
+
+TEST(LFSRCascade, DerivesProductTaps)
+{
+    /* (1 + x^3 + x^5)(1 + x^6 + x^7) */
+    EXPECT_TRUE((std::is_same_v<
+            lfsr::cascade<lfsr::tap_list<0, 3, 5>, lfsr::tap_list<0, 6, 7>>::tap_list,
+            lfsr::tap_list<0, 3, 5, 6, 7, 9, 10, 11, 12>>));
+
+    /* x^5 cancels out of (1 + x^5 + x^6)(1 + x^5 + x^7) */
+    EXPECT_TRUE((std::is_same_v<
+            lfsr::cascade<lfsr::tap_list<0, 5, 6>, lfsr::tap_list<0, 5, 7>>::tap_list,
+            lfsr::tap_list<0, 6, 7, 10, 11, 12, 13>>));
+    EXPECT_EQ((lfsr::cascade<lfsr::tap_list<0, 5, 6>,
+            lfsr::tap_list<0, 5, 7>>::degree), 13u);
+}
+
+
+template <typename LFSR, typename Byte>
+concept scrambles_from = requires (LFSR & lfsr, Byte const * in, std::uint8_t * out)
+{
+    lfsr.scramble_range(in, in, out);
+    lfsr.descramble_range(in, in, out);
+};
+
+
+TEST(LFSRCascade, WritesIntoOtherContainers)
+{
+    /* Staged, and over the product */
+    auto check = []<typename Cascade>(Cascade) {
+        auto const input = random_payload(1001);
+        auto expected = std::vector<std::uint8_t>(input.size());
+        Cascade{}.scramble_range(input.begin(), input.end(), expected.begin());
+
+        auto chars = std::string(input.size(), '\0');
+        Cascade{}.scramble_range(input.begin(), input.end(), chars.begin());
+        EXPECT_TRUE(std::ranges::equal(chars, expected, {},
+                [](char c) { return static_cast<std::uint8_t>(c); }));
+
+        auto descrambled = std::vector<char>(input.size());
+        Cascade{}.descramble_range(expected.begin(), expected.end(),
+                descrambled.begin());
+        EXPECT_TRUE(std::ranges::equal(descrambled, input, {},
+                [](char c) { return static_cast<std::uint8_t>(c); }));
+    };
+    check(lfsr::cascade<lfsr::tap_list<0, 39, 58>, lfsr::tap_list<0, 17, 20>>{});
+    check(lfsr::cascade<lfsr::tap_list<0, 3, 5>, Degree_127>{});
+
+    /* Constrained to bytes in, as the engines are */
+    using cascade = lfsr::cascade<lfsr::tap_list<0, 3, 5>, lfsr::tap_list<0, 6, 7>>;
+    EXPECT_TRUE((scrambles_from<cascade, std::uint8_t>));
+    EXPECT_FALSE((scrambles_from<cascade, char>));
+    EXPECT_EQ((scrambles_from<cascade, char>),
+            (scrambles_from<lfsr::feedthrough_fibonacci_word<0, 6, 7>, char>));
+}
+
+
+/* A C handle's output against the C++ engine it should be running */
+template <typename LFSR>
+auto c_matches_engine(std::vector<std::size_t> const & taps, lfsr_kind kind)
+    -> void
+{
+    auto handle = lfsr_create(taps.data(), taps.size(), kind);
+    ASSERT_NE(handle, nullptr) << lfsr_last_error();
+    EXPECT_EQ(lfsr_degree(handle), LFSR::degree);
+    EXPECT_EQ(lfsr_state_size(handle), (LFSR::degree + 7) / 8);
+
+    auto const input = random_payload(1000);
+    auto expected = std::vector<std::uint8_t>(input.size());
+    auto engine = LFSR{};
+    engine.scramble_range(input.begin(), input.end(), expected.begin());
+
+    auto scrambled = std::vector<std::uint8_t>(input.size());
+    EXPECT_EQ(lfsr_scramble(handle, input.data(), scrambled.data(), 300), LFSR_OK);
+    EXPECT_EQ(lfsr_scramble(handle, input.data() + 300, scrambled.data() + 300,
+            input.size() - 300), LFSR_OK);
+    EXPECT_EQ(scrambled, expected);
+
+    /* In place, from the start */
+    auto descrambler = lfsr_create(taps.data(), taps.size(), kind);
+    EXPECT_EQ(lfsr_descramble(descrambler, scrambled.data(), scrambled.data(),
+            scrambled.size()), LFSR_OK);
+    EXPECT_EQ(scrambled, input);
+
+    lfsr_destroy(descrambler);
+    lfsr_destroy(handle);
+}
+
+
+/* Advancing and then scrambling against scrambling zeroes throughout */
+auto c_advance_matches_zeroes(std::vector<std::size_t> const & taps,
+                              lfsr_kind kind, std::uint64_t bits) -> void
+{
+    auto advanced = lfsr_create(taps.data(), taps.size(), kind);
+    auto clocked = lfsr_create(taps.data(), taps.size(), kind);
+    ASSERT_NE(advanced, nullptr) << lfsr_last_error();
+
+    /* Somewhere other than all ones to start */
+    auto const warm = random_payload(16);
+    auto discard = std::vector<std::uint8_t>(warm.size());
+    lfsr_scramble(advanced, warm.data(), discard.data(), warm.size());
+    lfsr_scramble(clocked, warm.data(), discard.data(), warm.size());
+
+    EXPECT_EQ(lfsr_advance(advanced, bits), LFSR_OK);
+    auto const zeroes = std::vector<std::uint8_t>(bits / 8 + 1);
+    auto sink = std::vector<std::uint8_t>(zeroes.size());
+    lfsr_scramble(clocked, zeroes.data(), sink.data(), bits / 8);
+
+    auto const input = random_payload(64, 7);
+    auto from_advanced = std::vector<std::uint8_t>(input.size());
+    auto from_clocked = std::vector<std::uint8_t>(input.size());
+    if (bits % 8 == 0)
+    {
+        lfsr_scramble(advanced, input.data(), from_advanced.data(), input.size());
+        lfsr_scramble(clocked, input.data(), from_clocked.data(), input.size());
+        EXPECT_EQ(from_advanced, from_clocked) << bits;
+    }
+    else
+    {
+        /* The C interface has no single bits, so `clocked` takes a further
+           zero byte and `advanced` catches up with it */
+        lfsr_scramble(clocked, zeroes.data(), sink.data(), 1);
+        EXPECT_EQ(lfsr_advance(advanced, 8 - bits % 8), LFSR_OK);
+        lfsr_scramble(advanced, input.data(), from_advanced.data(), input.size());
+        lfsr_scramble(clocked, input.data(), from_clocked.data(), input.size());
+        EXPECT_EQ(from_advanced, from_clocked) << bits;
+    }
+
+    lfsr_destroy(clocked);
+    lfsr_destroy(advanced);
+}
+
+
+TEST(LFSRC, MatchesEngines)
+{
+    c_matches_engine<lfsr::feedthrough_fibonacci_word<58, 39>>({0, 39, 58},
+            LFSR_KIND_AUTO);
+    c_matches_engine<lfsr::feedthrough_fibonacci<7, 6>>({7, 6},
+            LFSR_KIND_FIBONACCI);
+    c_matches_engine<lfsr::feedthrough_galois<23, 18>>({23, 18},
+            LFSR_KIND_GALOIS);
+    c_matches_engine<lfsr::feedthrough_fibonacci_bulk<127, 1>>({127, 1},
+            LFSR_KIND_AUTO);
+    c_matches_engine<lfsr::feedthrough_fibonacci_word<20, 17>>({20, 17},
+            LFSR_KIND_FIBONACCI_WORD);
+}
+
+
+/* The state from a C handle against that of the C++ engine, after both have
+   scrambled the same */
+template <typename LFSR>
+auto c_state_matches_engine(std::vector<std::size_t> const & taps,
+                            lfsr_kind kind) -> void
+{
+    auto handle = lfsr_create(taps.data(), taps.size(), kind);
+    ASSERT_NE(handle, nullptr) << lfsr_last_error();
+    auto const input = random_payload(100);
+    auto output = std::vector<std::uint8_t>(input.size());
+    lfsr_scramble(handle, input.data(), output.data(), input.size());
+    auto engine = LFSR{};
+    engine.scramble_range(input.begin(), input.end(), output.begin());
+
+    auto const bits = engine.state();
+    auto expected = std::vector<std::uint8_t>((LFSR::degree + 7) / 8);
+    for (auto ii = 0ull; ii != LFSR::degree; ++ii) {
+        expected[ii / 8] |= static_cast<std::uint8_t>(bits.test(ii) << (ii % 8));
+    }
+    auto state = std::vector<std::uint8_t>(expected.size());
+    EXPECT_EQ(lfsr_get_state(handle, state.data(), state.size()), LFSR_OK);
+    EXPECT_EQ(state, expected);
+
+    lfsr_destroy(handle);
+}
+
+
+TEST(LFSRC, RunsTapsWithNoPrebuiltKernel)
+{
+    EXPECT_TRUE(lfsr::is_prebuilt(std::vector<std::size_t>{39, 0, 58}));
+    EXPECT_FALSE(lfsr::is_prebuilt(std::vector<std::size_t>{0, 5, 23}));
+
+    c_matches_engine<lfsr::feedthrough_fibonacci_word<23, 5>>({0, 5, 23},
+            LFSR_KIND_AUTO);
+    c_matches_engine<lfsr::feedthrough_fibonacci<23, 5>>({23, 5},
+            LFSR_KIND_FIBONACCI);
+    c_matches_engine<lfsr::feedthrough_galois<23, 5>>({0, 5, 23},
+            LFSR_KIND_GALOIS);
+    c_matches_engine<lfsr::feedthrough_fibonacci_word<11, 2>>({0, 2, 11},
+            LFSR_KIND_FIBONACCI_WORD);
+    c_matches_engine<lfsr::feedthrough_fibonacci<64, 4, 3, 1>>({0, 1, 3, 4, 64},
+            LFSR_KIND_FIBONACCI_WORD);
+    c_matches_engine<lfsr::feedthrough_fibonacci<71, 3>>({0, 3, 71},
+            LFSR_KIND_AUTO);
+    c_matches_engine<lfsr::feedthrough_galois<71, 3>>({0, 3, 71},
+            LFSR_KIND_GALOIS);
+    c_matches_engine<lfsr::feedthrough_fibonacci<130, 9>>({0, 9, 130},
+            LFSR_KIND_FIBONACCI_BULK);
+
+    c_state_matches_engine<lfsr::feedthrough_fibonacci<23, 5>>({0, 5, 23},
+            LFSR_KIND_AUTO);
+    c_state_matches_engine<lfsr::feedthrough_galois<23, 5>>({0, 5, 23},
+            LFSR_KIND_GALOIS);
+    c_state_matches_engine<lfsr::feedthrough_fibonacci<130, 9>>({0, 9, 130},
+            LFSR_KIND_AUTO);
+    c_state_matches_engine<lfsr::feedthrough_galois<130, 9>>({0, 9, 130},
+            LFSR_KIND_GALOIS);
+}
+
+
+TEST(LFSRC, RoundTripsState)
+{
+    auto const taps = std::vector<std::size_t>{0, 39, 58};
+    auto handle = lfsr_create(taps.data(), taps.size(), LFSR_KIND_AUTO);
+    auto const input = random_payload(100);
+    auto output = std::vector<std::uint8_t>(input.size());
+    lfsr_scramble(handle, input.data(), output.data(), input.size());
+
+    /* Bit 0 is the most recent bit out */
+    auto state = std::array<std::uint8_t, 8>{};
+    EXPECT_EQ(lfsr_get_state(handle, state.data(), state.size()), LFSR_OK);
+    EXPECT_EQ(state[0] & 1, output.back() >> 7);
+    EXPECT_EQ(state[7] >> 2, 0);
+
+    auto copy = lfsr_clone(handle);
+    auto restored = lfsr_create(taps.data(), taps.size(), LFSR_KIND_FIBONACCI);
+    EXPECT_EQ(lfsr_set_state(restored, state.data(), state.size()), LFSR_OK);
+
+    auto expected = std::vector<std::uint8_t>(input.size());
+    auto from_copy = std::vector<std::uint8_t>(input.size());
+    lfsr_scramble(handle, input.data(), expected.data(), input.size());
+    lfsr_scramble(copy, input.data(), from_copy.data(), input.size());
+    lfsr_scramble(restored, input.data(), output.data(), input.size());
+    EXPECT_EQ(from_copy, expected);
+    EXPECT_EQ(output, expected);
+
+    lfsr_destroy(restored);
+    lfsr_destroy(copy);
+    lfsr_destroy(handle);
+}
+
+
+TEST(LFSRC, AdvancesAsIfScramblingZeroes)
+{
+    for (auto bits : {0ull, 1ull, 8ull, 61ull, 4096ull, 100003ull})
+    {
+        c_advance_matches_zeroes({0, 39, 58}, LFSR_KIND_AUTO, bits);
+        c_advance_matches_zeroes({7, 6}, LFSR_KIND_FIBONACCI, bits);
+        c_advance_matches_zeroes({23, 18}, LFSR_KIND_GALOIS, bits);
+        c_advance_matches_zeroes({127, 1}, LFSR_KIND_AUTO, bits);
+        c_advance_matches_zeroes({127, 1}, LFSR_KIND_GALOIS, bits);
+        c_advance_matches_zeroes({0, 5, 23}, LFSR_KIND_AUTO, bits);
+        c_advance_matches_zeroes({0, 5, 23}, LFSR_KIND_GALOIS, bits);
+        c_advance_matches_zeroes({0, 3, 71}, LFSR_KIND_AUTO, bits);
+        c_advance_matches_zeroes({0, 3, 71}, LFSR_KIND_GALOIS, bits);
+    }
+}
+
+
+TEST(LFSRC, AdvancesFarInOneJump)
+{
+    /* Any distance is a jump, so two halves are the whole, and the largest
+       degree doesn't take long either */
+    auto const far = std::uint64_t{1} << 63;
+    auto check = [&](std::vector<std::size_t> const & taps, lfsr_kind kind) {
+        auto whole = lfsr_create(taps.data(), taps.size(), kind);
+        auto halves = lfsr_create(taps.data(), taps.size(), kind);
+        ASSERT_NE(whole, nullptr) << lfsr_last_error();
+        EXPECT_EQ(lfsr_advance(whole, far + 12345), LFSR_OK);
+        EXPECT_EQ(lfsr_advance(halves, far / 2), LFSR_OK);
+        EXPECT_EQ(lfsr_advance(halves, far / 2 + 12345), LFSR_OK);
+
+        auto const size = lfsr_state_size(whole);
+        auto expected = std::vector<std::uint8_t>(size);
+        auto actual = std::vector<std::uint8_t>(size);
+        lfsr_get_state(whole, expected.data(), size);
+        lfsr_get_state(halves, actual.data(), size);
+        EXPECT_EQ(actual, expected) << taps.back();
+
+        lfsr_destroy(halves);
+        lfsr_destroy(whole);
+    };
+    check({23, 18}, LFSR_KIND_GALOIS);
+    check({127, 1}, LFSR_KIND_GALOIS);
+    check({127, 1}, LFSR_KIND_FIBONACCI_BULK);
+    check({521, 32}, LFSR_KIND_FIBONACCI_BULK);
+    check({0, 39, 58}, LFSR_KIND_AUTO);
+    check({0, 9, 130}, LFSR_KIND_AUTO);
+    check({0, 9, 130}, LFSR_KIND_GALOIS);
+}
+
+
+TEST(LFSRC, ReportsErrors)
+{
+    EXPECT_EQ(lfsr_abi_version(), LFSR_C_ABI_VERSION);
+
+    auto const none = std::vector<std::size_t>{0};
+    EXPECT_EQ(lfsr_create(none.data(), none.size(), LFSR_KIND_AUTO), nullptr);
+    EXPECT_NE(std::string_view{lfsr_last_error()}, "");
+    EXPECT_EQ(lfsr_create(nullptr, 0, LFSR_KIND_AUTO), nullptr);
+
+    auto const huge = std::vector<std::size_t>{0, 3, 100000};
+    EXPECT_EQ(lfsr_create(huge.data(), huge.size(), LFSR_KIND_AUTO), nullptr);
+
+    auto const wide = std::vector<std::size_t>{127, 1};
+    EXPECT_EQ(lfsr_create(wide.data(), wide.size(), LFSR_KIND_FIBONACCI_WORD),
+            nullptr);
+    auto const wide_runtime = std::vector<std::size_t>{0, 3, 71};
+    EXPECT_EQ(lfsr_create(wide_runtime.data(), wide_runtime.size(),
+            LFSR_KIND_FIBONACCI_WORD), nullptr);
+
+    auto byte = std::uint8_t{};
+    EXPECT_EQ(lfsr_scramble(nullptr, &byte, &byte, 1), LFSR_INVALID_ARGUMENT);
+    EXPECT_EQ(lfsr_advance(nullptr, 1), LFSR_INVALID_ARGUMENT);
+    EXPECT_EQ(lfsr_degree(nullptr), 0u);
+    lfsr_destroy(nullptr);
+
+    auto const taps = std::vector<std::size_t>{23, 18};
+    auto handle = lfsr_create(taps.data(), taps.size(), LFSR_KIND_GALOIS);
+    auto state = std::array<std::uint8_t, 3>{};
+    EXPECT_EQ(lfsr_get_state(handle, state.data(), 2), LFSR_INVALID_ARGUMENT);
+    EXPECT_EQ(lfsr_set_state(handle, nullptr, 3), LFSR_INVALID_ARGUMENT);
+    EXPECT_EQ(lfsr_scramble(handle, nullptr, nullptr, 0), LFSR_OK);
+    EXPECT_EQ(std::string_view{lfsr_last_error()}, "");
+    lfsr_destroy(handle);
+}
+
+
+/* Reseeding loads the seed as the state, and a reset goes back to how the
+   engine was constructed */
+template <typename LFSR>
+auto resets_to_seed() -> void
+{
+    auto lfsr = LFSR{};
+    auto const fresh = lfsr.state();
+    auto const input = random_payload(100);
+    auto output = std::vector<std::uint8_t>(input.size());
+    lfsr.scramble_range(input.begin(), input.end(), output.begin());
+
+    lfsr.reset(0x5a);
+    EXPECT_EQ(lfsr.state(), std::bitset<LFSR::degree>{0x5a});
+    lfsr.reset();
+    EXPECT_EQ(lfsr.state(), fresh);
+
+    /* Carrying on from a seed is the same as from its state */
+    auto seeded = LFSR{};
+    seeded.reset(0x2f);
+    auto set = LFSR{};
+    set.set_state(std::bitset<LFSR::degree>{0x2f});
+    auto expected = std::vector<std::uint8_t>(input.size());
+    seeded.scramble_range(input.begin(), input.end(), output.begin());
+    set.scramble_range(input.begin(), input.end(), expected.begin());
+    EXPECT_EQ(output, expected);
+}
+
+
+TEST(LFSRKeystream, ResetsToSeed)
+{
+    resets_to_seed<lfsr::feedthrough_fibonacci<7, 4>>();
+    resets_to_seed<lfsr::feedthrough_galois<7, 4>>();
+    resets_to_seed<lfsr::feedthrough_fibonacci_bulk<7, 4>>();
+    resets_to_seed<lfsr::feedthrough_fibonacci_word<7, 4>>();
+    resets_to_seed<lfsr::feedthrough_fibonacci_bulk<127, 1>>();
+    resets_to_seed<lfsr::cascade<lfsr::tap_list<0, 4, 7>,
+                                 lfsr::tap_list<0, 39, 58>>>();
+}
+
+
+TEST(LFSRKeystream, MatchesScramblingZeroes)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_word<7, 4>;
+    auto const table = lfsr::keystream_table<lfsr_type, 64>{};
+
+    /* Frames that fit the table, and that go past it */
+    for (auto seed : {0x01u, 0x5du, 0x7fu})
+    {
+        for (auto size : {std::size_t{13}, std::size_t{64}, std::size_t{1000}})
+        {
+            auto const frame = random_payload(size, seed);
+            auto lfsr = lfsr_type{};
+            lfsr.reset(seed);
+            auto keystream = std::vector<std::uint8_t>(size);
+            lfsr.scramble_range(keystream.begin(), keystream.end(),
+                    keystream.begin());
+            auto expected = std::vector<std::uint8_t>(size);
+            for (auto ii = std::size_t{}; ii != size; ++ii) {
+                expected[ii] = frame[ii] ^ keystream[ii];
+            }
+
+            auto scrambled = std::vector<std::uint8_t>(size);
+            table.scramble(seed, frame.data(), frame.data() + size,
+                    scrambled.data());
+            EXPECT_EQ(scrambled, expected) << seed << " " << size;
+
+            table.descramble(seed, scrambled.data(), scrambled.data() + size,
+                    scrambled.data());
+            EXPECT_EQ(scrambled, frame);
+        }
+    }
+    EXPECT_EQ(table.keystream(0)[0], 0);
+    EXPECT_THROW(table.keystream(128), std::out_of_range);
+}
+
+
+TEST(LFSRDispatch, ParsesTapsAndNames)
+{
+    EXPECT_EQ(lfsr::parse_taps("0,17,20"), (std::vector<std::size_t>{0, 17, 20}));
+    EXPECT_EQ(lfsr::parse_taps("prbs7"), (std::vector<std::size_t>{7, 6}));
+    EXPECT_THROW(lfsr::parse_taps("0,,20"), std::invalid_argument);
+    EXPECT_THROW(lfsr::parse_taps("seven"), std::invalid_argument);
+
+    /* Nothing after a last comma, and no wrapping round */
+    EXPECT_THROW(lfsr::parse_taps("7,4,"), std::invalid_argument);
+    EXPECT_THROW(lfsr::parse_taps(","), std::invalid_argument);
+    EXPECT_THROW(lfsr::parse_taps("18446744073709551623"), std::invalid_argument);
+    EXPECT_THROW(lfsr::parse_taps("-7"), std::invalid_argument);
+    EXPECT_THROW(lfsr::parse_taps("7 "), std::invalid_argument);
+}
+
+
+TEST(LFSRDispatch, ParsesSizes)
+{
+    using detail::arguments;
+    EXPECT_EQ(arguments::parse_size("100"), 100u);
+    EXPECT_EQ(arguments::parse_size("4K"), 4096u);
+    EXPECT_EQ(arguments::parse_size("3m"), std::size_t{3} << 20);
+    EXPECT_EQ(arguments::parse_size("2G"), std::size_t{2} << 30);
+    EXPECT_THROW(arguments::parse_size(""), std::invalid_argument);
+    EXPECT_THROW(arguments::parse_size("K"), std::invalid_argument);
+    EXPECT_THROW(arguments::parse_size("4KB"), std::invalid_argument);
+
+    /* Too big either before or after the suffix */
+    EXPECT_THROW(arguments::parse_size("18446744073709551623"),
+            std::invalid_argument);
+    EXPECT_THROW(arguments::parse_size(std::format("{}G",
+            std::numeric_limits<std::size_t>::max() >> 29)),
+            std::invalid_argument);
+    EXPECT_EQ(arguments::parse_size(std::format("{}G",
+            std::numeric_limits<std::size_t>::max() >> 30)),
+            (std::numeric_limits<std::size_t>::max() >> 30) << 30);
+}
+
+
+TEST(LFSRDispatch, VisitsMatchingEngine)
+{
+    using expected_type = lfsr::feedthrough_fibonacci_bulk<20, 17>;
+
+    auto taps = std::vector<std::size_t>{0, 17, 20};
+    auto visited = false;
+    lfsr::visit_engine(taps, lfsr::engine_kind::fibonacci_bulk, [&](auto & e) {
+        visited = std::is_same_v<std::remove_cvref_t<decltype(e)>, expected_type>;
+    });
+    EXPECT_TRUE(visited);
+
+    auto unknown = std::vector<std::size_t>{5, 3};
+    EXPECT_THROW(lfsr::visit_engine(unknown, lfsr::engine_kind::galois, 
+            [](auto &) {}), std::invalid_argument);
+
+    /* The word engine only goes up to 64 bits */
+    auto wide = std::vector<std::size_t>{521, 32};
+    EXPECT_THROW(lfsr::visit_engine(wide, lfsr::engine_kind::fibonacci_word,
+            [](auto &) {}), std::invalid_argument);
+    EXPECT_EQ(lfsr::parse_engine_kind("word"), lfsr::engine_kind::fibonacci_word);
+}
+
+
+
+TEST(LFSRPipeline, MatchesScrambleRange)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_bulk<0, 17, 20>;
+
+    auto input = std::vector<std::uint8_t>(100'003);
+    for (auto ii = 0ull; ii != input.size(); ++ii) {
+        input[ii] = static_cast<std::uint8_t>(ii * 37 + (ii >> 8));
+    }
+
+    auto expected  = std::vector<std::uint8_t>(input.size());
+    auto reference = lfsr_type{};
+    reference.scramble_range(input.begin(), input.end(), expected.begin());
+
+    /* Short reads, so that blocks aren't always full */
+    auto position = std::size_t{};
+    auto read = [&](std::uint8_t * out, std::size_t capacity) {
+        auto const count = std::min({capacity, input.size() - position,
+                std::size_t{777}});
+        std::copy_n(input.begin() + position, count, out);
+        position += count;
+        return count;
+    };
+
+    auto scrambled = std::vector<std::uint8_t>{};
+    auto write = [&](std::uint8_t const * in, std::size_t size) {
+        scrambled.insert(scrambled.end(), in, in + size);
+    };
+
+    auto pipeline = lfsr::pipeline<lfsr_type>{lfsr_type{}, {
+            .block_size = 1024,
+            .queue_depth = 3,
+        }};
+    EXPECT_EQ(pipeline.scramble(read, write), input.size());
+    EXPECT_EQ(scrambled, expected);
+    EXPECT_EQ(pipeline.engine().state(), reference.state());
+
+    /* And back again, through the descrambling pipeline */
+    position = 0;
+    input.swap(scrambled);
+    scrambled.clear();
+    auto descrambler = lfsr::pipeline<lfsr_type>{};
+    descrambler.descramble(read, write);
+    EXPECT_EQ(input, expected);
+}
+
+TEST(LFSRPipeline, SequencesFramesInOrder)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_bulk<0, 17, 20>;
+
+    auto frames = std::vector<std::vector<std::uint8_t>>{};
+    for (auto ii = 0u; ii != 5; ++ii) {
+        frames.push_back(random_payload(10 + ii, ii));
+    }
+    auto expected = std::vector<std::uint8_t>{};
+    for (auto const & frame : frames) {
+        expected.insert(expected.end(), frame.begin(), frame.end());
+    }
+    lfsr_type{}.scramble_range(expected.begin(), expected.end(), expected.begin());
+
+    auto sequences = std::vector<std::uint64_t>{};
+    auto output = std::vector<std::uint8_t>{};
+    auto sequencer = lfsr::sequencer{4, [&](std::uint64_t sequence,
+            std::span<std::uint8_t> frame) {
+        sequences.push_back(sequence);
+        output.insert(output.end(), frame.begin(), frame.end());
+    }, lfsr_type{}};
+
+    /* Nothing can go until frame 0 is in, and then everything ready does */
+    sequencer.submit(2, frames[2]);
+    sequencer.submit(1, frames[1]);
+    EXPECT_EQ(sequencer.completed(), 0u);
+    sequencer.submit(0, frames[0]);
+    EXPECT_EQ(sequencer.completed(), 3u);
+    sequencer.submit(4, frames[4]);
+    sequencer.submit(3, frames[3]);
+    EXPECT_EQ(sequencer.completed(), 5u);
+
+    EXPECT_EQ(sequences, (std::vector<std::uint64_t>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(output, expected);
+    EXPECT_THROW(sequencer.submit(4, frames[4]), std::invalid_argument);
+}
+
+
+TEST(LFSRPipeline, SequencesFramesFromManyThreads)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_word<0, 39, 58>;
+    constexpr auto threads = 4u;
+    constexpr auto per_thread = 2000u;
+
+    auto frames = std::vector<std::vector<std::uint8_t>>{};
+    auto expected = std::vector<std::uint8_t>{};
+    for (auto ii = 0u; ii != threads * per_thread; ++ii) {
+        frames.push_back(random_payload(1 + ii % 37, ii));
+        expected.insert(expected.end(), frames.back().begin(), frames.back().end());
+    }
+    lfsr_type{}.scramble_range(expected.begin(), expected.end(), expected.begin());
+
+    /* The sink is only ever called by one thread at a time, in order */
+    auto output = std::vector<std::uint8_t>{};
+    auto in_order = true;
+    auto next = std::uint64_t{};
+    auto sequencer = lfsr::sequencer{16, [&](std::uint64_t sequence,
+            std::span<std::uint8_t> frame) {
+        in_order = in_order && sequence == next++;
+        output.insert(output.end(), frame.begin(), frame.end());
+    }, lfsr_type{}};
+
+    /* Each thread takes every fourth frame */
+    {
+        auto workers = std::vector<std::jthread>{};
+        for (auto tt = 0u; tt != threads; ++tt) {
+            workers.emplace_back([&, tt] {
+                for (auto ii = tt; ii < frames.size(); ii += threads) {
+                    sequencer.submit(ii, frames[ii]);
+                }
+            });
+        }
+    }
+    sequencer.wait(frames.size());
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(output, expected);
+}
+
+
+
+TEST(LFSRPipeline, RethrowsWriteErrors)
+{
+    using lfsr_type = lfsr::feedthrough_galois<0, 17, 20>;
+
+    auto reads = 0;
+    auto read = [&](std::uint8_t *, std::size_t capacity) {
+        ++reads;
+        return capacity;
+    };
+    auto write = [](std::uint8_t const *, std::size_t) {
+        throw std::runtime_error("disk full");
+    };
+
+    auto pipeline = lfsr::pipeline<lfsr_type>{lfsr_type{}, {
+            .block_size = 64,
+            .queue_depth = 4,
+        }};
+    EXPECT_THROW(pipeline.scramble(read, write), std::runtime_error);
+    EXPECT_GT(reads, 0);
+}
+
+
+TEST(LFSRStream, ScramblesWhatsWritten)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_word<58, 39>;
+
+    auto const input = random_payload(10'000);
+    auto expected = std::vector<std::uint8_t>(input.size());
+    lfsr_type{}.scramble_range(input.begin(), input.end(), expected.begin());
+
+    /* Single characters, writes smaller than the buffer, and writes larger
+       than it, which go straight through */
+    auto sink = std::stringbuf{};
+    {
+        auto buf = lfsr::scrambling_streambuf{sink, lfsr_type{}, 256};
+        auto out = std::ostream{&buf};
+        auto const data = reinterpret_cast<char const *>(input.data());
+        auto position = std::size_t{};
+        for (auto size : {1, 1, 100, 300, 255, 1, 2000, 7})
+        {
+            if (size == 1) {
+                out.put(data[position]);
+            } else {
+                out.write(data + position, size);
+            }
+            position += static_cast<std::size_t>(size);
+        }
+        out.flush();
+        EXPECT_EQ(sink.view().size(), position);
+        out.write(data + position, static_cast<std::streamsize>(
+                input.size() - position));
+        EXPECT_TRUE(out);
+    }
+
+    /* The rest is passed on by the destructor */
+    auto const scrambled = sink.str();
+    EXPECT_EQ(std::vector<std::uint8_t>(scrambled.begin(), scrambled.end()),
+            expected);
+}
+
+
+TEST(LFSRStream, DescramblesWhatsRead)
+{
+    using lfsr_type = lfsr::feedthrough_galois<23, 18>;
+
+    auto const input = random_payload(10'000);
+    auto scrambled = std::string(input.size(), '\0');
+    lfsr_type{}.scramble_range(input.begin(), input.end(), scrambled.begin());
+
+    auto source = std::stringbuf{scrambled};
+    auto buf = lfsr::descrambling_streambuf{source, lfsr_type{}, 256};
+    auto in = std::istream{&buf};
+
+    /* With room for one more than there is, to ask for it */
+    auto output = std::vector<std::uint8_t>(input.size() + 1);
+    auto const data = reinterpret_cast<char *>(output.data());
+    auto position = std::size_t{};
+    for (auto size : {1, 100, 300, 1, 2000, 255})
+    {
+        if (size == 1) {
+            data[position] = static_cast<char>(in.get());
+        } else {
+            in.read(data + position, size);
+        }
+        position += static_cast<std::size_t>(size);
+    }
+    in.read(data + position, static_cast<std::streamsize>(input.size() + 1
+            - position));
+    EXPECT_EQ(in.gcount(), static_cast<std::streamsize>(input.size() - position));
+    EXPECT_TRUE(in.eof());
+    output.pop_back();
+    EXPECT_EQ(output, input);
+}
+
+
+TEST(LFSRViews, MatchesScrambleRange)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_word<58, 39>;
+
+    auto const input = random_payload(3 * lfsr::view_block + 100);
+    auto expected = std::vector<std::uint8_t>(input.size());
+    lfsr_type{}.scramble_range(input.begin(), input.end(), expected.begin());
+
+    /* Read in place, and copied in from a list */
+    auto from_vector = std::vector<std::uint8_t>{};
+    std::ranges::copy(input | lfsr::views::scramble<lfsr_type>(),
+            std::back_inserter(from_vector));
+    EXPECT_EQ(from_vector, expected);
+
+    auto const list = std::list<std::uint8_t>(input.begin(), input.end());
+    auto from_list = std::vector<std::uint8_t>{};
+    std::ranges::copy(list | lfsr::views::scramble<lfsr_type>(),
+            std::back_inserter(from_list));
+    EXPECT_EQ(from_list, expected);
+
+    /* And back again, in the same pipeline */
+    auto round_trip = std::vector<std::uint8_t>{};
+    std::ranges::copy(input | lfsr::views::scramble<lfsr_type>()
+                            | lfsr::views::descramble<lfsr_type>(),
+            std::back_inserter(round_trip));
+    EXPECT_EQ(round_trip, input);
+}
+
+
+TEST(LFSRViews, PullsOnlyWhatsRead)
+{
+    using lfsr_type = lfsr::feedthrough_galois<23, 18>;
+
+    auto pulled = std::size_t{};
+    auto source = std::views::iota(0, 100'000)
+                | std::views::transform([&](int value) {
+                      ++pulled;
+                      return static_cast<std::uint8_t>(value);
+                  });
+
+    auto count = 0;
+    for (auto byte : source | lfsr::views::scramble<lfsr_type>()
+                            | std::views::filter([](auto b) { return b & 1; })
+                            | std::views::take(10)) {
+        static_cast<void>(byte);
+        ++count;
+    }
+    EXPECT_EQ(count, 10);
+    EXPECT_EQ(pulled, lfsr::view_block);
+}
+
+
+TEST(LFSRViews, MovesAReferencedEngineAlong)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_bulk<20, 17>;
+
+    auto const input = random_payload(10'000);
+    auto expected = std::vector<std::uint8_t>(input.size());
+    auto reference = lfsr_type{};
+    reference.scramble_range(input.begin(), input.end(), expected.begin());
+
+    /* Two views over halves of the input, both moving one engine */
+    auto engine = lfsr_type{};
+    auto const half = input.size() / 2;
+    auto output = std::vector<std::uint8_t>{};
+    std::ranges::copy(std::views::counted(input.begin(), half)
+                    | lfsr::views::scramble(std::ref(engine)),
+            std::back_inserter(output));
+    std::ranges::copy(std::views::counted(input.begin() + half, input.size() - half)
+                    | lfsr::views::scramble(std::ref(engine)),
+            std::back_inserter(output));
+    EXPECT_EQ(output, expected);
+    EXPECT_EQ(engine.state(), reference.state());
+}
+
+
+/* Synchronising from an arbitrary state on the bytes before an offset, and
+   descrambling the rest, against descrambling the lot */
+template <typename LFSR>
+auto synchronises_anywhere() -> void
+{
+    auto const input = random_payload(1000);
+    auto scrambled = std::vector<std::uint8_t>(input.size());
+    LFSR{}.scramble_range(input.begin(), input.end(), scrambled.begin());
+
+    for (auto offset : {std::size_t{1}, lfsr::history_bytes<LFSR>, std::size_t{333}})
+    {
+        /* Somewhere else entirely to start */
+        auto engine = LFSR{};
+        auto const junk = random_payload(64, offset);
+        auto discard = std::vector<std::uint8_t>(junk.size());
+        engine.scramble_range(junk.begin(), junk.end(), discard.begin());
+        if (offset < lfsr::history_bytes<LFSR>) {
+            engine = LFSR{};
+        }
+
+        lfsr::synchronise(engine, std::span{scrambled}.first(offset));
+        auto output = std::vector<std::uint8_t>(input.size() - offset);
+        engine.descramble_range(scrambled.begin() + offset, scrambled.end(),
+                output.begin());
+        EXPECT_TRUE(std::equal(output.begin(), output.end(),
+                input.begin() + offset)) << offset;
+    }
+}
+
+
+TEST(LFSRSeek, SynchronisesAnywhere)
+{
+    synchronises_anywhere<lfsr::feedthrough_fibonacci<23, 18>>();
+    synchronises_anywhere<lfsr::feedthrough_galois<23, 18>>();
+    synchronises_anywhere<lfsr::feedthrough_galois<127, 1>>();
+    synchronises_anywhere<lfsr::feedthrough_fibonacci_bulk<127, 1>>();
+    synchronises_anywhere<lfsr::feedthrough_fibonacci_word<58, 39>>();
+    synchronises_anywhere<lfsr::cascade<lfsr::tap_list<0, 3, 5>,
+                                        lfsr::tap_list<0, 39, 58>>>();
+}
+
+
+TEST(LFSRSeek, ReadsFromAnywhere)
+{
+    using lfsr_type = lfsr::feedthrough_galois<58, 39>;
+
+    auto const input = random_payload(100'000);
+    auto scrambled = std::vector<std::uint8_t>(input.size());
+    auto initial = lfsr_type{};
+    auto const seed = random_payload(8, 5);
+    auto discard = std::vector<std::uint8_t>(seed.size());
+    initial.scramble_range(seed.begin(), seed.end(), discard.begin());
+    auto scrambler = initial;
+    scrambler.scramble_range(input.begin(), input.end(), scrambled.begin());
+
+    auto reader = lfsr::random_access_descrambler<lfsr_type>{scrambled, initial};
+    EXPECT_EQ(reader.size(), input.size());
+
+    /* Backwards, into the first few bytes, carrying on, and off the end */
+    auto output = std::vector<std::uint8_t>(1000);
+    for (auto offset : {50'000u, 1'000u, 3u, 0u, 1'000u, 99'500u})
+    {
+        EXPECT_EQ(reader.read(offset, output), std::min<std::size_t>(
+                output.size(), input.size() - offset));
+        EXPECT_TRUE(std::equal(output.begin(), output.begin() + std::min<std::size_t>(
+                output.size(), input.size() - offset), input.begin() + offset))
+                << offset;
+    }
+    EXPECT_EQ(reader.read(input.size(), output), 0u);
+    EXPECT_THROW(reader.read(input.size() + 1, output), std::out_of_range);
+}
+
+
+
+/* Each test counts into its own `counting_stats`, by tag, so the counts
+   don't depend on which other tests have run */
+template <typename Tag>
+using counted_fibonacci = lfsr::basic_feedthrough_fibonacci<
+        lfsr::counting_stats<Tag>, 0, 17, 20>;
+
+template <typename Tag>
+using counted_galois = lfsr::basic_feedthrough_galois<
+        lfsr::counting_stats<Tag>, 0, 17, 20>;
+
+template <typename Tag>
+using counted_bulk = lfsr::basic_feedthrough_fibonacci_bulk<
+        lfsr::counting_stats<Tag>, 0, 17, 20>;
+
+
+TEST(LFSRStats, DisabledByDefault)
+{
+    using lfsr_type = lfsr::feedthrough_fibonacci_bulk<0, 17, 20>;
+    using stats_scope = lfsr::detail::stats_scope<lfsr_type::stats_type>;
+
+    EXPECT_FALSE(lfsr_type::stats_type::enabled);
+    EXPECT_TRUE(std::is_empty_v<stats_scope>);
+    EXPECT_EQ(sizeof(lfsr_type), sizeof(counted_bulk<void>));
+}
+
+
+TEST(LFSRStats, CountsCallsBitsAndKernels)
+{
+    struct tag;
+    using stats = lfsr::counting_stats<tag>;
+    using lfsr::stats_call;
+    using lfsr::stats_direction;
+
+    auto fibonacci = counted_fibonacci<tag>{};
+    auto galois    = counted_galois<tag>{};
+    auto bulk      = counted_bulk<tag>{};
+    auto data = std::vector<std::uint8_t>(100, 0x5a);
+
+    fibonacci.scramble_bit(true);
+    galois.scramble_byte(0x12);
+    bulk.scramble_range(data.begin(), data.end(), data.begin());
+    bulk.descramble_range(data.begin(), data.end(), data.begin());
+    bulk.descramble_bit(false);
+
+    auto const s = stats::snapshot();
+    EXPECT_EQ(s.bits[0], 1 + 8 + 800);
+    EXPECT_EQ(s.bits[1], 800 + 1);
+    EXPECT_EQ(s.bytes(stats_direction::descramble), 100);
+    EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::bit), 1);
+    EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::byte), 1);
+    EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::range), 1);
+    EXPECT_EQ(s.call_count(stats_direction::descramble, stats_call::range), 1);
+    EXPECT_EQ(s.call_count(stats_direction::descramble, stats_call::bit), 1);
+    EXPECT_EQ(s.kernel_count(lfsr::stats_kernel::fibonacci), 1);
+    EXPECT_EQ(s.kernel_count(lfsr::stats_kernel::galois), 1);
+    EXPECT_EQ(s.kernel_count(lfsr::stats_kernel::fibonacci_bulk), 3);
+
+    /* The stats don't change what's produced */
+    auto counted = counted_bulk<tag>{};
+    auto plain   = lfsr::feedthrough_fibonacci_bulk<0, 17, 20>{};
+    for (auto ii = 0; ii != 256; ++ii) {
+        ASSERT_EQ(counted.scramble_byte(ii), plain.scramble_byte(ii));
+    }
+
+    stats::reset();
+    EXPECT_EQ(stats::snapshot().bits[0], 0);
+}
+
+
+TEST(LFSRStats, CountsWords)
+{
+    struct tag;
+    using stats = lfsr::counting_stats<tag>;
+    using lfsr::stats_call;
+    using lfsr::stats_direction;
+
+    auto word = lfsr::basic_feedthrough_fibonacci_word<stats, 0, 17, 20>{};
+    auto data = std::vector<std::uint8_t>(100, 0x5a);
+    word.scramble_word(0x1234);
+    word.scramble_range(data.begin(), data.end(), data.begin());
+
+    /* Words are counted as word calls of 64 bits, not as ranges */
+    auto const s = stats::snapshot();
+    EXPECT_EQ(s.bits[0], 64 + 800);
+    EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::word), 1);
+    EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::range), 1);
+    EXPECT_EQ(s.kernel_count(lfsr::stats_kernel::fibonacci_word), 2);
+}
+
+
+TEST(LFSRStats, CountsCascadeCallsOnce)
+{
+    using lfsr::stats_call;
+    using lfsr::stats_direction;
+
+    /* One call recorded for one call made, whichever kernel the degrees
+       pick and however many calls it makes to its engines */
+    auto check = []<typename Stats, typename Cascade>(lfsr::stats_kernel kernel) {
+        auto data = std::vector<std::uint8_t>(64, 0x5a);
+        auto cascade = Cascade{};
+        cascade.scramble_range(data.begin(), data.end(), data.begin());
+
+        auto s = Stats::snapshot();
+        EXPECT_EQ(s.bits[0], 512);
+        EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::range), 1);
+        EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::word), 0);
+        EXPECT_EQ(s.call_count(stats_direction::scramble, stats_call::byte), 0);
+        EXPECT_EQ(s.kernel_count(kernel), 1);
+
+        cascade.descramble_byte(data[0]);
+        s = Stats::snapshot();
+        EXPECT_EQ(s.bits[1], 8);
+        EXPECT_EQ(s.call_count(stats_direction::descramble, stats_call::byte), 1);
+        EXPECT_EQ(s.kernel_count(kernel), 2);
+    };
+
+    struct staged_tag;
+    using staged_stats = lfsr::counting_stats<staged_tag>;
+    check.operator()<staged_stats, lfsr::basic_cascade<staged_stats,
+            lfsr::tap_list<0, 39, 58>, lfsr::tap_list<0, 6, 7>>>(
+            lfsr::stats_kernel::fibonacci_word);
+
+    struct product_tag;
+    using product_stats = lfsr::counting_stats<product_tag>;
+    check.operator()<product_stats, lfsr::basic_cascade<product_stats,
+            lfsr::tap_list<0, 3, 5>, Degree_127>>(
+            lfsr::stats_kernel::fibonacci_bulk);
+}
+
+
+TEST(LFSRStats, AddsUpThreads)
+{
+    struct tag;
+    using stats = lfsr::counting_stats<tag, false, 2>;
+    using lfsr_type = lfsr::basic_feedthrough_galois<stats, 0, 17, 20>;
+
+    /* More threads than slots, so some share the last one */
+    auto threads = std::vector<std::jthread>{};
+    for (auto t = 0; t != 4; ++t) {
+        threads.emplace_back([] {
+            auto lfsr = lfsr_type{};
+            for (auto ii = 0; ii != 1000; ++ii) {
+                lfsr.scramble_byte(static_cast<std::uint8_t>(ii));
+            }
+        });
+    }
+    threads.clear();
+
+    auto const s = stats::snapshot();
+    EXPECT_EQ(s.call_count(lfsr::stats_direction::scramble,
+            lfsr::stats_call::byte), 4000);
+    EXPECT_EQ(s.bytes(lfsr::stats_direction::scramble), 4000);
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <cerrno>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define LFSR_HAVE_UNISTD 1
+#endif
+
+namespace detail {
+
+
+enum class direction
+{
+    scramble,
+    descramble,
+};
+
+
+inline auto parse_direction(std::string_view name) -> direction
+{
+    if (name == "scramble") {
+        return direction::scramble;
+    }
+    if (name == "descramble") {
+        return direction::descramble;
+    }
+    throw std::invalid_argument(std::format("unknown direction '{}', expected "
+            "scramble or descramble", name));
+}
+
+
+/* Scrambles or descrambles [first, last) into d_first, which may be first */
+template <typename LFSR>
+auto transform(LFSR & lfsr,
+               direction dir,
+               std::uint8_t const * first,
+               std::uint8_t const * last,
+               std::uint8_t * d_first) -> void
+{
+    if (dir == direction::scramble) {
+        lfsr.scramble_range(first, last, d_first);
+    } else {
+        lfsr.descramble_range(first, last, d_first);
+    }
+}
+
+
+
+/* Very small command line parser: positional arguments, `--name value`
+   options, and `--name` flags, where the flags are named up front. */
+class arguments
+{
+public:
+    arguments(int argc, char const * const * argv,
+              std::vector<std::string_view> flags = {})
+    {
+        for (auto ii = 1; ii < argc; ++ii)
+        {
+            auto arg = std::string_view{argv[ii]};
+            if (!arg.starts_with("--")) {
+                m_positional.emplace_back(arg);
+                continue;
+            }
+
+            auto name = arg.substr(2);
+            if (std::find(flags.begin(), flags.end(), name) != flags.end()) {
+                m_options[std::string{name}] = "";
+                continue;
+            }
+            if (ii + 1 == argc) {
+                throw std::invalid_argument(std::format(
+                        "missing value for option '{}'", arg));
+            }
+            m_options[std::string{name}] = argv[++ii];
+        }
+    }
+
+    auto positional_count() const -> std::size_t
+    {
+        return m_positional.size();
+    }
+
+    auto positional(std::size_t index) const -> std::string const &
+    {
+        if (index >= m_positional.size()) {
+            throw std::invalid_argument("not enough arguments");
+        }
+        return m_positional[index];
+    }
+
+    auto flag(std::string const & name) const -> bool
+    {
+        return m_options.contains(name);
+    }
+
+    auto value(std::string const & name, std::string fallback) const
+        -> std::string
+    {
+        auto it = m_options.find(name);
+        return it == m_options.end() ? fallback : it->second;
+    }
+
+    /* A size in bytes, which may have a K, M or G (binary) suffix */
+    auto size(std::string const & name, std::size_t fallback) const
+        -> std::size_t
+    {
+        auto it = m_options.find(name);
+        return it == m_options.end() ? fallback : parse_size(it->second);
+    }
+
+    static auto parse_size(std::string_view text) -> std::size_t
+    {
+        auto const invalid = [&] {
+            return std::invalid_argument(std::format("invalid size '{}'", text));
+        };
+        auto const out_of_range = [&] {
+            return std::invalid_argument(std::format(
+                    "size '{}' is out of range", text));
+        };
+
+        auto result = std::size_t{};
+        auto const last = text.data() + text.size();
+        auto const [end, error] = std::from_chars(text.data(), last, result);
+        if (error == std::errc::result_out_of_range) {
+            throw out_of_range();
+        }
+        if (error != std::errc{}) {
+            throw invalid();
+        }
+
+        auto const suffix = std::string_view{end, last};
+        auto shift = 0;
+        if (suffix == "K" || suffix == "k") {
+            shift = 10;
+        } else if (suffix == "M" || suffix == "m") {
+            shift = 20;
+        } else if (suffix == "G" || suffix == "g") {
+            shift = 30;
+        } else if (!suffix.empty()) {
+            throw invalid();
+        }
+        if (result > (std::numeric_limits<std::size_t>::max() >> shift)) {
+            throw out_of_range();
+        }
+        return result << shift;
+    }
+
+private:
+    std::vector<std::string>           m_positional;
+    std::map<std::string, std::string> m_options;
+};
+
+
+
+#if defined(LFSR_HAVE_UNISTD)
+
+/* Owns a POSIX file descriptor */
+class file_descriptor
+{
+public:
+    explicit file_descriptor(int fd = -1) noexcept
+        : m_fd{fd}
+    {
+    }
+
+    file_descriptor(file_descriptor && other) noexcept
+        : m_fd{std::exchange(other.m_fd, -1)}
+    {
+    }
+
+    auto operator=(file_descriptor && other) noexcept -> file_descriptor &
+    {
+        std::swap(m_fd, other.m_fd);
+        return *this;
+    }
+
+    ~file_descriptor()
+    {
+        if (m_fd != -1) {
+            ::close(m_fd);
+        }
+    }
+
+    auto get() const noexcept -> int
+    {
+        return m_fd;
+    }
+
+private:
+    int m_fd;
+};
+
+#endif
+
+
+inline auto throw_system_error(std::string const & what) -> void
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+
+
+class stopwatch
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    stopwatch()
+        : m_start{clock::now()}
+    {
+    }
+
+    auto seconds() const -> double
+    {
+        return std::chrono::duration<double>(clock::now() - m_start).count();
+    }
+
+private:
+    clock::time_point m_start;
+};
+
+
+inline auto format_throughput(std::uint64_t bytes, double seconds)
+    -> std::string
+{
+    auto const mib = static_cast<double>(bytes) / (1024.0 * 1024.0);
+    return std::format("{:.1f} MiB in {:.3f} s ({:.1f} MiB/s)",
+            mib, seconds, seconds > 0 ? mib / seconds : 0.0);
+}
+
+
+}
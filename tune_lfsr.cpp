@@ -1,70 +1,273 @@
 #include <lfsr.hpp>
+#include <lfsr_dispatch.hpp>
 
-#include <test_detail.hpp>
+#include <bench_detail.hpp>
+#include <tool_detail.hpp>
 
-#include <filesystem>
+#include <cstring>
 #include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
 
+#if defined(LFSR_WITH_ITT)
+#include <ittnotify.h>
+#endif
 
-namespace fs = std::filesystem;
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
-using tap_list = lfsr::tap_list<0, 17, 20>;
 
+/* A driver for profiling a single engine with VTune, `perf` or callgrind, as
+   doing so on either the benchmarks or tests produces a lot of call stack
+   noise.
 
-auto run_galois(std::vector<std::uint8_t> const & to_scramble)
+   The buffers are allocated and filled before anything is measured, and the
+   scrambling itself is run `--repeat` times as its own phase, so that the
+   profile can be narrowed down to the kernel:
+
+   * With VTune, when built with ITT (see `LFSR_WITH_ITT` in CMakeLists.txt),
+     each phase is an ITT task, and collection is paused outside the kernel
+     phase; start the collection paused (`-start-paused`) to see only that.
+   * With `perf`, counting is enabled only for the kernel phase through perf's
+     control FIFOs:
+
+       mkfifo ctl ack
+       perf record -D -1 --control fifo:ctl,ack -- \
+           tune_lfsr --perf-ctl ctl --perf-ack ack ...
+*/
+
+namespace {
+
+constexpr auto usage =
+R"(usage: tune_lfsr [options]
+
+  --taps <taps>        Comma separated taps, or a polynomial name (default
+                       0,17,20)
+  --engine <name>      fibonacci, galois, fibonacci_bulk (default) or
+                       fibonacci_word
+  --direction <dir>    scramble (default) or descramble
+  --size <size>        Bytes per pass (default 100M)
+  --repeat <n>         Number of passes over the buffer (default 10)
+  --output <file>      Write the result of the last pass here, after the
+                       measured phases
+  --perf-ctl <fifo>    perf's control FIFO, to count only the kernel phase
+  --perf-ack <fifo>    perf's acknowledgement FIFO
+)";
+
+
+struct options
 {
-    using lfsr_type = detail::feedthrough_galois_from_list_t<tap_list>;
+    std::vector<std::size_t> taps;
+    lfsr::engine_kind        engine;
+    detail::direction        dir;
+    std::size_t              size;
+    std::size_t              repeat;
+    std::string              output;
+    std::string              perf_ctl;
+    std::string              perf_ack;
+};
 
-    auto lfsr = lfsr_type{};
-    auto scrambled = std::vector<std::uint8_t>{};
-    lfsr.scramble_range(std::begin(to_scramble), 
-            std::end(to_scramble), 
-            std::back_inserter(scrambled));
 
-    auto out = std::fstream{"scrambled.galois.bin", std::ios::out | std::ios::binary};
-    out.write(reinterpret_cast<char const *>(scrambled.data()), scrambled.size());
-}
+/* Tells `perf` to start and stop counting, if it's listening */
+class perf_control
+{
+public:
+    perf_control(std::string const & ctl, std::string const & ack)
+    {
+#if defined(__linux__)
+        if (ctl.empty()) {
+            return;
+        }
+        m_ctl = detail::file_descriptor{::open(ctl.c_str(), O_WRONLY)};
+        if (m_ctl.get() == -1) {
+            detail::throw_system_error(ctl);
+        }
+        if (!ack.empty()) {
+            m_ack = detail::file_descriptor{::open(ack.c_str(), O_RDONLY)};
+            if (m_ack.get() == -1) {
+                detail::throw_system_error(ack);
+            }
+        }
+#else
+        if (!ctl.empty() || !ack.empty()) {
+            throw std::invalid_argument("perf control is only available on "
+                    "Linux");
+        }
+#endif
+    }
+
+    auto enable() -> void
+    {
+        send("enable\n");
+    }
+
+    auto disable() -> void
+    {
+        send("disable\n");
+    }
+
+private:
+    auto send(char const * command) -> void
+    {
+#if defined(__linux__)
+        if (m_ctl.get() == -1) {
+            return;
+        }
+        if (::write(m_ctl.get(), command, std::strlen(command)) == -1) {
+            detail::throw_system_error("perf control");
+        }
+
+        /* Wait for perf to act on it, otherwise the first few microseconds
+           of the phase would be missed or the next phase counted */
+        if (m_ack.get() != -1) {
+            char reply[8] = {};
+            if (::read(m_ack.get(), reply, sizeof(reply)) == -1) {
+                detail::throw_system_error("perf acknowledgement");
+            }
+        }
+#else
+        (void)command;
+#endif
+    }
+
+#if defined(__linux__)
+    detail::file_descriptor m_ctl;
+    detail::file_descriptor m_ack;
+#endif
+};
 
 
-auto run_fibonacci(std::vector<std::uint8_t> const & to_scramble)
+/* Brackets each phase for whichever profiler is attached, and times it */
+class phases
 {
-    using lfsr_type = detail::feedthrough_fibonacci_from_list_t<tap_list>;
+public:
+    explicit phases(options const & opts)
+        : m_perf{opts.perf_ctl, opts.perf_ack}
+    {
+#if defined(LFSR_WITH_ITT)
+        m_domain = __itt_domain_create("tune_lfsr");
+        __itt_pause();
+#endif
+    }
+
+    /* Runs `func` as the phase `name`, which processes `bytes`. Only phases
+       that are `profiled` are counted by perf and collected by VTune. */
+    template <typename Func>
+    auto run(char const * name, std::uint64_t bytes, bool profiled,
+             Func && func) -> void
+    {
+#if defined(LFSR_WITH_ITT)
+        __itt_task_begin(m_domain, __itt_null, __itt_null,
+                __itt_string_handle_create(name));
+        if (profiled) {
+            __itt_resume();
+        }
+#endif
+        if (profiled) {
+            m_perf.enable();
+        }
+
+        auto timer = detail::stopwatch{};
+        func();
+        auto const seconds = timer.seconds();
 
-    auto lfsr = lfsr_type{};
-    auto scrambled = std::vector<std::uint8_t>{};
-    lfsr.scramble_range(std::begin(to_scramble), 
-            std::end(to_scramble), 
-            std::back_inserter(scrambled));
+        if (profiled) {
+            m_perf.disable();
+        }
+#if defined(LFSR_WITH_ITT)
+        if (profiled) {
+            __itt_pause();
+        }
+        __itt_task_end(m_domain);
+#endif
+
+        std::cout << std::format("{:<10} {}\n", name,
+                detail::format_throughput(bytes, seconds));
+    }
+
+private:
+    perf_control m_perf;
+#if defined(LFSR_WITH_ITT)
+    __itt_domain * m_domain;
+#endif
+};
+
+
+template <typename LFSR>
+auto run(options const & opts, LFSR & lfsr) -> void
+{
+    auto markers = phases{opts};
 
-    auto out = std::fstream{"scrambled.fibonacci.bin", std::ios::out | std::ios::binary};
-    out.write(reinterpret_cast<char const *>(scrambled.data()), scrambled.size());
+    /* Everything is allocated up front, and the output touched so that page
+       faults don't land in the kernel phase either */
+    auto input  = std::vector<std::uint8_t>{};
+    auto output = std::vector<std::uint8_t>{};
+    markers.run("generate", opts.size, false, [&] {
+        input = random_payload(opts.size);
+        output.assign(opts.size, 0);
+    });
+
+    markers.run("kernel", opts.size * opts.repeat, true, [&] {
+        for (auto ii = std::size_t{}; ii != opts.repeat; ++ii) {
+            detail::transform(lfsr, opts.dir,
+                    input.data(), input.data() + input.size(), output.data());
+        }
+    });
+
+    if (!opts.output.empty()) {
+        markers.run("write", opts.size, false, [&] {
+            auto out = std::ofstream{opts.output, std::ios::binary};
+            out.write(reinterpret_cast<char const *>(output.data()),
+                    static_cast<std::streamsize>(output.size()));
+            if (!out) {
+                throw std::runtime_error(std::format(
+                        "failed to write '{}'", opts.output));
+            }
+        });
+    }
 }
 
 
-auto run_fibonacci_bulk(std::vector<std::uint8_t> const & to_scramble)
+auto parse_options(int argc, char const * const * argv) -> options
 {
-    using lfsr_type = detail::feedthrough_fibonacci_bulk_from_list_t<tap_list>;
+    auto args = detail::arguments{argc, argv, {"help"}};
+    if (args.flag("help") || args.positional_count() != 0) {
+        throw std::invalid_argument(usage);
+    }
 
-    auto lfsr = lfsr_type{};
-    auto scrambled = std::vector<std::uint8_t>{};
-    lfsr.scramble_range(std::begin(to_scramble), 
-            std::end(to_scramble), 
-            std::back_inserter(scrambled));
+    return options{
+        .taps      = lfsr::parse_taps(args.value("taps", "0,17,20")),
+        .engine    = lfsr::parse_engine_kind(
+                args.value("engine", "fibonacci_bulk")),
+        .dir       = detail::parse_direction(
+                args.value("direction", "scramble")),
+        .size      = args.size("size", std::size_t{100} << 20),
+        .repeat    = args.size("repeat", 10),
+        .output    = args.value("output", ""),
+        .perf_ctl  = args.value("perf-ctl", ""),
+        .perf_ack  = args.value("perf-ack", ""),
+    };
+}
 
-    auto out = std::fstream{"scrambled.fibonaccibulk.bin", std::ios::out | std::ios::binary};
-    out.write(reinterpret_cast<char const *>(scrambled.data()), scrambled.size());
 }
 
 
 
-auto main() -> int
+auto main(int argc, char ** argv) -> int
 {
-    auto to_scramble = std::vector<std::uint8_t>{};
-    for (auto ii = 0; ii != 1024 * 1024 * 100; ++ii) {
-        to_scramble.push_back(ii);
+    try
+    {
+        auto const opts = parse_options(argc, argv);
+        lfsr::visit_engine(opts.taps, opts.engine, [&](auto & lfsr) {
+            run(opts, lfsr);
+        });
     }
-
-    run_fibonacci(to_scramble);
-    run_galois(to_scramble);
-    run_fibonacci_bulk(to_scramble);
-}
\ No newline at end of file
+    catch (std::exception const & e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
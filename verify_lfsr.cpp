@@ -0,0 +1,675 @@
+#include <lfsr.hpp>
+#include <lfsr_dispatch.hpp>
+
+#include <tool_detail.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+
+/* Differential verification of the engines against the simplest one: the
+   Fibonacci LFSR driven a bit at a time through `scramble_bit` and
+   `descramble_bit`.
+
+   The data is split into segments, each an independent stream of random
+   bytes starting from a random history (the last `degree` scrambled bits, to
+   which every engine is synchronised by descrambling them), so that they can
+   be shared out between threads. Each segment is run through the reference
+   once, then through every engine a block at a time with `scramble_range` or
+   `descramble_range`, comparing the output and the state after each block.
+   The Galois state isn't the history, so it is compared against another
+   Galois engine driven a bit at a time.
+
+   On a mismatch the failing window is shrunk, first from the end and then
+   from the start, to the shortest that still fails when replayed on a fresh
+   engine, and printed along with the history it starts from. */
+
+namespace {
+
+constexpr auto usage =
+R"(usage: verify_lfsr [options]
+
+  --taps <taps>        Comma separated taps, or a polynomial name (default:
+                       every prebuilt tap list)
+  --engine <name>      fibonacci, galois, fibonacci_bulk or fibonacci_word
+                       (default: all, each for the tap lists it supports)
+  --direction <dir>    scramble or descramble (default: both)
+  --size <size>        Bytes per tap list and direction (default 256M)
+  --segment <size>     Bytes per independent stream (default 16M)
+  --block <size>       Bytes per call, after which the state is compared
+                       (default 64K)
+  --threads <n>        Threads to verify with (default: one per core)
+  --seed <n>           Seed for the data and histories (default 1)
+)";
+
+
+struct options
+{
+    std::vector<std::vector<std::size_t>> taps;
+    std::vector<lfsr::engine_kind>        engines;
+    std::vector<detail::direction>        directions;
+    std::size_t                           size;
+    std::size_t                           segment;
+    std::size_t                           block;
+    std::size_t                           threads;
+    std::uint64_t                         seed;
+};
+
+
+auto splitmix64(std::uint64_t & x) -> std::uint64_t
+{
+    auto z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+
+auto fill_random(std::span<std::uint8_t> bytes, std::uint64_t & rng) -> void
+{
+    auto ii = std::size_t{};
+    for (; ii + 8 <= bytes.size(); ii += 8) {
+        auto const value = splitmix64(rng);
+        std::memcpy(bytes.data() + ii, &value, 8);
+    }
+    for (auto value = splitmix64(rng); ii != bytes.size(); ++ii, value >>= 8) {
+        bytes[ii] = static_cast<std::uint8_t>(value);
+    }
+}
+
+
+auto join_taps(std::span<std::size_t const> taps) -> std::string
+{
+    auto result = std::string{};
+    for (auto tap : taps) {
+        result += std::format("{}{}", result.empty() ? "" : ",", tap);
+    }
+    return result;
+}
+
+
+auto to_string(detail::direction dir) -> std::string_view
+{
+    return dir == detail::direction::scramble ? "scramble" : "descramble";
+}
+
+
+auto to_hex(std::span<std::uint8_t const> bytes) -> std::string
+{
+    auto result = std::string{};
+    for (auto ii = std::size_t{}; ii != bytes.size(); ++ii) {
+        if (ii != 0) {
+            /* Lined up under the first, after "    expected " */
+            result += ii % 32 == 0 ? "\n             " : " ";
+        }
+        result += std::format("{:02x}", bytes[ii]);
+    }
+    return result;
+}
+
+
+/* A state, or a history, as words with bit 0 of the first being bit 0 of the
+   state, so that states of any degree can be kept outside of the engines */
+using state_words = std::vector<std::uint64_t>;
+
+template <std::size_t Degree>
+auto to_words(std::bitset<Degree> const & state) -> state_words
+{
+    auto result = state_words((Degree + 63) / 64);
+    for (auto ii = std::size_t{}; ii != Degree; ++ii) {
+        result[ii / 64] |= std::uint64_t{state.test(ii)} << (ii % 64);
+    }
+    return result;
+}
+
+auto to_hex(state_words const & words, std::size_t degree) -> std::string
+{
+    auto result = std::format("{:x}", words.back()
+            & (~std::uint64_t{} >> ((64 - degree % 64) % 64)));
+    for (auto ii = words.size() - 1; ii-- != 0;) {
+        result += std::format("'{:016x}", words[ii]);
+    }
+    return "0x" + result;
+}
+
+
+template <typename TapList>
+struct reference_for;
+
+template <std::size_t ... Taps>
+struct reference_for<lfsr::tap_list<Taps...>>
+{
+    using type = lfsr::feedthrough_fibonacci<Taps...>;
+};
+
+template <typename LFSR>
+using reference_for_t =
+        typename reference_for<typename LFSR::traits::tap_list>::type;
+
+
+/* Whether `state()` is the history, as it is for the Fibonacci engines */
+template <typename LFSR>
+constexpr auto keeps_history = true;
+
+template <typename Stats, std::size_t ... Taps>
+constexpr auto keeps_history<lfsr::basic_feedthrough_galois<Stats, Taps...>>
+        = false;
+
+
+/* Puts any engine into the state it would be in after scrambling `history` */
+template <typename LFSR>
+auto synchronise(LFSR & lfsr, state_words const & history) -> void
+{
+    for (auto ii = LFSR::degree; ii-- != 0;) {
+        lfsr.descramble_bit((history[ii / 64] >> (ii % 64)) & 1);
+    }
+}
+
+
+/* The reference: a byte at a time through the bit interface */
+template <typename LFSR>
+auto transform_bits(LFSR & lfsr, detail::direction dir,
+                    std::uint8_t const * first, std::uint8_t const * last,
+                    std::uint8_t * d_first) -> void
+{
+    for (; first != last; ++first, ++d_first)
+    {
+        auto result = std::uint8_t{};
+        for (auto ii = 0u; ii != 8; ++ii) {
+            auto const bit = ((*first >> ii) & 1) != 0;
+            auto const out = dir == detail::direction::scramble
+                    ? lfsr.scramble_bit(bit)
+                    : lfsr.descramble_bit(bit);
+            result |= static_cast<std::uint8_t>(out << ii);
+        }
+        *d_first = result;
+    }
+}
+
+
+/* One independent stream, for one tap list and direction */
+struct job
+{
+    std::size_t       taps_index;
+    detail::direction dir;
+    std::size_t       segment;
+    std::uint64_t     seed;
+    std::size_t       size;
+};
+
+
+/* The reference's output for a job, and its state at every block boundary */
+struct expected
+{
+    std::vector<std::uint8_t> input;
+    std::vector<std::uint8_t> output;
+    std::vector<state_words>  states;
+};
+
+
+struct outcome
+{
+    std::uint64_t bytes  = 0;
+    std::string   report = {};
+};
+
+
+class verifier
+{
+public:
+    explicit verifier(options const & opts)
+        : m_opts{opts}
+    {
+        for (auto tt = std::size_t{}; tt != opts.taps.size(); ++tt) {
+            for (auto dir : opts.directions)
+            {
+                /* Seeded from the taps rather than their position, so that a
+                   failure can be rerun with just its taps */
+                auto rng = opts.seed;
+                for (auto tap : lfsr::detail::normalise_taps(opts.taps[tt])) {
+                    rng ^= splitmix64(rng) + tap;
+                }
+                rng ^= dir == detail::direction::scramble ? 0 : 0x5c5c5c5cull;
+
+                for (auto offset = std::size_t{}; offset < opts.size;
+                        offset += opts.segment) {
+                    m_jobs.push_back(job{
+                        .taps_index = tt,
+                        .dir        = dir,
+                        .segment    = offset / opts.segment,
+                        .seed       = splitmix64(rng),
+                        .size       = std::min(opts.segment,
+                                opts.size - offset),
+                    });
+                }
+            }
+        }
+        m_bytes.assign(opts.taps.size(), 0);
+    }
+
+    /* Returns whether every engine matched */
+    auto run() -> bool
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto t = std::size_t{}; t != m_opts.threads; ++t) {
+            threads.emplace_back([this] { work(); });
+        }
+        threads.clear();
+
+        for (auto const & report : m_reports) {
+            std::cout << report << "\n";
+        }
+        return m_reports.empty();
+    }
+
+    auto bytes(std::size_t taps_index) const -> std::uint64_t
+    {
+        return m_bytes[taps_index];
+    }
+
+private:
+    auto work() -> void
+    {
+        /* Once something has failed the rest are abandoned, as one mismatch
+           is usually a lot of them */
+        while (!m_failed.load(std::memory_order_relaxed))
+        {
+            auto const index = m_next.fetch_add(1);
+            if (index >= m_jobs.size()) {
+                break;
+            }
+            auto const result = verify(m_jobs[index]);
+
+            auto lock = std::lock_guard{m_mutex};
+            m_bytes[m_jobs[index].taps_index] += result.bytes;
+            if (!result.report.empty()) {
+                m_reports.push_back(result.report);
+                m_failed = true;
+            }
+        }
+    }
+
+    auto verify(job const & j) const -> outcome
+    {
+        auto const & taps = m_opts.taps[j.taps_index];
+        auto ref = expected{};
+        lfsr::visit_engine(taps, lfsr::engine_kind::fibonacci,
+                [&](auto & reference) {
+            ref = run_reference(j, reference);
+        });
+
+        auto result = outcome{};
+        for (auto kind : m_opts.engines)
+        {
+            if (*std::max_element(taps.begin(), taps.end())
+                    > lfsr::max_degree(kind)) {
+                continue;
+            }
+            lfsr::visit_engine(taps, kind, [&](auto & engine) {
+                result.report = check(j, kind, engine, ref);
+            });
+            if (!result.report.empty()) {
+                break;
+            }
+            result.bytes += j.size;
+        }
+        return result;
+    }
+
+    template <typename Reference>
+    auto run_reference(job const & j, Reference & reference) const -> expected
+    {
+        auto rng = j.seed;
+        auto history = state_words((Reference::degree + 63) / 64);
+        for (auto & word : history) {
+            word = splitmix64(rng);
+        }
+        /* Bits above the degree are never read */
+        auto result = expected{};
+        result.input.resize(j.size);
+        result.output.resize(j.size);
+        fill_random(result.input, rng);
+
+        synchronise(reference, history);
+        result.states.push_back(to_words(reference.state()));
+        for (auto offset = std::size_t{}; offset < j.size;
+                offset += m_opts.block)
+        {
+            auto const length = std::min(m_opts.block, j.size - offset);
+            transform_bits(reference, j.dir, result.input.data() + offset,
+                    result.input.data() + offset + length,
+                    result.output.data() + offset);
+            result.states.push_back(to_words(reference.state()));
+        }
+        return result;
+    }
+
+    /* Runs the job through `engine`, returning a report of the first
+       mismatch, or nothing */
+    template <typename LFSR>
+    auto check(job const & j, lfsr::engine_kind kind, LFSR & engine,
+               expected const & ref) const -> std::string
+    {
+        auto actual = std::vector<std::uint8_t>(m_opts.block);
+        auto shadow = LFSR{};
+        auto scratch = std::vector<std::uint8_t>(m_opts.block);
+
+        synchronise(engine, ref.states.front());
+        if constexpr (!keeps_history<LFSR>) {
+            synchronise(shadow, ref.states.front());
+        }
+
+        for (auto offset = std::size_t{}, block = std::size_t{};
+                offset < j.size; offset += m_opts.block, ++block)
+        {
+            auto const length = std::min(m_opts.block, j.size - offset);
+            auto const input = ref.input.data() + offset;
+            detail::transform(engine, j.dir, input, input + length,
+                    actual.data());
+
+            auto matches = std::equal(actual.begin(), actual.begin()
+                    + static_cast<std::ptrdiff_t>(length),
+                    ref.output.begin() + static_cast<std::ptrdiff_t>(offset));
+            if constexpr (keeps_history<LFSR>) {
+                matches = matches
+                        && to_words(engine.state()) == ref.states[block + 1];
+            } else {
+                transform_bits(shadow, j.dir, input, input + length,
+                        scratch.data());
+                matches = matches && engine.state() == shadow.state();
+            }
+
+            if (!matches) {
+                return describe<LFSR>(j, kind, ref, block, offset, length,
+                        actual);
+            }
+        }
+        return {};
+    }
+
+    /* Fresh engines from `history`, over `input`: the output and state of
+       the engine under test and of the reference */
+    template <typename LFSR>
+    struct replay
+    {
+        std::vector<std::uint8_t> actual;
+        std::vector<std::uint8_t> expected;
+        state_words               actual_state;
+        state_words               expected_state;
+
+        replay(detail::direction dir, state_words const & history,
+               std::span<std::uint8_t const> input)
+            : actual(input.size())
+            , expected(input.size())
+        {
+            auto engine = LFSR{};
+            synchronise(engine, history);
+            detail::transform(engine, dir, input.data(),
+                    input.data() + input.size(), actual.data());
+            actual_state = to_words(engine.state());
+
+            using oracle_type = std::conditional_t<keeps_history<LFSR>,
+                    reference_for_t<LFSR>, LFSR>;
+            auto oracle = oracle_type{};
+            synchronise(oracle, history);
+            transform_bits(oracle, dir, input.data(),
+                    input.data() + input.size(), expected.data());
+            expected_state = to_words(oracle.state());
+        }
+
+        auto fails() const -> bool
+        {
+            return actual != expected || actual_state != expected_state;
+        }
+    };
+
+    /* Shrinks the failing block to the shortest window that fails on its own
+       and reports it */
+    template <typename LFSR>
+    auto describe(job const & j, lfsr::engine_kind kind, expected const & ref,
+                  std::size_t block, std::size_t offset, std::size_t length,
+                  std::vector<std::uint8_t> const & actual) const
+        -> std::string
+    {
+        auto const input = std::span{ref.input}.subspan(offset, length);
+        auto const degree = LFSR::degree;
+
+        /* The history before byte `start` of the block */
+        auto const history_at = [&](std::size_t start) {
+            auto reference = reference_for_t<LFSR>{};
+            synchronise(reference, ref.states[block]);
+            auto scratch = std::vector<std::uint8_t>(start);
+            transform_bits(reference, j.dir, input.data(),
+                    input.data() + start, scratch.data());
+            return to_words(reference.state());
+        };
+        auto const fails = [&](std::size_t start, std::size_t end) {
+            return replay<LFSR>{j.dir, history_at(start),
+                    input.subspan(start, end - start)}.fails();
+        };
+
+        auto const mismatch = std::mismatch(actual.begin(), actual.begin()
+                + static_cast<std::ptrdiff_t>(length),
+                ref.output.begin() + static_cast<std::ptrdiff_t>(offset));
+        auto const first_byte = static_cast<std::size_t>(
+                mismatch.first - actual.begin());
+
+        auto result = std::format("MISMATCH taps {} engine {} {} (--seed {}, "
+                "segment {})\n", join_taps(m_opts.taps[j.taps_index]),
+                lfsr::to_string(kind), to_string(j.dir), m_opts.seed,
+                j.segment);
+        if (first_byte != length)
+        {
+            auto const diff = static_cast<std::uint8_t>(
+                    *mismatch.first ^ *mismatch.second);
+            auto const bit = static_cast<std::size_t>(std::countr_zero(diff));
+            auto const stream_byte = j.segment * m_opts.segment + offset
+                    + first_byte;
+            result += std::format("  first divergent bit: {} of the stream "
+                    "(byte {}, bit {}; block {}, byte {}), expected 0x{:02x}, "
+                    "got 0x{:02x}\n", stream_byte * 8 + bit, stream_byte, bit,
+                    block, first_byte, *mismatch.second, *mismatch.first);
+        }
+        else
+        {
+            result += std::format("  output matches, but the state after "
+                    "block {} (bytes {} to {}) differs\n", block, offset,
+                    offset + length);
+        }
+
+        /* Shortest end, then latest start, by doubling and then bisecting.
+           This assumes that a failing window stays failing as it grows,
+           which is usual, but whatever is found is checked. */
+        auto const shortest = [&](std::size_t limit, auto && fails_with) {
+            auto good = std::size_t{};
+            auto bad = std::size_t{1};
+            while (bad < limit && !fails_with(bad)) {
+                good = bad;
+                bad = std::min(bad * 2, limit);
+            }
+            while (bad - good > 1) {
+                auto const mid = good + (bad - good) / 2;
+                (fails_with(mid) ? bad : good) = mid;
+            }
+            return bad;
+        };
+
+        auto const end = first_byte != length ? first_byte + 1 : length;
+        if (!fails(0, end)) {
+            result += "  the block doesn't fail when replayed on its own, so "
+                    "it depends on earlier calls; rerun the segment with\n";
+            return result + std::format("  verify_lfsr --taps {} --engine {} "
+                    "--direction {} --seed {} --segment {} --block {}\n",
+                    join_taps(m_opts.taps[j.taps_index]),
+                    lfsr::to_string(kind), to_string(j.dir), m_opts.seed,
+                    m_opts.segment, m_opts.block);
+        }
+        auto const shrunk_end = shortest(end, [&](std::size_t e) {
+            return fails(0, e);
+        });
+        auto const shrunk_length = shortest(shrunk_end, [&](std::size_t n) {
+            return fails(shrunk_end - n, shrunk_end);
+        });
+        auto const start = shrunk_end - shrunk_length;
+
+        auto const history = history_at(start);
+        auto const repro = replay<LFSR>{j.dir, history,
+                input.subspan(start, shrunk_length)};
+
+        result += std::format("  reproducer ({} byte{}): a new {} engine, "
+                "synchronised by descrambling the history bits from bit {} "
+                "down to bit 0, then {}_range over the input\n",
+                shrunk_length, shrunk_length == 1 ? "" : "s",
+                lfsr::to_string(kind), degree - 1, to_string(j.dir));
+        result += std::format("    history  {}\n", to_hex(history, degree));
+        result += std::format("    input    {}\n", to_hex(input.subspan(
+                start, shrunk_length)));
+        result += std::format("    expected {}\n", to_hex(repro.expected));
+        result += std::format("    actual   {}\n", to_hex(repro.actual));
+        if (repro.actual_state != repro.expected_state) {
+            result += std::format("    state expected {}\n"
+                    "    state actual   {}\n",
+                    to_hex(repro.expected_state, degree),
+                    to_hex(repro.actual_state, degree));
+        }
+        return result;
+    }
+
+    options const &            m_opts;
+    std::vector<job>           m_jobs;
+    std::atomic<std::size_t>   m_next = 0;
+    std::atomic<bool>          m_failed = false;
+    std::mutex                 m_mutex;
+    std::vector<std::string>   m_reports;
+    std::vector<std::uint64_t> m_bytes;
+};
+
+
+auto all_prebuilt_taps() -> std::vector<std::vector<std::size_t>>
+{
+    return []<typename ... Lists>(std::tuple<Lists...> const *) {
+        return std::vector<std::vector<std::size_t>>{
+            std::vector<std::size_t>(Lists::values.begin(),
+                    Lists::values.end())...
+        };
+    }(static_cast<lfsr::prebuilt_tap_lists const *>(nullptr));
+}
+
+
+auto parse_options(int argc, char const * const * argv) -> options
+{
+    auto args = detail::arguments{argc, argv, {"help"}};
+    if (args.flag("help") || args.positional_count() != 0) {
+        throw std::invalid_argument(usage);
+    }
+
+    auto result = options{
+        .taps       = {},
+        .engines    = {lfsr::engine_kind::fibonacci, lfsr::engine_kind::galois,
+                lfsr::engine_kind::fibonacci_bulk,
+                lfsr::engine_kind::fibonacci_word},
+        .directions = {detail::direction::scramble,
+                detail::direction::descramble},
+        .size       = args.size("size", std::size_t{256} << 20),
+        .segment    = args.size("segment", std::size_t{16} << 20),
+        .block      = args.size("block", std::size_t{64} << 10),
+        .threads    = args.size("threads",
+                std::max(1u, std::thread::hardware_concurrency())),
+        .seed       = args.size("seed", 1),
+    };
+
+    if (args.flag("engine")) {
+        result.engines = {lfsr::parse_engine_kind(args.value("engine", ""))};
+    }
+    if (args.flag("taps"))
+    {
+        /* Checked here, as the workers can't throw, for the reference and
+           for an engine asked for by name, which has to be able to take
+           them rather than be passed over */
+        auto taps = lfsr::parse_taps(args.value("taps", ""));
+        lfsr::visit_engine(taps, lfsr::engine_kind::fibonacci, [](auto &) {});
+        if (args.flag("engine")) {
+            lfsr::visit_engine(taps, result.engines.front(), [](auto &) {});
+        }
+        result.taps.push_back(std::move(taps));
+    }
+    else
+    {
+        /* Just those that one of the engines can take */
+        for (auto & taps : all_prebuilt_taps())
+        {
+            auto const highest = *std::max_element(taps.begin(), taps.end());
+            if (std::ranges::any_of(result.engines, [&](auto kind) {
+                    return highest <= lfsr::max_degree(kind); })) {
+                result.taps.push_back(std::move(taps));
+            }
+        }
+    }
+    if (args.flag("direction")) {
+        result.directions = {detail::parse_direction(
+                args.value("direction", ""))};
+    }
+
+    if (result.segment == 0 || result.block == 0) {
+        throw std::invalid_argument("segment and block must be at least 1");
+    }
+    if (result.threads == 0) {
+        throw std::invalid_argument("threads must be at least 1");
+    }
+    return result;
+}
+
+}
+
+
+
+auto main(int argc, char ** argv) -> int
+{
+    try
+    {
+        auto const opts = parse_options(argc, argv);
+
+        auto timer = detail::stopwatch{};
+        auto v = verifier{opts};
+        auto const passed = v.run();
+        auto const seconds = timer.seconds();
+
+        /* A tap list that nothing was verified for fails the run, rather
+           than passing without having been looked at */
+        auto total = std::uint64_t{};
+        auto verified = true;
+        for (auto tt = std::size_t{}; tt != opts.taps.size(); ++tt) {
+            total += v.bytes(tt);
+            verified = verified && v.bytes(tt) != 0;
+            std::cout << std::format("{:<24} {} MiB{}\n",
+                    join_taps(opts.taps[tt]), v.bytes(tt) >> 20,
+                    v.bytes(tt) == 0 ? " (nothing verified)" : "");
+        }
+        auto const ok = passed && verified && !opts.taps.empty();
+        std::cout << std::format("{}: {} across {} engine{} and {} "
+                "thread{}\n", ok ? "ok" : "FAILED",
+                detail::format_throughput(total, seconds),
+                opts.engines.size(), opts.engines.size() == 1 ? "" : "s",
+                opts.threads, opts.threads == 1 ? "" : "s");
+        return ok ? 0 : 2;
+    }
+    catch (std::exception const & e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}